@@ -25,7 +25,7 @@ INCLUDEPATH += $$PWD
 
 SOURCES += \
     ActiveSettings.cpp \
-    Cell.cpp \
+    PresentationSpace.cpp \
     CertificateDetails.cpp \
     CodePage.cpp \
     ColourTheme.cpp \
@@ -49,6 +49,7 @@ SOURCES += \
     MainWindow.cpp \
     Preferences/PreferencesDialog.cpp \
     ProcessDataStream.cpp \
+    QueryReply.cpp \
     Sessions/SaveSessionDialog.cpp \
     Models/Session.cpp \
     Sessions/SessionDialogBase.cpp \
@@ -62,7 +63,7 @@ SOURCES += \
 
 HEADERS += \
     ActiveSettings.h \
-    Cell.h \
+    PresentationSpace.h \
     CertificateDetails.h \
     CodePage.h \
     ColourTheme.h \
@@ -81,6 +82,7 @@ HEADERS += \
     MainWindow.h \
     Preferences/PreferencesDialog.h \
     ProcessDataStream.h \
+    QueryReply.h \
     Q3270.h \
     Sessions/SaveSessionDialog.h \
     Models/Session.h \
@@ -0,0 +1,71 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef BENCHSESSION_H
+#define BENCHSESSION_H
+
+#include <QByteArray>
+#include <QSize>
+
+#include "BufferAddress.h"
+#include "CodePage.h"
+#include "DisplayScreen.h"
+#include "ProcessDataStream.h"
+#include "Models/Colours.h"
+
+/**
+ * @brief   The Session class
+ *
+ * @details A ProcessDataStream and DisplayScreen with no Terminal, socket or scene, so that only the data
+ *          stream parser and the screen model are involved. The primary screen is 24x80, and the alternate
+ *          screen is the size given.
+ */
+class Session
+{
+    public:
+
+        Session(int width, int height)
+            : palette(Colours::getFactoryTheme())
+            , screen(80, 24, cp, &palette)
+            , datastream(&screen, QSize(80, 24), QSize(width, height))
+        {
+        }
+
+        void process(const QByteArray &record)
+        {
+            datastream.processStream(QByteArrayView(record), false);
+        }
+
+        ProcessDataStream &dataStream()
+        {
+            return datastream;
+        }
+
+        DisplayScreen &displayScreen()
+        {
+            return screen;
+        }
+
+    private:
+
+        CodePage cp;
+        Colours palette;
+        DisplayScreen screen;
+        ProcessDataStream datastream;
+};
+
+/**
+ * @brief   discardMessages - message handler that throws trace and warning output away
+ */
+inline void discardMessages(QtMsgType, const QMessageLogContext &, const QString &)
+{
+}
+
+#endif // BENCHSESSION_H
@@ -0,0 +1,51 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef BUFFERADDRESS_H
+#define BUFFERADDRESS_H
+
+#include <QByteArray>
+
+// 12 bit buffer address encoding, as used by DisplayScreen
+inline constexpr uchar twelveBitBufferAddress[64] = {
+    0x40, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+    0x50, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,
+    0xD8, 0xD9, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+    0x60, 0x61, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7,
+    0xE8, 0xE9, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+    0xF8, 0xF9, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F
+};
+
+/**
+ * @brief   appendAddress - append a buffer address in the form the host would use for the screen size
+ * @param   record - the record
+ * @param   pos    - the buffer address
+ * @param   size   - the number of cells on the screen
+ *
+ * @details As DisplayScreen::addPosToBuffer(), screens of up to 4096 cells use 12 bit addresses and larger
+ *          ones 14 bit.
+ */
+inline void appendAddress(QByteArray &record, int pos, int size)
+{
+    if (size <= 4096)
+    {
+        record.append((char) twelveBitBufferAddress[(pos >> 6) & 0x3F]);
+        record.append((char) twelveBitBufferAddress[pos & 0x3F]);
+    }
+    else
+    {
+        record.append((char) ((pos >> 8) & 0x3F));
+        record.append((char) (pos & 0xFF));
+    }
+}
+
+#endif // BUFFERADDRESS_H
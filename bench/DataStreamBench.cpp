@@ -0,0 +1,854 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include <sys/resource.h>
+
+#include "Q3270.h"
+#include "BenchSession.h"
+#include "WireTraceReplay.h"
+
+/**
+ * @brief   The ScreenModel struct
+ *
+ * @details A screen size to measure. The data stream is written to the alternate screen with Erase/Write
+ *          Alternate, so the alternate size is the one under test.
+ */
+struct ScreenModel
+{
+    const char *name;
+    int width;
+    int height;
+};
+
+static const ScreenModel models[] = {
+    { "model2",   80, 24 },
+    { "model3",   80, 32 },
+    { "model4",   80, 43 },
+    { "model5",  132, 27 },
+    { "dynamic", 160, 62 },
+    { "dynamic", 200, 80 }
+};
+
+/**
+ * @brief   startRecord - start an Erase/Write Alternate record
+ * @return  the record, with the command and WCC
+ */
+static QByteArray startRecord()
+{
+    QByteArray record;
+
+    record.append((char) IBM3270_EWA);
+    record.append((char) 0xC3);
+
+    return record;
+}
+
+/**
+ * @brief   fullScreen - a typical formatted screen
+ * @param   m - the screen size
+ * @return  the record
+ *
+ * @details Each row has a protected label field and an unprotected input field, positioned with SBA and
+ *          filled with text.
+ */
+static QByteArray fullScreen(const ScreenModel &m)
+{
+    QByteArray record = startRecord();
+
+    int size = m.width * m.height;
+
+    for (int row = 0; row < m.height; row++)
+    {
+        record.append((char) IBM3270_SBA);
+        appendAddress(record, row * m.width, size);
+
+        record.append((char) IBM3270_SF);
+        record.append((char) 0x60);
+
+        int label = m.width / 4;
+
+        for (int col = 1; col < label; col++)
+        {
+            record.append((char) (0xC1 + (col + row) % 9));
+        }
+
+        record.append((char) IBM3270_SF);
+        record.append((char) 0x40);
+
+        for (int col = label + 1; col < m.width; col++)
+        {
+            record.append((char) (0x81 + col % 9));
+        }
+    }
+
+    record.append((char) IBM3270_IC);
+
+    return record;
+}
+
+/**
+ * @brief   characters - a record that places a character in every cell
+ * @param   m - the screen size
+ * @return  the record
+ */
+static QByteArray characters(const ScreenModel &m)
+{
+    QByteArray record = startRecord();
+
+    int size = m.width * m.height;
+
+    for (int i = 0; i < size; i++)
+    {
+        record.append((char) (0xC1 + i % 9));
+    }
+
+    return record;
+}
+
+/**
+ * @brief   orders - a record made of one order, repeated
+ * @param   m     - the screen size
+ * @param   order - the order
+ * @param   count - set to the number of orders in the record
+ * @return  the record
+ *
+ * @details Repeat to Address and Erase Unprotected to Address each cover one row. The EUA record is
+ *          formatted with a field every 40 cells first; the same formatting is in its baseline, so that only
+ *          the EUA orders are counted.
+ */
+static QByteArray orders(const ScreenModel &m, uchar order, int &count)
+{
+    QByteArray record = startRecord();
+
+    int size = m.width * m.height;
+
+    if (order == IBM3270_EUA)
+    {
+        for (int pos = 0; pos < size; pos += 40)
+        {
+            record.append((char) IBM3270_SBA);
+            appendAddress(record, pos, size);
+            record.append((char) IBM3270_SF);
+            record.append((char) 0x40);
+        }
+
+        record.append((char) IBM3270_SBA);
+        appendAddress(record, 0, size);
+    }
+
+    count = order == IBM3270_RA || order == IBM3270_EUA ? m.height : qMin(size, 2000);
+
+    for (int i = 0; i < count; i++)
+    {
+        switch (order)
+        {
+            case IBM3270_SBA:
+                record.append((char) IBM3270_SBA);
+                appendAddress(record, (i * 37) % size, size);
+                break;
+            case IBM3270_SF:
+                record.append((char) IBM3270_SF);
+                record.append((char) (i & 1 ? 0x60 : 0x40));
+                break;
+            case IBM3270_SFE:
+                record.append((char) IBM3270_SFE);
+                record.append((char) 2);
+                record.append((char) 0xC0);
+                record.append((char) (i & 1 ? 0x60 : 0x40));
+                record.append((char) 0x42);
+                record.append((char) (0xF1 + i % 7));
+                break;
+            case IBM3270_SA:
+                record.append((char) IBM3270_SA);
+                record.append((char) 0x42);
+                record.append((char) (0xF1 + i % 7));
+                break;
+            case IBM3270_RA:
+                record.append((char) IBM3270_RA);
+                appendAddress(record, ((i + 1) * m.width) % size, size);
+                record.append((char) 0xC1);
+                break;
+            case IBM3270_EUA:
+                record.append((char) IBM3270_EUA);
+                appendAddress(record, ((i + 1) * m.width) % size, size);
+                break;
+        }
+    }
+
+    return record;
+}
+
+/**
+ * @brief   baseline - the part of an orders() record that isn't being measured
+ * @param   m     - the screen size
+ * @param   order - the order
+ * @return  the record
+ */
+static QByteArray baseline(const ScreenModel &m, uchar order)
+{
+    int count;
+    QByteArray record = orders(m, order, count);
+
+    if (order != IBM3270_EUA)
+    {
+        return startRecord();
+    }
+
+    return record.left(record.size() - count * 3);
+}
+
+/**
+ * @brief   blinkingScreen - a screen with one blinking field
+ * @param   m     - the screen size
+ * @param   cells - the number of characters in the field
+ * @return  the record
+ */
+static QByteArray blinkingScreen(const ScreenModel &m, int cells)
+{
+    QByteArray record = startRecord();
+
+    record.append((char) IBM3270_SFE);
+    record.append((char) 2);
+    record.append((char) IBM3270_EXT_3270);
+    record.append((char) 0x60);
+    record.append((char) IBM3270_EXT_HILITE);
+    record.append((char) IBM3270_EXT_HI_BLINK);
+
+    record.append(QByteArray(qMin(cells, m.width * m.height - 2), (char) 0xC1));
+
+    record.append((char) IBM3270_SF);
+    record.append((char) 0x60);
+
+    return record;
+}
+
+/**
+ * @brief   timeRecord - measure the time to process a record
+ * @param   s      - the session
+ * @param   record - the record
+ * @return  nanoseconds per record
+ *
+ * @details The record is processed repeatedly for at least 200ms, after a warm up.
+ */
+static double timeRecord(Session &s, const QByteArray &record)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        s.process(record);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    qint64 runs = 0;
+
+    do
+    {
+        for (int i = 0; i < 20; i++)
+        {
+            s.process(record);
+        }
+
+        runs += 20;
+    }
+    while (timer.nsecsElapsed() < 200000000);
+
+    return (double) timer.nsecsElapsed() / runs;
+}
+
+/**
+ * @brief   timeTextRun - compare placing a screen of characters one at a time and as a single run
+ * @param   s      - the session; its screen must already be the size being measured
+ * @param   size   - the number of cells
+ * @param   single - set to nanoseconds per character with DisplayScreen::setChar
+ * @param   run    - set to nanoseconds per character with DisplayScreen::setChars
+ *
+ * @details setChar is the path every character took through ProcessDataStream before text runs were placed
+ *          in bulk.
+ */
+static void timeTextRun(Session &s, int size, double &single, double &run)
+{
+    DisplayScreen &screen = s.displayScreen();
+
+    QByteArray text;
+
+    for (int i = 0; i < size; i++)
+    {
+        text.append((char) (0xC1 + i % 9));
+    }
+
+    const uchar *chars = (const uchar *) text.constData();
+
+    QElapsedTimer timer;
+    qint64 runs = 0;
+
+    timer.start();
+
+    do
+    {
+        for (int i = 0; i < size; i++)
+        {
+            screen.setChar(i, chars[i], false);
+        }
+
+        runs++;
+    }
+    while (timer.nsecsElapsed() < 200000000);
+
+    single = (double) timer.nsecsElapsed() / runs / size;
+
+    runs = 0;
+    timer.restart();
+
+    do
+    {
+        screen.setChars(0, chars, size);
+        runs++;
+    }
+    while (timer.nsecsElapsed() < 200000000);
+
+    run = (double) timer.nsecsElapsed() / runs / size;
+}
+
+/**
+ * @brief   timeNavigation - measure tabbing between the input fields of a formatted screen
+ * @param   s - the session; its screen must hold fullScreen()
+ * @param   m - the screen size
+ * @return  nanoseconds per tab or back tab
+ *
+ * @details Tabs forward round every input field on the screen, then back round them again.
+ */
+static double timeNavigation(Session &s, const ScreenModel &m)
+{
+    DisplayScreen &screen = s.displayScreen();
+
+    QElapsedTimer timer;
+    qint64 moves = 0;
+
+    timer.start();
+
+    do
+    {
+        for (int i = 0; i < m.height; i++)
+        {
+            screen.tab(0);
+        }
+
+        for (int i = 0; i < m.height; i++)
+        {
+            screen.backtab();
+        }
+
+        moves += 2 * m.height;
+    }
+    while (timer.nsecsElapsed() < 200000000);
+
+    return (double) timer.nsecsElapsed() / moves;
+}
+
+/**
+ * @brief   timePaint - measure painting the whole screen
+ * @param   s     - the session; its screen must hold fullScreen()
+ * @param   scale - the scale to paint at, as a view fitted to a larger window would
+ * @param   cold  - set to the nanoseconds taken by a paint with an empty glyph atlas
+ * @return  nanoseconds per paint, once the glyph atlas holds every cell
+ */
+static double timePaint(Session &s, qreal scale, double &cold)
+{
+    DisplayScreen &screen = s.displayScreen();
+
+    QImage image((screen.boundingRect().size() * scale).toSize(), QImage::Format_RGB32);
+    QPainter p(&image);
+
+    p.scale(scale, scale);
+
+    QElapsedTimer timer;
+
+    // Changing the colours discards the glyph atlas
+    screen.resetColours();
+
+    timer.start();
+    screen.paint(&p, nullptr, nullptr);
+    cold = timer.nsecsElapsed();
+
+    qint64 runs = 0;
+
+    timer.start();
+
+    do
+    {
+        screen.paint(&p, nullptr, nullptr);
+        runs++;
+    }
+    while (timer.nsecsElapsed() < 200000000);
+
+    return (double) timer.nsecsElapsed() / runs;
+}
+
+/**
+ * @brief   timeKeystroke - measure typing a character and repainting what it changed
+ * @param   s     - the session; its screen must hold fullScreen()
+ * @param   cells - set to the number of cells painted for each keystroke
+ * @return  nanoseconds per keystroke, repaint included
+ *
+ * @details The screen is put in a scene, as Terminal does, and only the areas the scene reports as changed
+ *          are painted after each keystroke.
+ */
+static double timeKeystroke(Session &s, double &cells)
+{
+    DisplayScreen &screen = s.displayScreen();
+
+    QGraphicsScene scene;
+    QList<QRectF> exposed;
+
+    scene.addItem(&screen);
+
+    QObject::connect(&scene, &QGraphicsScene::changed, [&exposed](const QList<QRectF> &region) {
+        exposed += region;
+    });
+
+    QImage image(screen.boundingRect().size().toSize(), QImage::Format_RGB32);
+    QPainter p(&image);
+    QStyleOptionGraphicsItem option;
+
+    QElapsedTimer timer;
+    qint64 runs = 0;
+    qint64 painted = 0;
+
+    timer.start();
+
+    do
+    {
+        screen.home();
+        screen.insertChar('A' + runs % 26, false);
+
+        QCoreApplication::processEvents();
+
+        for (const QRectF &r : std::as_const(exposed))
+        {
+            option.exposedRect = r;
+            screen.paint(&p, &option, nullptr);
+            painted += screen.cellsPainted();
+        }
+
+        exposed.clear();
+        runs++;
+    }
+    while (timer.nsecsElapsed() < 200000000);
+
+    // The scene would delete the screen
+    scene.removeItem(&screen);
+
+    cells = (double) painted / runs;
+
+    return (double) timer.nsecsElapsed() / runs;
+}
+
+/**
+ * @brief   timeBlink - measure a blink tick and the repaint that follows it
+ * @param   s     - the session
+ * @param   m     - the screen size
+ * @param   cells - the number of blinking characters
+ * @return  nanoseconds per tick, repaint included
+ *
+ * @details As for timeKeystroke(), the screen is put in a scene and only the areas the scene reports as
+ *          changed are rendered.
+ */
+static double timeBlink(Session &s, const ScreenModel &m, int cells)
+{
+    DisplayScreen &screen = s.displayScreen();
+
+    s.process(blinkingScreen(m, cells));
+
+    QGraphicsScene scene;
+    QList<QRectF> exposed;
+
+    scene.addItem(&screen);
+
+    QObject::connect(&scene, &QGraphicsScene::changed, [&exposed](const QList<QRectF> &region) {
+        exposed += region;
+    });
+
+    QImage image(screen.boundingRect().size().toSize(), QImage::Format_RGB32);
+    QPainter p(&image);
+
+    QElapsedTimer timer;
+    qint64 ticks = 0;
+
+    timer.start();
+
+    do
+    {
+        screen.blink();
+
+        QCoreApplication::processEvents();
+
+        for (const QRectF &r : std::as_const(exposed))
+        {
+            scene.render(&p, r, r);
+        }
+
+        exposed.clear();
+        ticks++;
+    }
+    while (timer.nsecsElapsed() < 200000000);
+
+    // The scene would delete the screen
+    scene.removeItem(&screen);
+
+    return (double) timer.nsecsElapsed() / ticks;
+}
+
+/**
+ * @brief   peakRSS - the peak resident set size of the process
+ * @return  kilobytes
+ */
+static qint64 peakRSS()
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+/**
+ * @brief   measureModel - run the synthetic workloads against one screen size
+ * @param   m - the screen size
+ * @return  the results
+ */
+static QJsonObject measureModel(const ScreenModel &m)
+{
+    Session s(m.width, m.height);
+
+    QJsonObject result;
+
+    result["model"] = m.name;
+    result["width"] = m.width;
+    result["height"] = m.height;
+
+    int cells = m.width * m.height;
+
+    double full = timeRecord(s, fullScreen(m));
+
+    result["recordsPerSec"] = 1e9 / full;
+    result["nsPerRecord"] = full;
+    result["nsPerCellParse"] = full / cells;
+
+    // The screen now holds the last fullScreen() record
+    double tab = timeNavigation(s, m);
+    double cold;
+    double coldScaled;
+
+    double paint = timePaint(s, 1, cold);
+    double scaled = timePaint(s, 2, coldScaled);
+
+    double keyCells;
+    double keystroke = timeKeystroke(s, keyCells);
+
+    // The same without the glyph atlas, as runs of text; the first paint lays out every row
+    s.displayScreen().setGlyphCache(false);
+
+    double textCold;
+    double textScaledCold;
+
+    double text = timePaint(s, 1, textCold);
+    double textScaled = timePaint(s, 2, textScaledCold);
+
+    s.displayScreen().setGlyphCache(true);
+
+    // Through the backing image, at a scale where cells are not whole pixels; the first paint draws every cell
+    s.displayScreen().setBackingImage(true);
+
+    double backingCold;
+    double backing = timePaint(s, 1.5, backingCold);
+
+    double backingKeyCells;
+    double backingKeystroke = timeKeystroke(s, backingKeyCells);
+
+    s.displayScreen().setBackingImage(false);
+
+    double blinkOne = timeBlink(s, m, 1);
+    double blinkAll = timeBlink(s, m, cells);
+
+    result["nsPerTab"] = tab;
+    result["nsPerPaint"] = paint;
+    result["nsPerCellPaint"] = paint / cells;
+    result["nsPerPaintCold"] = cold;
+    result["nsPerPaintScaled"] = scaled;
+    result["nsPerPaintScaledCold"] = coldScaled;
+    result["nsPerKeystroke"] = keystroke;
+    result["cellsPerKeystroke"] = keyCells;
+    result["nsPerPaintText"] = text;
+    result["nsPerPaintTextCold"] = textCold;
+    result["nsPerPaintTextScaled"] = textScaled;
+    result["nsPerPaintBacking"] = backing;
+    result["nsPerPaintBackingCold"] = backingCold;
+    result["nsPerKeystrokeBacking"] = backingKeystroke;
+    result["cellsPerKeystrokeBacking"] = backingKeyCells;
+    result["nsPerBlinkOne"] = blinkOne;
+    result["nsPerBlinkAll"] = blinkAll;
+
+    double empty = timeRecord(s, startRecord());
+    double chars = timeRecord(s, characters(m));
+
+    result["nsPerChar"] = (chars - empty) / (m.width * m.height);
+
+    double single;
+    double run;
+
+    timeTextRun(s, m.width * m.height, single, run);
+
+    result["nsPerCharSingle"] = single;
+    result["nsPerCharRun"] = run;
+    result["textRunSpeedup"] = single / run;
+
+    const struct { const char *name; uchar order; } orderList[] = {
+        { "SF",  IBM3270_SF },
+        { "SFE", IBM3270_SFE },
+        { "SBA", IBM3270_SBA },
+        { "RA",  IBM3270_RA },
+        { "EUA", IBM3270_EUA },
+        { "SA",  IBM3270_SA }
+    };
+
+    QJsonObject perOrder;
+
+    for (const auto &o : orderList)
+    {
+        int count;
+
+        double with = timeRecord(s, orders(m, o.order, count));
+        double without = timeRecord(s, baseline(m, o.order));
+
+        perOrder[o.name] = (with - without) / count;
+    }
+
+    result["nsPerOrder"] = perOrder;
+
+    printf("%-8s %3dx%-3d %10.0f records/s %8.2f ns/char (run x%.1f)  SF %.0f  SFE %.0f  SBA %.0f  RA %.0f  EUA %.0f  SA %.0f ns/order\n",
+           m.name, m.width, m.height, 1e9 / full, result["nsPerChar"].toDouble(), result["textRunSpeedup"].toDouble(),
+           perOrder["SF"].toDouble(), perOrder["SFE"].toDouble(), perOrder["SBA"].toDouble(),
+           perOrder["RA"].toDouble(), perOrder["EUA"].toDouble(), perOrder["SA"].toDouble());
+
+    printf("%-8s %3dx%-3d %8.2f ns/cell parse %8.2f ns/cell paint %8.0f ns/tab\n", m.name, m.width, m.height,
+           full / cells, paint / cells, tab);
+
+    printf("%-8s %3dx%-3d %8.0f us/paint (%.0f cold)  %8.0f us/paint at x2 (%.0f cold)\n", m.name, m.width, m.height,
+           paint / 1000, cold / 1000, scaled / 1000, coldScaled / 1000);
+
+    printf("%-8s %3dx%-3d %8.0f us/paint as text (%.0f laying out)  %8.0f us/paint as text at x2\n", m.name, m.width,
+           m.height, text / 1000, textCold / 1000, textScaled / 1000);
+
+    printf("%-8s %3dx%-3d %8.0f us/paint from the backing image at x1.5 (%.0f cold)  %8.0f ns/keystroke, %.0f cells drawn\n",
+           m.name, m.width, m.height, backing / 1000, backingCold / 1000, backingKeystroke, backingKeyCells);
+
+    printf("%-8s %3dx%-3d %8.0f us/blink tick with one cell blinking, %.0f with all\n", m.name, m.width, m.height,
+           blinkOne / 1000, blinkAll / 1000);
+
+    printf("%-8s %3dx%-3d %8.0f ns/keystroke, %.0f of %d cells painted\n", m.name, m.width, m.height, keystroke,
+           keyCells, cells);
+
+    return result;
+}
+
+/**
+ * @brief   scaling - how the cost per cell changes from the smallest screen to the largest
+ * @param   results - the results for each model
+ * @return  the ratio of the largest screen's cost per cell, or per tab, to the smallest's
+ *
+ * @details A ratio near 1 means the cost grows linearly with the number of cells (or, for tabbing, not at
+ *          all); one that grows with the screen size means something is quadratic.
+ */
+static QJsonObject scaling(const QJsonArray &results)
+{
+    QJsonObject first = results.first().toObject();
+    QJsonObject last = results.last().toObject();
+
+    QJsonObject ratio;
+
+    ratio["cells"] = (double) (last["width"].toInt() * last["height"].toInt())
+                     / (first["width"].toInt() * first["height"].toInt());
+    ratio["parse"] = last["nsPerCellParse"].toDouble() / first["nsPerCellParse"].toDouble();
+    ratio["paint"] = last["nsPerCellPaint"].toDouble() / first["nsPerCellPaint"].toDouble();
+    ratio["tab"] = last["nsPerTab"].toDouble() / first["nsPerTab"].toDouble();
+
+    printf("Scaling over x%.1f cells: parse x%.2f, paint x%.2f per cell; tab x%.2f\n", ratio["cells"].toDouble(),
+           ratio["parse"].toDouble(), ratio["paint"].toDouble(), ratio["tab"].toDouble());
+
+    return ratio;
+}
+
+/**
+ * @brief   measureReplay - play a recorded session through the data stream parser
+ * @param   fileName - the recording
+ * @return  the results
+ *
+ * @details The recording is played as fast as possible, several times over, to a screen of the size it was
+ *          recorded with where that can be told from the terminal type.
+ *
+ *          The first, untimed, pass paints the screen after every record and hashes the pixels, so that two
+ *          builds can be shown to render the recording identically by comparing the hashes.
+ */
+static QJsonObject measureReplay(const QString &fileName)
+{
+    QJsonObject result;
+
+    WireTraceReplay replay;
+
+    if (!replay.open(fileName))
+    {
+        fprintf(stderr, "%s: %s\n", qPrintable(fileName), qPrintable(replay.errorString()));
+        return result;
+    }
+
+    QString terminal = replay.session().value("terminal");
+
+    ScreenModel m = models[0];
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (terminal.startsWith(QString("IBM-3279-%1").arg(i + 2)))
+        {
+            m = models[i];
+        }
+    }
+
+    Session s(m.width, m.height);
+
+    QObject::connect(&replay, &WireTraceReplay::dataStreamComplete, &s.dataStream(), &ProcessDataStream::processStream,
+                     Qt::DirectConnection);
+
+    // Warm up, hashing what each record renders
+    QCryptographicHash renderHash(QCryptographicHash::Sha1);
+
+    QMetaObject::Connection painter = QObject::connect(&replay, &WireTraceReplay::dataStreamComplete, &s.dataStream(),
+        [&s, &renderHash](QByteArrayView, bool) {
+            DisplayScreen &screen = s.displayScreen();
+
+            QImage image(screen.boundingRect().size().toSize(), QImage::Format_RGB32);
+            image.fill(Qt::black);
+
+            QPainter p(&image);
+
+            screen.paint(&p, nullptr, nullptr);
+            p.end();
+
+            renderHash.addData(QByteArrayView((const char *) image.constBits(), image.sizeInBytes()));
+        }, Qt::DirectConnection);
+
+    replay.runToEnd();
+
+    QObject::disconnect(painter);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    qint64 records = 0;
+
+    do
+    {
+        records += replay.runToEnd();
+    }
+    while (records > 0 && timer.nsecsElapsed() < 500000000);
+
+    double ns = timer.nsecsElapsed();
+
+    result["file"] = fileName;
+    result["terminal"] = terminal;
+    result["records"] = replay.recordsPlayed();
+    result["recordsPerSec"] = records ? records / (ns / 1e9) : 0.0;
+    result["renderHash"] = QString(renderHash.result().toHex());
+
+    printf("replay   %s: %d records, %.0f records/s, render hash %s\n", qPrintable(fileName), replay.recordsPlayed(),
+           result["recordsPerSec"].toDouble(), qPrintable(result["renderHash"].toString()));
+
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    // DisplayScreen needs a GUI application, but nothing is shown
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Measure the Q3270 data stream parser and screen model");
+    parser.addHelpOption();
+    parser.addOption({ "json", "Write the results as JSON to <file>", "file" });
+    parser.addOption({ "replay", "Also play back the recorded session in <file>", "file" });
+
+    parser.process(a);
+
+    qInstallMessageHandler(discardMessages);
+
+    QJsonArray results;
+
+    for (const ScreenModel &m : models)
+    {
+        results.append(measureModel(m));
+    }
+
+    QJsonObject report;
+
+    report["benchmark"] = "q3270-bench";
+    report["models"] = results;
+    report["scaling"] = scaling(results);
+
+    QJsonArray replays;
+
+    for (const QString &file : parser.values("replay"))
+    {
+        replays.append(measureReplay(file));
+    }
+
+    report["replay"] = replays;
+
+    report["peakRssKB"] = peakRSS();
+
+    printf("Peak RSS: %lld KB\n", (long long) peakRSS());
+
+    if (parser.isSet("json"))
+    {
+        QFile out(parser.value("json"));
+
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            fprintf(stderr, "%s: %s\n", qPrintable(out.fileName()), qPrintable(out.errorString()));
+            return 1;
+        }
+
+        out.write(QJsonDocument(report).toJson());
+    }
+
+    return 0;
+}
@@ -0,0 +1,447 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Q3270.h"
+#include "BenchSession.h"
+#include "ScreenSnapshot.h"
+#include "WireTraceReader.h"
+
+/**
+ * @brief   The Seed struct
+ *
+ * @details A record to start mutating from, and whether it has a TN3270E header.
+ */
+struct Seed
+{
+    QByteArray data;
+    bool tn3270e;
+};
+
+// The record being processed, and where to write it if it crashes; set up before the signal handlers are
+static const char *currentData = nullptr;
+static size_t currentSize = 0;
+static char crashFile[256] = "q3270-fuzz-crash.bin";
+
+/**
+ * @brief   crashed - signal handler that keeps the record that caused a crash
+ * @param   sig - the signal
+ *
+ * @details Only async-signal-safe calls are made. The signal is raised again with the default action, so
+ *          that the exit status and any core dump are as they would have been.
+ */
+static void crashed(int sig)
+{
+    int fd = open(crashFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd >= 0)
+    {
+        if (currentData && write(fd, currentData, currentSize) < 0)
+        {
+            // Nothing more can be done here
+        }
+
+        close(fd);
+    }
+
+    static const char msg[] = "q3270-fuzz: crashed; record written to ";
+
+    if (write(STDERR_FILENO, msg, sizeof(msg) - 1) < 0 || write(STDERR_FILENO, crashFile, strlen(crashFile)) < 0 ||
+        write(STDERR_FILENO, "\n", 1) < 0)
+    {
+        // Nothing more can be done here
+    }
+
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/**
+ * @brief   appendStructuredField - append a structured field with its length
+ * @param   record - the record
+ * @param   sf     - the identifier and contents of the structured field
+ */
+static void appendStructuredField(QByteArray &record, const QByteArray &sf)
+{
+    int length = sf.size() + 2;
+
+    record.append((char) (length >> 8));
+    record.append((char) (length & 0xFF));
+    record.append(sf);
+}
+
+/**
+ * @brief   buildSeeds - records that between them use every command, order and structured field supported
+ * @param   size - the number of cells on the largest screen
+ * @return  the seeds
+ */
+static QVector<Seed> buildSeeds(int size)
+{
+    QVector<Seed> seeds;
+
+    // A formatted screen, with an input field on each row
+    QByteArray screen;
+
+    screen.append((char) IBM3270_EWA);
+    screen.append((char) 0xC3);
+
+    for (int row = 0; row < 24; row++)
+    {
+        screen.append((char) IBM3270_SBA);
+        appendAddress(screen, row * 80, size);
+        screen.append((char) IBM3270_SF);
+        screen.append((char) 0x60);
+        screen.append("\xC8\xC5\xD3\xD3\xD6", 5);
+        screen.append((char) IBM3270_SF);
+        screen.append((char) 0x40);
+        screen.append("\x81\x82\x83", 3);
+    }
+
+    screen.append((char) IBM3270_IC);
+
+    seeds.append({ screen, false });
+
+    // Every order, on the screen already there
+    QByteArray orders;
+
+    orders.append((char) IBM3270_W);
+    orders.append((char) 0xC1);
+    orders.append((char) IBM3270_SBA);
+    appendAddress(orders, 85, size);
+    orders.append((char) IBM3270_SFE);
+    orders.append((char) 3);
+    orders.append("\xC0\x40\x42\xF2\x41\xF1", 6);
+    orders.append((char) IBM3270_SA);
+    orders.append("\x42\xF4", 2);
+    orders.append("\xC1\xC2", 2);
+    orders.append((char) IBM3270_GE);
+    orders.append((char) 0xAD);
+    orders.append((char) IBM3270_RA);
+    appendAddress(orders, 160, size);
+    orders.append((char) IBM3270_GE);
+    orders.append((char) 0xA2);
+    orders.append((char) IBM3270_MF);
+    orders.append((char) 1);
+    orders.append("\x41\xF4", 2);
+    orders.append((char) IBM3270_PT);
+    orders.append((char) IBM3270_PT);
+    orders.append((char) IBM3270_EUA);
+    appendAddress(orders, 400, size);
+    orders.append((char) IBM3270_SF);
+    orders.append((char) 0xF1);
+    orders.append((char) IBM3270_IC);
+
+    seeds.append({ orders, false });
+
+    // Read commands
+    seeds.append({ QByteArray(1, (char) IBM3270_RB), false });
+    seeds.append({ QByteArray(1, (char) IBM3270_RM), false });
+    seeds.append({ QByteArray(1, (char) IBM3270_EAU), false });
+
+    // Structured fields: Reset Partition, Read Partition Query and Outbound 3270DS in one record
+    QByteArray wsf;
+
+    wsf.append((char) IBM3270_WSF);
+    appendStructuredField(wsf, QByteArray("\x00\x00", 2));
+    appendStructuredField(wsf, QByteArray("\x01\xFF\x02", 3));
+
+    QByteArray outbound("\x40\x00", 2);
+
+    outbound.append((char) IBM3270_W);
+    outbound.append((char) 0xC2);
+    outbound.append(orders.mid(2));
+
+    appendStructuredField(wsf, outbound);
+
+    seeds.append({ wsf, false });
+
+    // The same, with a TN3270E header
+    QByteArray tn3270e("\x00\x00\x00\x00\x01", 5);
+
+    seeds.append({ tn3270e + screen, true });
+    seeds.append({ tn3270e + wsf, true });
+
+    return seeds;
+}
+
+/**
+ * @brief   loadTrace - add the inbound 3270 records from a wire trace to the seeds
+ * @param   fileName - the trace
+ * @param   seeds    - the seeds
+ * @return  false if the trace could not be read
+ */
+static bool loadTrace(const QString &fileName, QVector<Seed> &seeds)
+{
+    WireTraceReader reader;
+
+    if (!reader.open(fileName))
+    {
+        fprintf(stderr, "%s: %s\n", qPrintable(fileName), qPrintable(reader.errorString()));
+        return false;
+    }
+
+    WireTraceReader::Record record;
+
+    while (reader.next(record))
+    {
+        if (record.direction == WireTrace::Inbound && record.type == WireTrace::Data)
+        {
+            seeds.append({ record.data.toByteArray(), bool(record.flags & WireTrace::TN3270E) });
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief   The Mutator class
+ *
+ * @details Makes a new record from a seed with a few random changes, biased towards the bytes the parser
+ *          cares about and towards cutting records short.
+ */
+class Mutator
+{
+    public:
+
+        explicit Mutator(quint64 seed) : rng(seed)
+        {
+        }
+
+        int below(int n)
+        {
+            return n > 0 ? int(rng() % quint64(n)) : 0;
+        }
+
+        void mutate(QByteArray &record, const QVector<Seed> &seeds);
+
+    private:
+
+        std::mt19937_64 rng;
+
+        uchar interestingByte();
+};
+
+/**
+ * @brief   Mutator::interestingByte - a byte that means something to the parser
+ * @return  the byte
+ */
+uchar Mutator::interestingByte()
+{
+    static const uchar bytes[] = {
+        IBM3270_SF, IBM3270_SFE, IBM3270_SBA, IBM3270_SA, IBM3270_MF, IBM3270_IC, IBM3270_PT, IBM3270_RA,
+        IBM3270_EUA, IBM3270_GE, IBM3270_W, IBM3270_EW, IBM3270_EWA, IBM3270_WSF, IBM3270_RB,
+        IBM3270_WSF_OB3270DS, IBM3270_WSF_READPARTITION, IBM3270_WSF_RESET,
+        0x00, 0x01, 0x02, 0x3F, 0x40, 0x7F, 0x80, 0xBF, 0xC0, 0xFE, 0xFF
+    };
+
+    return bytes[below(sizeof(bytes))];
+}
+
+/**
+ * @brief   Mutator::mutate - apply up to eight random changes to a record
+ * @param   record - the record
+ * @param   seeds  - the seeds, to splice from
+ */
+void Mutator::mutate(QByteArray &record, const QVector<Seed> &seeds)
+{
+    int changes = 1 + below(8);
+
+    for (int i = 0; i < changes; i++)
+    {
+        int pos = below(record.size());
+
+        switch (below(7))
+        {
+            case 0:
+                if (!record.isEmpty())
+                {
+                    record[pos] = (char) (record[pos] ^ (1 << below(8)));
+                }
+                break;
+            case 1:
+                if (!record.isEmpty())
+                {
+                    record[pos] = (char) interestingByte();
+                }
+                break;
+            case 2:
+                record.insert(pos, (char) interestingByte());
+                break;
+            case 3:
+                record.remove(pos, 1 + below(8));
+                break;
+            case 4:
+                record.truncate(pos);
+                break;
+            case 5:
+                record.insert(pos, record.mid(below(record.size()), 1 + below(16)));
+                break;
+            case 6:
+            {
+                const QByteArray &other = seeds[below(seeds.size())].data;
+
+                record = record.left(pos) + other.mid(below(other.size()));
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // DisplayScreen needs a GUI application, but nothing is shown
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Feed mutated 3270 records through the Q3270 data stream parser and screen model. "
+                                     "Build with -fsanitize=address,undefined to catch reads past the end of a "
+                                     "record as well as crashes.");
+    parser.addHelpOption();
+    parser.addOption({ "seconds", "Run for <n> seconds (default 60)", "n", "60" });
+    parser.addOption({ "iterations", "Stop after <n> records", "n" });
+    parser.addOption({ "seed", "Random number seed, to repeat a run", "n" });
+    parser.addOption({ "replay", "Also start from the records in the wire trace <file>", "file" });
+    parser.addOption({ "crash", "Write the record that crashes to <file>", "file" });
+
+    parser.process(a);
+
+    qInstallMessageHandler(discardMessages);
+
+    quint64 seed = parser.isSet("seed") ? parser.value("seed").toULongLong() : std::random_device()();
+    double seconds = parser.value("seconds").toDouble();
+    qint64 iterations = parser.isSet("iterations") ? parser.value("iterations").toLongLong() : -1;
+
+    if (parser.isSet("crash"))
+    {
+        qstrncpy(crashFile, qPrintable(parser.value("crash")), sizeof(crashFile));
+    }
+
+    // Addresses are 14 bit for the largest screen, 12 bit otherwise
+    static const struct { int width; int height; } models[] = {
+        {  80, 24 },
+        {  80, 43 },
+        { 132, 27 },
+        { 160, 62 }
+    };
+
+    QVector<Seed> seeds = buildSeeds(160 * 62);
+
+    for (const QString &file : parser.values("replay"))
+    {
+        if (!loadTrace(file, seeds))
+        {
+            return 1;
+        }
+    }
+
+    std::vector<std::unique_ptr<Session>> sessions;
+
+    for (const auto &m : models)
+    {
+        sessions.push_back(std::make_unique<Session>(m.width, m.height));
+    }
+
+    signal(SIGSEGV, crashed);
+    signal(SIGABRT, crashed);
+    signal(SIGBUS, crashed);
+    signal(SIGFPE, crashed);
+
+    printf("q3270-fuzz: seed %llu, %lld seed records\n", (unsigned long long) seed, (long long) seeds.size());
+
+    Mutator mutator(seed);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    qint64 records = 0;
+    qint64 nextReport = 1000000;
+
+    QByteArray record;
+    QByteArray reply;
+
+    while (iterations < 0 || records < iterations)
+    {
+        const Seed &s = seeds[mutator.below(seeds.size())];
+
+        record = s.data;
+        mutator.mutate(record, seeds);
+
+        // A copy of exactly the record's size, so that a sanitizer sees any read past its end
+        size_t size = record.size();
+        std::unique_ptr<char[]> data(new char[size ? size : 1]);
+
+        memcpy(data.get(), record.constData(), size);
+
+        currentData = data.get();
+        currentSize = size;
+
+        Session &session = *sessions[records % sessions.size()];
+
+        session.dataStream().processStream(QByteArrayView(data.get(), size), s.tn3270e);
+
+        // Now and then, read what the records built
+        if (mutator.below(64) == 0)
+        {
+            DisplayScreen &screen = session.displayScreen();
+
+            reply.clear();
+            screen.getScreen(reply);
+
+            reply.clear();
+            screen.getModifiedFields(reply);
+
+            ScreenSnapshotPtr snapshot = screen.takeSnapshot();
+            screen.applySnapshot(*snapshot);
+        }
+
+        currentData = nullptr;
+
+        records++;
+
+        if (records == nextReport)
+        {
+            nextReport += 1000000;
+
+            printf("%lld records, %.0f records/s\n", (long long) records, records / (timer.nsecsElapsed() / 1e9));
+            fflush(stdout);
+        }
+
+        if ((records & 1023) == 0 && timer.nsecsElapsed() >= seconds * 1e9)
+        {
+            break;
+        }
+    }
+
+    double elapsed = timer.nsecsElapsed() / 1e9;
+
+    printf("q3270-fuzz: %lld records in %.1fs, %.0f records/s, no crashes\n", (long long) records, elapsed,
+           records / elapsed);
+
+    return 0;
+}
@@ -0,0 +1,303 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QKeyEvent>
+#include <QThread>
+
+#include "Q3270.h"
+#include "BenchSession.h"
+#include "Keyboard.h"
+#include "SocketConnection.h"
+#include "StandInHost.h"
+
+/**
+ * @brief   The PaintTimedView class
+ *
+ * @details A QGraphicsView that notes when it has finished painting, after a record has arrived.
+ */
+class PaintTimedView : public QGraphicsView
+{
+    public:
+
+        explicit PaintTimedView(QGraphicsScene *scene) : QGraphicsView(scene), recordTime(0), paintTime(0)
+        {
+        }
+
+        // Set when a record arrives; the next paint after it is the one measured
+        qint64 recordTime;
+        qint64 paintTime;
+
+    protected:
+
+        void paintEvent(QPaintEvent *event) override
+        {
+            QGraphicsView::paintEvent(event);
+
+            if (recordTime && !paintTime)
+            {
+                paintTime = StandInHost::now();
+            }
+        }
+};
+
+/**
+ * @brief   The Distribution struct
+ *
+ * @details A set of latency samples, in nanoseconds.
+ */
+struct Distribution
+{
+    QList<qint64> samples;
+
+    qint64 percentile(double p) const
+    {
+        if (samples.isEmpty())
+        {
+            return 0;
+        }
+
+        QList<qint64> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        return sorted.at(qMin((qsizetype) (p * sorted.size()), sorted.size() - 1));
+    }
+
+    QJsonObject report(const char *name) const
+    {
+        QJsonObject r;
+
+        r["min"] = percentile(0.0) / 1e3;
+        r["median"] = percentile(0.5) / 1e3;
+        r["p99"] = percentile(0.99) / 1e3;
+        r["max"] = percentile(1.0) / 1e3;
+
+        printf("%-16s min %8.1f  median %8.1f  p99 %8.1f  max %8.1f us\n", name, r["min"].toDouble(),
+               r["median"].toDouble(), r["p99"].toDouble(), r["max"].toDouble());
+
+        return r;
+    }
+};
+
+/**
+ * @brief   waitFor - run the event loop until a condition is met
+ * @param   done    - the condition
+ * @param   timeout - milliseconds to wait
+ * @return  true if the condition was met
+ */
+static bool waitFor(const std::function<bool()> &done, int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!done())
+    {
+        if (timer.elapsed() > timeout)
+        {
+            return false;
+        }
+
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+
+    return true;
+}
+
+/**
+ * @brief   main - measure keystroke and paint latency against a stand-in host
+ *
+ * @details The stand-in host runs on its own thread and Q3270's SocketConnection, ProcessDataStream,
+ *          DisplayScreen and Keyboard run on the main thread, wired as Terminal wires them, on the offscreen
+ *          platform. For each iteration an ENTER key press and release go through Keyboard::eventFilter, and
+ *          two intervals are measured:
+ *
+ *          keystroke to EOR - from the key press until the host has received the whole inbound record
+ *          EOR to paint     - from the complete reply reaching dataStreamComplete until the view has painted it
+ *
+ *          Both ends of each interval are taken from the same monotonic clock.
+ */
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Measure Q3270 keystroke to EOR and EOR to paint latency");
+    parser.addHelpOption();
+    parser.addOption({ "iterations", "Number of keystrokes (default 200)", "n", "200" });
+    parser.addOption({ "script", "Have the host serve the screens in <file>", "file" });
+    parser.addOption({ "delay", "Host waits <ms> before replying", "ms", "0" });
+    parser.addOption({ "bandwidth", "Host replies at <bytes> per second", "bytes", "0" });
+    parser.addOption({ "record-size", "Host pads each screen to at least <bytes>", "bytes", "0" });
+    parser.addOption({ "no-tn3270e", "Host refuses TN3270E" });
+    parser.addOption({ "json", "Write the results as JSON to <file>", "file" });
+
+    parser.process(a);
+
+    qInstallMessageHandler(discardMessages);
+
+    // The host
+    QThread hostThread;
+    StandInHost *host = new StandInHost;
+
+    if (parser.isSet("script"))
+    {
+        QString error;
+        QList<QByteArray> screens = StandInHost::loadScript(parser.value("script"), error);
+
+        if (screens.isEmpty())
+        {
+            fprintf(stderr, "%s: %s\n", qPrintable(parser.value("script")), qPrintable(error.isEmpty() ? QString("no screens") : error));
+            return 1;
+        }
+
+        host->setScreens(screens);
+    }
+
+    host->setDelay(parser.value("delay").toInt());
+    host->setBandwidth(parser.value("bandwidth").toLongLong());
+    host->setRecordSize(parser.value("record-size").toInt());
+    host->setTN3270E(!parser.isSet("no-tn3270e"));
+
+    if (!host->listen())
+    {
+        fprintf(stderr, "Cannot listen on localhost\n");
+        return 1;
+    }
+
+    quint16 port = host->serverPort();
+
+    host->moveToThread(&hostThread);
+    QObject::connect(&hostThread, &QThread::finished, host, &QObject::deleteLater);
+    hostThread.start();
+
+    bool started = false;
+    qint64 aidTime = 0;
+
+    QObject::connect(host, &StandInHost::sessionStarted, &a, [&started](bool) { started = true; });
+    QObject::connect(host, &StandInHost::aidReceived, &a, [&aidTime](int, qint64 when) { aidTime = when; });
+
+    // The terminal; the session is destroyed before the scene, which takes the screen out of it
+    QGraphicsScene scene;
+    Session session(80, 24);
+
+    DisplayScreen *screen = &session.displayScreen();
+    ProcessDataStream &datastream = session.dataStream();
+
+    scene.addItem(screen);
+
+    PaintTimedView view(&scene);
+    view.resize(800, 600);
+    view.show();
+
+    SocketConnection socket(0);
+
+    Keyboard kbd;
+    view.installEventFilter(&kbd);
+
+    QObject::connect(screen, &DisplayScreen::bufferReady, &socket, &SocketConnection::sendResponse);
+    QObject::connect(screen, &DisplayScreen::telnetCommand, &socket, &SocketConnection::sendCommand);
+    QObject::connect(&datastream, &ProcessDataStream::bufferReady, &socket, &SocketConnection::sendResponse);
+
+    // Timestamp the record before it is processed; this is connected first so it is called first
+    QObject::connect(&socket, &SocketConnection::dataStreamComplete, &socket, [&view](QByteArrayView, bool) {
+        view.recordTime = StandInHost::now();
+    }, Qt::DirectConnection);
+    QObject::connect(&socket, &SocketConnection::dataStreamComplete, &datastream, &ProcessDataStream::processStream, Qt::DirectConnection);
+
+    QObject::connect(&kbd, &Keyboard::key_AID, screen, &DisplayScreen::processAID);
+    QObject::connect(&datastream, &ProcessDataStream::unlockKeyboard, &a, [&kbd]() { kbd.setLocked(false); });
+
+    kbd.setConnected(true);
+
+    socket.connectMainframe("127.0.0.1", port, "", &datastream);
+
+    // Wait for the first screen to be painted
+    if (!waitFor([&]() { return started && view.paintTime; }, 10000))
+    {
+        fprintf(stderr, "No screen from the stand-in host\n");
+        return 1;
+    }
+
+    Distribution keyToEor;
+    Distribution eorToPaint;
+
+    int iterations = parser.value("iterations").toInt();
+
+    for (int i = 0; i < iterations; i++)
+    {
+        aidTime = 0;
+        view.recordTime = 0;
+        view.paintTime = 0;
+
+        QKeyEvent press(QEvent::KeyPress, Qt::Key_Enter, Qt::NoModifier);
+        QKeyEvent release(QEvent::KeyRelease, Qt::Key_Enter, Qt::NoModifier);
+
+        qint64 keyTime = StandInHost::now();
+
+        QCoreApplication::sendEvent(&view, &press);
+        QCoreApplication::sendEvent(&view, &release);
+
+        if (!waitFor([&]() { return aidTime && view.paintTime; }, 10000))
+        {
+            fprintf(stderr, "Iteration %d: no reply from the stand-in host\n", i);
+            return 1;
+        }
+
+        keyToEor.samples.append(aidTime - keyTime);
+        eorToPaint.samples.append(view.paintTime - view.recordTime);
+    }
+
+    socket.disconnectMainframe();
+
+    hostThread.quit();
+    hostThread.wait();
+
+    QJsonObject report;
+
+    report["benchmark"] = "q3270-latency";
+    report["iterations"] = iterations;
+    report["delayMs"] = parser.value("delay").toInt();
+    report["bandwidth"] = parser.value("bandwidth").toLongLong();
+    report["recordSize"] = parser.value("record-size").toInt();
+    report["keystrokeToEorUs"] = keyToEor.report("keystroke->EOR");
+    report["eorToPaintUs"] = eorToPaint.report("EOR->paint");
+
+    if (parser.isSet("json"))
+    {
+        QFile out(parser.value("json"));
+
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            fprintf(stderr, "%s: %s\n", qPrintable(out.fileName()), qPrintable(out.errorString()));
+            return 1;
+        }
+
+        out.write(QJsonDocument(report).toJson());
+    }
+
+    return 0;
+}
@@ -0,0 +1,535 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <chrono>
+
+#include <QFile>
+#include <QTextStream>
+
+#include <arpa/telnet.h>
+
+#include "StandInHost.h"
+#include "BufferAddress.h"
+#include "CodePage.h"
+#include "WireTraceReader.h"
+
+/**
+ * @brief   appendSBA - append a Set Buffer Address order for an 80 column screen
+ * @param   record - the record
+ * @param   pos    - the buffer address
+ */
+static void appendSBA(QByteArray &record, int pos)
+{
+    record.append((char) IBM3270_SBA);
+    appendAddress(record, pos, 24 * 80);
+}
+
+/**
+ * @brief   buildScreen - build an Erase/Write record from lines of text
+ * @param   lines - up to 24 lines
+ * @return  the record
+ *
+ * @details Each line is a protected field, unless it starts with '>', in which case it is an unprotected
+ *          input field. The cursor is put in the first input field.
+ */
+static QByteArray buildScreen(const QStringList &lines)
+{
+    CodePage cp;
+
+    QByteArray record;
+
+    record.append((char) IBM3270_EW);
+    record.append((char) 0xC3);
+
+    int cursor = -1;
+
+    for (int row = 0; row < qMin((int) lines.size(), 24); row++)
+    {
+        QString text = lines.at(row);
+
+        appendSBA(record, row * 80);
+
+        if (text.startsWith('>'))
+        {
+            record.append((char) IBM3270_SF);
+            record.append((char) 0x40);
+
+            text = text.mid(1);
+
+            if (cursor < 0)
+            {
+                cursor = row * 80 + 1;
+            }
+        }
+        else
+        {
+            record.append((char) IBM3270_SF);
+            record.append((char) 0x60);
+        }
+
+        QByteArray latin1 = text.left(79).toLatin1();
+
+        for (char c : latin1)
+        {
+            record.append((char) cp.getEBCDIC((uchar) c));
+        }
+    }
+
+    appendSBA(record, cursor < 0 ? 0 : cursor);
+    record.append((char) IBM3270_IC);
+
+    return record;
+}
+
+/**
+ * @brief   StandInHost::StandInHost - a stand-in TN3270(E) host
+ * @param   parent - parent object
+ *
+ * @details The server and timer are children of the host so that it can be moved to another thread.
+ */
+StandInHost::StandInHost(QObject *parent) : QObject(parent), server(this), client(nullptr), nextScreen(0), delay(0),
+                                             bandwidth(0), recordSize(0), offerTN3270E(true), tn3270e(false),
+                                             pendingSent(0), pacer(this)
+{
+    screens = defaultScreens();
+
+    connect(&server, &QTcpServer::newConnection, this, &StandInHost::newConnection);
+
+    pacer.setTimerType(Qt::PreciseTimer);
+    connect(&pacer, &QTimer::timeout, this, &StandInHost::sendChunk);
+}
+
+/**
+ * @brief   StandInHost::now - the clock used for timestamps
+ * @return  nanoseconds from an arbitrary starting point
+ */
+qint64 StandInHost::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief   StandInHost::listen - start listening for a client
+ * @param   port - the port, or 0 for any free port
+ * @return  true if the server is listening
+ */
+bool StandInHost::listen(quint16 port)
+{
+    return server.listen(QHostAddress::LocalHost, port);
+}
+
+/**
+ * @brief   StandInHost::setScreens - set the screens sent to the client
+ * @param   records - 3270 records, each starting with a write command
+ */
+void StandInHost::setScreens(const QList<QByteArray> &records)
+{
+    if (!records.isEmpty())
+    {
+        screens = records;
+    }
+}
+
+/**
+ * @brief   StandInHost::defaultScreens - screens used when no script is given
+ * @return  a logon panel and a full list
+ */
+QList<QByteArray> StandInHost::defaultScreens()
+{
+    QStringList logon;
+
+    logon << "Q3270 STAND-IN HOST" << "" << "Enter anything and press ENTER" << "" << ">";
+
+    QStringList list;
+
+    list << "LIST                                                        ROW 1 OF 20";
+    list << "COMMAND ===>";
+
+    for (int i = 1; i <= 20; i++)
+    {
+        list << QString("  DATASET.NUMBER%1.LIBRARY                 %2 TRACKS     PO     FB     80")
+                    .arg(i, 3, 10, QChar('0')).arg(i * 15, 5);
+    }
+
+    list << ">";
+
+    return { buildScreen(logon), buildScreen(list) };
+}
+
+/**
+ * @brief   StandInHost::loadScript - read screens from a script
+ * @param   fileName - the script
+ * @param   error    - set if the script can't be read
+ * @return  the screens
+ *
+ * @details A script is plain text. Screens are separated by a line containing only "%%"; within a screen,
+ *          each line is a row, and a line starting with '>' is an input field.
+ */
+QList<QByteArray> StandInHost::loadScript(const QString &fileName, QString &error)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        error = file.errorString();
+        return {};
+    }
+
+    QList<QByteArray> records;
+    QStringList lines;
+
+    QTextStream in(&file);
+
+    while (!in.atEnd())
+    {
+        QString line = in.readLine();
+
+        if (line == "%%")
+        {
+            records.append(buildScreen(lines));
+            lines.clear();
+        }
+        else
+        {
+            lines.append(line);
+        }
+    }
+
+    if (!lines.isEmpty())
+    {
+        records.append(buildScreen(lines));
+    }
+
+    return records;
+}
+
+/**
+ * @brief   StandInHost::loadRecording - read screens from a wire trace recording
+ * @param   fileName - the recording
+ * @param   error    - set if the recording can't be read
+ * @return  the inbound 3270 records, without any TN3270E header
+ */
+QList<QByteArray> StandInHost::loadRecording(const QString &fileName, QString &error)
+{
+    WireTraceReader reader;
+
+    if (!reader.open(fileName))
+    {
+        error = reader.errorString();
+        return {};
+    }
+
+    QList<QByteArray> records;
+    WireTraceReader::Record record;
+
+    while (reader.next(record))
+    {
+        if (record.direction == WireTrace::Inbound && record.type == WireTrace::Data)
+        {
+            QByteArrayView data = record.flags & WireTrace::TN3270E ? record.data.sliced(qMin(record.data.size(), 5))
+                                                                    : record.data;
+
+            if (!data.isEmpty())
+            {
+                records.append(data.toByteArray());
+            }
+        }
+    }
+
+    return records;
+}
+
+/**
+ * @brief   StandInHost::newConnection - a client has connected
+ *
+ * @details Only one client is served; any others are closed straight away. Negotiation starts with
+ *          DO TN3270E, or DO TTYPE if TN3270E is not being offered.
+ */
+void StandInHost::newConnection()
+{
+    QTcpSocket *s = server.nextPendingConnection();
+
+    if (client)
+    {
+        s->close();
+        s->deleteLater();
+        return;
+    }
+
+    client = s;
+    client->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+    connect(client, &QTcpSocket::readyRead, this, &StandInHost::readClient);
+    connect(client, &QTcpSocket::disconnected, this, &StandInHost::clientClosed);
+
+    decoder.reset();
+    tn3270e = false;
+    nextScreen = 0;
+
+    sendRaw(QByteArray::fromRawData("\xFF\xFD", 2) + (char) (offerTN3270E ? TELOPT_TN3270E : TELOPT_TTYPE));
+}
+
+/**
+ * @brief   StandInHost::clientClosed - the client has disconnected
+ */
+void StandInHost::clientClosed()
+{
+    pacer.stop();
+    pending.clear();
+
+    client->deleteLater();
+    client = nullptr;
+
+    emit sessionEnded();
+}
+
+/**
+ * @brief   StandInHost::readClient - process data from the client
+ */
+void StandInHost::readClient()
+{
+    QByteArray data = client->readAll();
+
+    decoder.feed(data.constData(), data.size());
+
+    TelnetDecoder::Event event;
+
+    while ((event = decoder.next()) != TelnetDecoder::NeedData)
+    {
+        switch (event)
+        {
+            case TelnetDecoder::Record:
+                processRecord(decoder.record());
+                break;
+            case TelnetDecoder::Command:
+                processCommand(decoder.command(), decoder.option());
+                break;
+            case TelnetDecoder::SubNegotiation:
+                processSubNegotiation(decoder.subNegotiation());
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief   StandInHost::processCommand - respond to the client's option negotiation
+ * @param   command - WILL, WONT, DO or DONT
+ * @param   option  - the option
+ */
+void StandInHost::processCommand(uchar command, uchar option)
+{
+    QByteArray reply;
+
+    if (command == WILL && option == TELOPT_TN3270E)
+    {
+        reply.append("\xFF\xFA", 2).append((char) TELOPT_TN3270E).append((char) TN3270E_SEND);
+        reply.append((char) TN3270E_DEVICE_TYPE).append("\xFF\xF0", 2);
+    }
+    else if (command == WONT && option == TELOPT_TN3270E)
+    {
+        reply.append("\xFF\xFD", 2).append((char) TELOPT_TTYPE);
+    }
+    else if (command == WILL && option == TELOPT_TTYPE)
+    {
+        reply.append("\xFF\xFA", 2).append((char) TELOPT_TTYPE).append((char) TELQUAL_SEND).append("\xFF\xF0", 2);
+    }
+
+    if (!reply.isEmpty())
+    {
+        sendRaw(reply);
+    }
+}
+
+/**
+ * @brief   StandInHost::processSubNegotiation - respond to a sub-negotiation from the client
+ * @param   sb - the sub-negotiation, without IAC SB and IAC SE
+ *
+ * @details The terminal type is accepted whatever it is. Once it is known (and, for TN3270E, the
+ *          functions have been agreed), the first screen is sent.
+ */
+void StandInHost::processSubNegotiation(const QByteArray &sb)
+{
+    QByteArray reply;
+
+    if (sb.size() >= 2 && (uchar) sb.at(0) == TELOPT_TTYPE && (uchar) sb.at(1) == TELQUAL_IS)
+    {
+        for (uchar option : { TELOPT_EOR, TELOPT_BINARY })
+        {
+            reply.append("\xFF\xFD", 2).append((char) option);
+            reply.append("\xFF\xFB", 2).append((char) option);
+        }
+
+        sendRaw(reply);
+
+        emit sessionStarted(false);
+
+        sendScreen();
+    }
+    else if (sb.size() >= 3 && (uchar) sb.at(0) == TELOPT_TN3270E && sb.at(1) == TN3270E_DEVICE_TYPE
+             && sb.at(2) == TN3270E_REQUEST)
+    {
+        QByteArray type = sb.mid(3);
+
+        // Any ASSOCIATE or CONNECT that follows the device type is ignored
+        qsizetype end = type.indexOf((char) TN3270E_CONNECT);
+
+        if (end >= 0)
+        {
+            type.truncate(end);
+        }
+
+        reply.append("\xFF\xFA", 2).append((char) TELOPT_TN3270E).append((char) TN3270E_DEVICE_TYPE);
+        reply.append((char) TN3270E_IS).append(type).append((char) TN3270E_CONNECT).append("STANDIN");
+        reply.append("\xFF\xF0", 2);
+
+        sendRaw(reply);
+    }
+    else if (sb.size() >= 3 && (uchar) sb.at(0) == TELOPT_TN3270E && sb.at(1) == TN3270E_FUNCTIONS
+             && sb.at(2) == TN3270E_REQUEST)
+    {
+        reply.append("\xFF\xFA", 2).append((char) TELOPT_TN3270E).append((char) TN3270E_FUNCTIONS);
+        reply.append((char) TN3270E_IS).append(sb.mid(3)).append("\xFF\xF0", 2);
+
+        sendRaw(reply);
+
+        tn3270e = true;
+
+        emit sessionStarted(true);
+
+        sendScreen();
+    }
+}
+
+/**
+ * @brief   StandInHost::processRecord - an inbound 3270 record from the client
+ * @param   record - the record
+ *
+ * @details The first byte (after any TN3270E header) is the AID. The next screen is sent after the delay.
+ */
+void StandInHost::processRecord(QByteArrayView record)
+{
+    qint64 when = now();
+
+    qsizetype header = tn3270e ? 5 : 0;
+
+    if (record.size() <= header)
+    {
+        return;
+    }
+
+    emit aidReceived((uchar) record.at(header), when);
+
+    QTimer::singleShot(delay, this, &StandInHost::sendScreen);
+}
+
+/**
+ * @brief   StandInHost::sendRaw - write bytes to the client as they are
+ * @param   bytes - the bytes
+ */
+void StandInHost::sendRaw(const QByteArray &bytes)
+{
+    if (client)
+    {
+        client->write(bytes);
+    }
+}
+
+/**
+ * @brief   StandInHost::sendScreen - send the next screen
+ *
+ * @details The screen is padded to the record size by repeating its orders, which draws the same screen
+ *          again, then framed. Without a bandwidth limit it is written in one go; otherwise it is written a
+ *          piece at a time by sendChunk().
+ */
+void StandInHost::sendScreen()
+{
+    if (!client || screens.isEmpty())
+    {
+        return;
+    }
+
+    QByteArray record = screens.at(nextScreen);
+    nextScreen = (nextScreen + 1) % screens.size();
+
+    if (recordSize > record.size() && record.size() > 2)
+    {
+        QByteArray orders = record.mid(2);
+
+        while (record.size() < recordSize)
+        {
+            record.append(orders);
+        }
+    }
+
+    pending.clear();
+
+    if (tn3270e)
+    {
+        pending.append((char) TN3270E_DATATYPE_3270_DATA);
+        pending.append(4, 0x00);
+    }
+
+    for (char c : record)
+    {
+        pending.append(c);
+
+        if ((uchar) c == IAC)
+        {
+            pending.append(c);
+        }
+    }
+
+    pending.append((char) IAC);
+    pending.append((char) EOR);
+
+    pendingSent = 0;
+
+    if (bandwidth <= 0)
+    {
+        pendingSent = pending.size();
+        client->write(pending);
+        client->flush();
+
+        emit screenSent(now());
+        return;
+    }
+
+    pacer.start(10);
+    sendChunk();
+}
+
+/**
+ * @brief   StandInHost::sendChunk - send the next piece of a screen at the configured bandwidth
+ */
+void StandInHost::sendChunk()
+{
+    if (!client || pendingSent >= pending.size())
+    {
+        pacer.stop();
+        return;
+    }
+
+    qsizetype chunk = qMax((qint64) 1, bandwidth / 100);
+
+    chunk = qMin(chunk, pending.size() - pendingSent);
+
+    client->write(pending.constData() + pendingSent, chunk);
+    client->flush();
+
+    pendingSent += chunk;
+
+    if (pendingSent >= pending.size())
+    {
+        pacer.stop();
+        emit screenSent(now());
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef STANDINHOST_H
+#define STANDINHOST_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "TelnetDecoder.h"
+
+/**
+ * @brief   The StandInHost class
+ *
+ * @details StandInHost is a small TN3270(E) server for testing Q3270 without a mainframe. It accepts one
+ *          connection at a time on localhost, performs the TTYPE, BINARY and EOR negotiation, or TN3270E
+ *          negotiation if the client agrees to it, and then sends a screen. Each time an AID comes back, the
+ *          next screen is sent, cycling through the list.
+ *
+ *          The reply can be held back by a fixed delay, sent at a limited bandwidth, and padded to a given
+ *          record size, to imitate a slow or busy host.
+ *
+ *          Timestamps in the signals are from now(), a monotonic clock in nanoseconds, so that a test harness
+ *          in the same process can compare them with its own.
+ */
+class StandInHost : public QObject
+{
+    Q_OBJECT
+
+    public:
+
+        explicit StandInHost(QObject *parent = nullptr);
+
+        bool listen(quint16 port = 0);
+        quint16 serverPort() const                  { return server.serverPort(); }
+
+        void setScreens(const QList<QByteArray> &records);
+        void setDelay(int ms)                       { delay = ms; }
+        void setBandwidth(qint64 bytesPerSecond)    { bandwidth = bytesPerSecond; }
+        void setRecordSize(int bytes)               { recordSize = bytes; }
+        void setTN3270E(bool enabled)               { offerTN3270E = enabled; }
+
+        static qint64 now();
+
+        static QList<QByteArray> defaultScreens();
+        static QList<QByteArray> loadScript(const QString &fileName, QString &error);
+        static QList<QByteArray> loadRecording(const QString &fileName, QString &error);
+
+    signals:
+
+        void sessionStarted(bool tn3270e);
+        void aidReceived(int aid, qint64 when);
+        void screenSent(qint64 when);
+        void sessionEnded();
+
+    private slots:
+
+        void newConnection();
+        void readClient();
+        void clientClosed();
+        void sendChunk();
+
+    private:
+
+        QTcpServer server;
+        QTcpSocket *client;
+
+        TelnetDecoder decoder;
+
+        QList<QByteArray> screens;
+        int nextScreen;
+
+        int delay;
+        qint64 bandwidth;
+        int recordSize;
+        bool offerTN3270E;
+
+        bool tn3270e;
+
+        // The framed screen being sent, and how much of it has gone
+        QByteArray pending;
+        qsizetype pendingSent;
+        QTimer pacer;
+
+        void processCommand(uchar command, uchar option);
+        void processSubNegotiation(const QByteArray &sb);
+        void processRecord(QByteArrayView record);
+
+        void sendRaw(const QByteArray &bytes);
+        void sendScreen();
+};
+
+#endif // STANDINHOST_H
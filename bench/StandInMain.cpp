@@ -0,0 +1,98 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include "StandInHost.h"
+
+/**
+ * @brief   main - run a stand-in host until interrupted
+ *
+ * @details Q3270 can be pointed at localhost and the chosen port to try it without a mainframe.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("A local TN3270(E) host that serves scripted screens");
+    parser.addHelpOption();
+    parser.addOption({ "port", "Listen on <port> (default 2323)", "port", "2323" });
+    parser.addOption({ "script", "Serve the screens in <file>; screens are separated by %% lines", "file" });
+    parser.addOption({ "recording", "Serve the inbound records of the wire trace <file>", "file" });
+    parser.addOption({ "delay", "Wait <ms> before replying to an AID", "ms", "0" });
+    parser.addOption({ "bandwidth", "Limit replies to <bytes> per second", "bytes", "0" });
+    parser.addOption({ "record-size", "Pad each screen to at least <bytes>", "bytes", "0" });
+    parser.addOption({ "no-tn3270e", "Refuse TN3270E and use TN3270 only" });
+
+    parser.process(a);
+
+    StandInHost host;
+
+    QString error;
+
+    if (parser.isSet("script"))
+    {
+        QList<QByteArray> screens = StandInHost::loadScript(parser.value("script"), error);
+
+        if (screens.isEmpty())
+        {
+            fprintf(stderr, "%s: %s\n", qPrintable(parser.value("script")), qPrintable(error.isEmpty() ? QString("no screens") : error));
+            return 1;
+        }
+
+        host.setScreens(screens);
+    }
+    else if (parser.isSet("recording"))
+    {
+        QList<QByteArray> screens = StandInHost::loadRecording(parser.value("recording"), error);
+
+        if (screens.isEmpty())
+        {
+            fprintf(stderr, "%s: %s\n", qPrintable(parser.value("recording")), qPrintable(error.isEmpty() ? QString("no records") : error));
+            return 1;
+        }
+
+        host.setScreens(screens);
+    }
+
+    host.setDelay(parser.value("delay").toInt());
+    host.setBandwidth(parser.value("bandwidth").toLongLong());
+    host.setRecordSize(parser.value("record-size").toInt());
+    host.setTN3270E(!parser.isSet("no-tn3270e"));
+
+    if (!host.listen(parser.value("port").toUShort()))
+    {
+        fprintf(stderr, "Cannot listen on port %s\n", qPrintable(parser.value("port")));
+        return 1;
+    }
+
+    QObject::connect(&host, &StandInHost::sessionStarted, [](bool tn3270e) {
+        printf("Session started (%s)\n", tn3270e ? "TN3270E" : "TN3270");
+        fflush(stdout);
+    });
+
+    QObject::connect(&host, &StandInHost::aidReceived, [](int aid, qint64) {
+        printf("AID 0x%02X\n", aid);
+        fflush(stdout);
+    });
+
+    QObject::connect(&host, &StandInHost::sessionEnded, []() {
+        printf("Session ended\n");
+        fflush(stdout);
+    });
+
+    printf("Listening on localhost:%d\n", host.serverPort());
+    fflush(stdout);
+
+    return a.exec();
+}
@@ -0,0 +1,253 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <QCoreApplication>
+#include <QBuffer>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <arpa/telnet.h>
+
+#include "Q3270.h"
+#include "TelnetDecoder.h"
+
+/**
+ * @brief   buildStream - build a synthetic inbound stream
+ * @param   records - the number of records
+ * @return  the stream, as it would arrive from the socket
+ *
+ * @details Each record is an Erase/Write of a full 27x132 (3279-5) screen: one SBA and SF per row
+ *          followed by the row text. A few 0xFF bytes are included in each record so that the IAC
+ *          doubling path is exercised.
+ */
+static QByteArray buildStream(int records)
+{
+    QByteArray stream;
+
+    for (int r = 0; r < records; r++)
+    {
+        stream.append((char) IBM3270_EW);
+        stream.append((char) 0xC3);
+
+        for (int row = 0; row < 27; row++)
+        {
+            int pos = row * 132;
+
+            stream.append((char) IBM3270_SBA);
+            stream.append((char) ((pos >> 8) & 0x3F));
+            stream.append((char) (pos & 0xFF));
+
+            // 0xFF in the data stream must be doubled
+            if ((pos & 0xFF) == 0xFF)
+            {
+                stream.append((char) IAC);
+            }
+
+            stream.append((char) IBM3270_SF);
+            stream.append((char) 0x60);
+
+            for (int col = 1; col < 132; col++)
+            {
+                stream.append((char) (0xC1 + (col + r) % 9));
+            }
+        }
+
+        stream.append((char) IAC);
+        stream.append((char) IAC);
+
+        stream.append((char) IAC);
+        stream.append((char) EOR);
+    }
+
+    return stream;
+}
+
+/**
+ * @brief   legacyDecode - the original SocketConnection::onReadyRead data path
+ * @param   device - the device to read from
+ * @return  the number of records found
+ *
+ * @details One byte is read per QDataStream transaction, with the same per-byte debug output as the
+ *          original loop. Only the data, IAC IAC and IAC EOR paths are reproduced, as those are the
+ *          only ones the synthetic stream uses.
+ */
+static int legacyDecode(QIODevice *device)
+{
+    QDataStream dataStream(device);
+    dataStream.setVersion(QDataStream::Qt_5_12);
+
+    Q3270::TelnetState telnetState = Q3270::TELNET_STATE_DATA;
+
+    QByteArray incomingData;
+    QString byteNotes;
+
+    char socketByte;
+    uchar unsignedSocketByte;
+
+    int records = 0;
+
+    for (;;)
+    {
+        dataStream.startTransaction();
+
+        dataStream.readRawData(&socketByte, 1);
+        unsignedSocketByte = (uchar) socketByte;
+
+        if (!dataStream.commitTransaction())
+        {
+            break;
+        }
+
+        qDebug();
+
+        switch (telnetState)
+        {
+            case Q3270::TELNET_STATE_DATA:
+                if (unsignedSocketByte == IAC)
+                {
+                    byteNotes.append("IAC ");
+                    telnetState = Q3270::TELNET_STATE_IAC;
+                }
+                else
+                {
+                    incomingData.append(unsignedSocketByte);
+                }
+                break;
+
+            case Q3270::TELNET_STATE_IAC:
+                switch (unsignedSocketByte)
+                {
+                    case IAC:
+                        incomingData.append(unsignedSocketByte);
+                        telnetState = Q3270::TELNET_STATE_DATA;
+                        byteNotes.append("Double 0xFF ");
+                        break;
+                    case EOR:
+                        byteNotes.append("EOR ");
+                        telnetState = Q3270::TELNET_STATE_DATA;
+                        qDebug() << byteNotes;
+                        byteNotes = "";
+                        records++;
+                        incomingData.clear();
+                        break;
+                    default:
+                        break;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return records;
+}
+
+/**
+ * @brief   blockDecode - the TelnetDecoder data path
+ * @param   device - the device to read from
+ * @return  the number of records found
+ *
+ * @details Reads the device in the same way as SocketConnection::onReadyRead, draining everything
+ *          available into a reusable buffer and passing it to the decoder.
+ */
+static int blockDecode(QIODevice *device)
+{
+    TelnetDecoder decoder;
+    QByteArray readBuffer;
+
+    int records = 0;
+    qint64 available;
+
+    while ((available = device->bytesAvailable()) > 0)
+    {
+        // Reads are limited to 64K, which is about what a socket will deliver in one go
+        available = qMin(available, (qint64) 65536);
+
+        readBuffer.resize(available);
+
+        qint64 bytesRead = device->read(readBuffer.data(), available);
+
+        decoder.feed(readBuffer.constData(), bytesRead);
+
+        TelnetDecoder::Event event;
+
+        while ((event = decoder.next()) != TelnetDecoder::NeedData)
+        {
+            if (event == TelnetDecoder::Record)
+            {
+                records++;
+            }
+        }
+    }
+
+#ifndef QT_NO_DEBUG
+    printf("Record arena: %llu allocations for %d records\n", (unsigned long long) decoder.recordAllocations(), records);
+#endif
+
+    return records;
+}
+
+/**
+ * @brief   discardMessages - message handler that throws debug output away
+ *
+ * @details The legacy loop is measured for its formatting cost rather than the speed of the console.
+ */
+static void discardMessages(QtMsgType, const QMessageLogContext &, const QString &)
+{
+}
+
+/**
+ * @brief   run - time a decoder over the stream
+ * @param   name   - the name to report
+ * @param   stream - the stream to decode
+ * @param   decode - the decoder
+ * @return  throughput in MB/s
+ */
+static double run(const char *name, const QByteArray &stream, int (*decode)(QIODevice *))
+{
+    QBuffer buffer;
+    buffer.setData(stream);
+    buffer.open(QIODevice::ReadOnly);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int records = decode(&buffer);
+
+    qint64 ns = timer.nsecsElapsed();
+
+    double mbs = (stream.size() / (1024.0 * 1024.0)) / (ns / 1e9);
+
+    printf("%-8s %8d records %10.3f ms %10.2f MB/s\n", name, records, ns / 1e6, mbs);
+
+    return mbs;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    int records = argc > 1 ? atoi(argv[1]) : 2000;
+
+    QByteArray stream = buildStream(records);
+
+    printf("Stream: %d records, %lld bytes\n", records, (long long) stream.size());
+
+    qInstallMessageHandler(discardMessages);
+
+    double legacy = run("legacy", stream, legacyDecode);
+    double block  = run("block", stream, blockDecode);
+
+    printf("Speedup: %.1fx\n", block / legacy);
+
+    return 0;
+}
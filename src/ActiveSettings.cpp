@@ -207,7 +207,8 @@ void ActiveSettings::setFont(const QFont &font)
  *          connection negotiation is to determine the screen size.
  *
  *          If one of the standard model types is used (2, 3, 4 or 5), the size is overridden and any
- *          size paramteres passed are ignored.
+ *          size paramteres passed are ignored. A dynamic size is kept between 24x80 and the largest screen
+ *          14 bit buffer addresses can reach.
  *
  *          This routine is called when the Preferences dialog's OK button is clicked.
  */
@@ -232,6 +233,8 @@ void ActiveSettings::setTerminal(int x, int y, int model)
             break;
 
         case Q3270_TERMINAL_DYNAMIC:
+            x = qBound(Q3270_PRIMARY_COLS, x, Q3270_MAX_CELLS / Q3270_PRIMARY_ROWS);
+            y = qBound(Q3270_PRIMARY_ROWS, y, Q3270_MAX_CELLS / x);
             break;
 
         default: // model 2 or unknown
@@ -271,17 +274,17 @@ void ActiveSettings::setTerminal(int x, int y, const QString &modelName)
     }
     if (modelName == "Model3")
     {
-        setTerminal(80, 32, Q3270_TERMINAL_MODEL2);
+        setTerminal(80, 32, Q3270_TERMINAL_MODEL3);
         return;
     }
     if (modelName == "Model4")
     {
-        setTerminal(80, 43, Q3270_TERMINAL_MODEL2);
+        setTerminal(80, 43, Q3270_TERMINAL_MODEL4);
         return;
     }
     if (modelName == "Model5")
     {
-        setTerminal(132, 27, Q3270_TERMINAL_MODEL2);
+        setTerminal(132, 27, Q3270_TERMINAL_MODEL5);
         return;
     }
 
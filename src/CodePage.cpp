@@ -86,6 +86,17 @@ void CodePage::setCodePage(QString codepage)
     }
 }
 
+/**
+ * @brief   CodePage::getCPGID - the number of the current codepage
+ * @return  the code page number - 37 for IBM-037 and so on
+ *
+ * @details Used to report the code page to the host in the Query Reply.
+ */
+int CodePage::getCPGID() const
+{
+    return cpList[currentCodePage].cpName.toInt();
+}
+
 /**
  * @brief   CodePage::getCodePageList - return a QStringList of the available codepages
  * @return  A list of the available code pages
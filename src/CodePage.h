@@ -33,6 +33,7 @@ public:
 
     void setCodePage(QString codepage);
     const QString getCodePage() const;
+    int getCPGID() const;
 
     const QStringList getCodePageList() const;
 
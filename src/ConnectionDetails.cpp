@@ -10,6 +10,8 @@
 
 #include <QDebug>
 
+#include <QFileDialog>
+#include <QMessageBox>
 #include <QSslCertificateExtension>
 
 #include "ConnectionDetails.h"
@@ -83,6 +85,10 @@ ConnectionDetails::ConnectionDetails(Terminal *terminal, ActiveSettings &activeS
         font.setBold(true);
     }
 
+    showLatency();
+
+    connect(ui->exportLatency, &QPushButton::clicked, this, &ConnectionDetails::exportLatency);
+
     ui->tabWidget->setCurrentIndex(0);
 }
 
@@ -214,3 +220,60 @@ void ConnectionDetails::itemClicked(QTableWidgetItem *item)
     }
 }
 
+
+/**
+ * @brief   ConnectionDetails::showLatency - fill in the response times table
+ *
+ * @details Each measure kept by the Terminal's LatencyStats is shown with its count and percentiles, in
+ *          milliseconds.
+ */
+void ConnectionDetails::showLatency()
+{
+    const LatencyStats &stats = terminal->latencyStats();
+
+    ui->latencyTable->setRowCount(0);
+
+    for (int m = 0; m < LatencyStats::MeasureCount; m++)
+    {
+        LatencyHistogram h = stats.histogram((LatencyStats::Measure) m);
+
+        int row = ui->latencyTable->rowCount();
+        ui->latencyTable->insertRow(row);
+
+        ui->latencyTable->setItem(row, 0, new QTableWidgetItem(LatencyStats::measureName((LatencyStats::Measure) m)));
+        ui->latencyTable->setItem(row, 1, new QTableWidgetItem(QString::number(h.count())));
+
+        const qint64 values[] = { h.percentile(0.5), h.percentile(0.9), h.percentile(0.99), h.max() };
+
+        for (int i = 0; i < 4; i++)
+        {
+            QString text = h.count() ? tr("%1 ms").arg(values[i] / 1e6, 0, 'f', 2) : QString("-");
+            QTableWidgetItem *item = new QTableWidgetItem(text);
+
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            ui->latencyTable->setItem(row, i + 2, item);
+        }
+    }
+
+    ui->latencyTable->resizeColumnsToContents();
+}
+
+/**
+ * @brief   ConnectionDetails::exportLatency - save the response times as CSV
+ *
+ * @details Writes the summary and the histogram buckets of each measure to a file chosen by the user.
+ */
+void ConnectionDetails::exportLatency()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Response Times"), "", tr("CSV files (*.csv)"));
+
+    if (fileName.isEmpty())
+    {
+        return;
+    }
+
+    if (!terminal->latencyStats().writeCsv(fileName))
+    {
+        QMessageBox::warning(this, tr("Export Response Times"), tr("Unable to write %1").arg(fileName));
+    }
+}
@@ -38,12 +38,14 @@ class ConnectionDetails : public QDialog
         QList<QSslCertificate> certs;
 
         void addRow(QString field, QStringList value);
+        void showLatency();
 
         QFont font;
 
     private slots:
         void showCertificate(int i);
         void itemClicked(QTableWidgetItem *t);
+        void exportLatency();
 };
 
 #endif // CONNECTIONDETAILS_H
@@ -0,0 +1,59 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <QStyleOptionGraphicsItem>
+
+#include "BlinkLayer.h"
+#include "DisplayScreen.h"
+
+/**
+ * @brief   BlinkLayer::BlinkLayer - the blinking characters of a screen
+ * @param   screen - the screen; it must also be made the parent item
+ *
+ * @details The layer starts empty.
+ */
+BlinkLayer::BlinkLayer(DisplayScreen *screen)
+    : screen(screen)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+/**
+ * @brief   BlinkLayer::setArea - set the area with blinking cells
+ * @param   area - the area, or an empty rectangle if nothing blinks
+ */
+void BlinkLayer::setArea(const QRectF &area)
+{
+    if (area == this->area)
+    {
+        return;
+    }
+
+    prepareGeometryChange();
+
+    this->area = area;
+}
+
+QRectF BlinkLayer::boundingRect() const
+{
+    return area;
+}
+
+/**
+ * @brief   BlinkLayer::paint - paint the blinking characters
+ * @param   p      - the painter
+ * @param   option - gives the area to be painted
+ *
+ * @details DisplayScreen paints the characters, as it does the rest of the screen.
+ */
+void BlinkLayer::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    screen->paintBlinking(p, option ? option->exposedRect & area : area);
+}
@@ -0,0 +1,47 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef BLINKLAYER_H
+#define BLINKLAYER_H
+
+#include <QGraphicsItem>
+
+class DisplayScreen;
+
+/**
+ * @brief   The BlinkLayer class
+ *
+ * @details BlinkLayer holds the characters of the blinking cells of a DisplayScreen, which paints those cells
+ *          without them. Blinking is then just showing and hiding the layer, whatever the number of cells that
+ *          blink.
+ *
+ *          The layer covers only the rows that have blinking cells, so that hiding it repaints no more of the
+ *          screen than it has to.
+ */
+class BlinkLayer : public QGraphicsItem
+{
+    public:
+
+        explicit BlinkLayer(DisplayScreen *screen);
+
+        void setArea(const QRectF &area);
+
+        QRectF boundingRect() const override;
+        void paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *) override;
+
+    private:
+
+        DisplayScreen *screen;
+
+        // The rows with blinking cells, in screen coordinates
+        QRectF area;
+};
+
+#endif // BLINKLAYER_H
@@ -12,11 +12,16 @@
 #include <QClipboard>
 #include <QGraphicsRectItem>
 #include <QRegion>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+#include <vector>
 
 #include <arpa/telnet.h>
 
 #include "Q3270.h"
 #include "DisplayScreen.h"
+#include "Trace.h"
 
 /**
  * @brief   DisplayScreen::DisplayScreen - the 3270 display matrix, representing primary or alternate screens.
@@ -39,12 +44,26 @@ DisplayScreen::DisplayScreen(int screen_x, int screen_y, CodePage &cp, const Col
     , palette(palette)
     , screen_x(screen_x)
     , screen_y(screen_y)
+    , glyphs(CELL_WIDTH, CELL_HEIGHT)
+    , blinkLayer(this)
 {
     this->setPos(0, 0);
 
     gridSize_X = CELL_WIDTH;
     gridSize_Y = CELL_HEIGHT;
 
+    painted = 0;
+    useGlyphs = true;
+    useBacking = false;
+    blinkCount = 0;
+
+    // Blinking characters are drawn above the screen, below the cursor
+    blinkLayer.setParentItem(this);
+    blinkLayer.setZValue(1);
+
+    // paint() is given the area to be painted, rather than the whole screen
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+
     setSize(screen_x, screen_y);
 
     // Default settings
@@ -57,6 +76,8 @@ DisplayScreen::DisplayScreen(int screen_x, int screen_y, CodePage &cp, const Col
 
     cursor_pos = 0;
 
+    latency = nullptr;
+
     // Rubberband; QRubberBand can't be used directly on QGraphicsItems
     QPen myRbPen = QPen();
     myRbPen.setWidth(0);
@@ -133,8 +154,21 @@ int DisplayScreen::height() const
     return screen_y;
 }
 
+/**
+ * @brief   DisplayScreen::codePage - return the code page used by the screen
+ * @return  the code page
+ *
+ * @details Used by the Read Partition (Query) structured field to report the code page to the host.
+ */
+const CodePage &DisplayScreen::codePage() const
+{
+    return cp;
+}
+
 void DisplayScreen::setSize(const int x, const int y)
 {
+    prepareGeometryChange();
+
     screen_x = x;
     screen_y = y;
 
@@ -144,11 +178,25 @@ void DisplayScreen::setSize(const int x, const int y)
     crosshair_X.setLine(0, 0, 0, screen_y * gridSize_Y);
     crosshair_Y.setLine(0, 0, screen_x * gridSize_X, 0);
 
-    // Build 3270 display matrix
+    // Build 3270 display matrix, and the copy of it that is painted
     cells.resize(screenPos_max);
+    front.resize(screenPos_max);
+    fields.resize(screenPos_max);
+    frontFields.resize(screenPos_max);
+    rows = QVector<RowLayout>(screen_y);
+
+    bool wasBlinking = isBlinking();
+
+    blinking.fill(0, (screenPos_max + 63) / 64);
+    blinkCount = 0;
+
+    updateBlinkLayer(wasBlinking);
 
     // Clear matrix and set initial attributes
     clear();
+
+    invalidateBacking();
+    update();
 }
 
 /**
@@ -176,6 +224,17 @@ void DisplayScreen::setFontTweak(const Q3270::FontTweak f)
     updateFontMetrics();
 }
 
+/**
+ * @brief   DisplayScreen::setGlyphCache - choose whether cells are painted from the glyph atlas
+ * @param   on - true to use the atlas where it can be, false to draw the cells as text
+ */
+void DisplayScreen::setGlyphCache(bool on)
+{
+    useGlyphs = on;
+    invalidateBacking();
+    update();
+}
+
 /**
  * @brief   DisplayScreen::updateFontMetrics - update the font metrics for zero overlays
  *
@@ -214,6 +273,15 @@ void DisplayScreen::updateFontMetrics()
 
     slashStart = QPoint(qRound(center.x() + dx), qRound(center.y() - dy));
     slashEnd   = QPoint(qRound(center.x() - dx), qRound(center.y() + dy));
+
+    // Every glyph has to be drawn again with the new font, and every row laid out again
+    glyphs.clear();
+
+    rawFont = QRawFont::fromFont(font);
+    baseline = (gridSize_Y - rawFont.ascent() - rawFont.descent()) / 2 + rawFont.ascent();
+
+    invalidateRows(0, screen_y);
+    invalidateBacking();
 }
 
 /**
@@ -224,6 +292,22 @@ void DisplayScreen::updateFontMetrics()
  */
 void DisplayScreen::resetColours()
 {
+    glyphs.clear();
+    invalidateBacking();
+    update();
+}
+
+/**
+ * @brief   DisplayScreen::codePageChanged - redraw the characters in a new code page
+ *
+ * @details Called when the user has changed the code page, which changes the character shown for each
+ *          EBCDIC code.
+ */
+void DisplayScreen::codePageChanged()
+{
+    glyphs.clear();
+    invalidateRows(0, screen_y);
+    invalidateBacking();
     update();
 }
 
@@ -238,14 +322,13 @@ void DisplayScreen::resetColours()
  */
 void DisplayScreen::clear()
 {
-    for(int i = 0; i < screenPos_max; i++)
-        cells[i].reset();
+    cells.resetAll();
 
     resetCharAttr();
 
     geActive = false;
     unformatted = true;
-    fieldCount = 0;
+    fields.clear();
 
     setCursor(0);
 }
@@ -261,111 +344,415 @@ void DisplayScreen::clear()
  *          any field start is removed (this can only happen from the datastream, because field starts
  *          are protected by nature). Any character attributes previously present in the cell are removed.
  *          
- *          The field containing the character is used to determine the colour of the character, unless
- *          character attributes are in effect.
+ *          A character takes its colour and highlighting from its field when it is painted, unless character
+ *          attributes are in effect; see applyCharAttributes().
  */
 void DisplayScreen::setChar(int pos, uchar c, bool fromKB)
 {
+    // If we're overlaying a Field Start, the cells that were in its field now belong to the field before
+    // it, which the field directory gives without any of them being touched.
+    if (cells.isFieldStart(pos))
+    {
+        cells.setFieldStart(pos, false);
 
-    Cell &thisCell = cells[pos];
+        fields.remove(pos);
+        unformatted = fields.isEmpty();
+    }
+
+    applyCharAttributes(pos);
+
+    // Choose a graphic character if needed
+    cells.setGraphic(pos, geActive);
 
-    // If we're overlaying a Field Start, the subsequent positions on the screen now have a different
-    // field start, so update them accordingly.
-    if (thisCell.isFieldStart())
+    if (!fromKB)
+    {
+        cells.setChar(pos, c);
+    }
+    else
     {
-        thisCell.setFieldStart(false);
+        cells.setChar(pos, cp.getEBCDIC(c));
+    }
+
+    geActive = false;
+}
+
+/**
+ * @brief   DisplayScreen::setChars - place a run of characters from the data stream on the screen
+ * @param   pos  - the cell in which to place the first character
+ * @param   text - the EBCDIC characters
+ * @param   len  - the number of characters
+ *
+ * @details The result is the same as calling setChar() for each character in turn, wrapping from the end
+ *          of the screen to the start; see writeCells().
+ */
+void DisplayScreen::setChars(int pos, const uchar *text, int len)
+{
+    writeCells(pos, text, len, false, false);
+}
+
+/**
+ * @brief   DisplayScreen::fillChars - fill a range of the screen with one character
+ * @param   start   - the first cell
+ * @param   end     - the cell after the last one; if it is the same as start, the whole screen is filled
+ * @param   c       - the EBCDIC character
+ * @param   graphic - true if the character is a graphic escape character
+ *
+ * @details fillChars is used for the RA (Repeat to Address) order. The range wraps from the end of the screen
+ *          to the start. The result is the same as a setChar() for each cell, preceded by setGraphicEscape()
+ *          if graphic is set.
+ */
+void DisplayScreen::fillChars(int start, int end, uchar c, bool graphic)
+{
+    int len = end > start ? end - start : end - start + screenPos_max;
+
+    writeCells(start, &c, len, true, graphic);
+}
 
-        if (--fieldCount == 0)
-            unformatted = true;
+/**
+ * @brief   DisplayScreen::writeCells - place characters on the screen from the data stream
+ * @param   pos     - the cell in which to place the first character
+ * @param   text    - the EBCDIC characters
+ * @param   len     - the number of cells to write
+ * @param   repeat  - true to write text[0] to every cell
+ * @param   graphic - true if every character is a graphic escape character
+ *
+ * @details Each cell ends up as setChar() would leave it. A cell that holds a field start is overwritten with
+ *          setChar(), which removes the field.
+ *
+ *          With no character attributes in effect, the cells up to the next field start, or the end of the
+ *          screen, are filled as a block: the characters are copied and the attributes set in one pass each,
+ *          and the blocks they are in are marked changed once. Otherwise, and for a cell after a graphic escape
+ *          that does not apply to the rest, each cell is written in turn.
+ */
+void DisplayScreen::writeCells(int pos, const uchar *text, int len, bool repeat, bool graphic)
+{
+    bool plain = charAttr.colour_default && charAttr.highlight_default;
+
+    int i = 0;
 
-        Cell *lastField = nullptr;
+    while (i < len)
+    {
+        uchar c = text[repeat ? 0 : i];
 
-        if (!unformatted)
+        // Field starts take the full path
+        if (cells.isFieldStart(pos))
         {
-            // If this is the first position on the screen, we need the last screen position's field
-            lastField = cells[pos == 0 ? screenPos_max - 1 : pos - 1].getField();
+            geActive = geActive || graphic;
+            setChar(pos, c, false);
         }
+        else if (!plain || (geActive && !graphic))
+        {
+            applyCharAttributes(pos);
 
-        int tmpPos = pos;
+            cells.setGraphic(pos, geActive || graphic);
+            cells.setChar(pos, c);
 
-        while(!cells[tmpPos % screenPos_max].isFieldStart() && tmpPos < pos + screenPos_max)
+            geActive = false;
+        }
+        else
         {
-            int i1 = tmpPos++ % screenPos_max;
-//          qDebug() << "Field at" << pos << "(" << &cells[pos] << ")" << "was FieldStart. Updating" << i1 << "as" << lastField;
-            cells[i1].setField(lastField);
+            // The run stops at the next field start, or the end of the screen
+            int next = fields.next(pos);
+            int run = qMin(len - i, screenPos_max - pos);
+
+            if (next > pos)
+            {
+                run = qMin(run, next - pos);
+            }
+
+            int field = fields.fieldOf(pos);
+
+            if (repeat)
+            {
+                cells.fillChars(pos, run, c);
+            }
+            else
+            {
+                cells.copyChars(pos, run, text + i);
+            }
+
+            cells.setPlainAttrs(pos, run, graphic,
+                                field >= 0 ? cells.getColour(field) : Q3270::UnprotectedNormal,
+                                field >= 0 ? cells.getHighlight(field) : Q3270::NoHighlight);
+
+            geActive = false;
+
+            i += run;
+            pos = (pos + run) % screenPos_max;
+
+            continue;
         }
+
+        i++;
+        pos = pos + 1 < screenPos_max ? pos + 1 : 0;
     }
+}
 
-    Cell *fieldAttr = thisCell.getField();
+/**
+ * @brief   DisplayScreen::updateRange - schedule a repaint of a range of cells
+ * @param   start - the first cell
+ * @param   len   - the number of cells, which may wrap to the start of the screen
+ *
+ * @details A range within a row is repainted on its own; a longer one repaints the rows holding it with a
+ *          single update, and one that wraps repaints the whole screen. The rows are laid out again when they
+ *          are next painted as text, and the cells are drawn again in the backing image when it is next painted.
+ */
+void DisplayScreen::updateRange(int start, int len)
+{
+    if (len <= 0)
+    {
+        return;
+    }
 
-    // If the field attribute is not set, use the current position
-    if (fieldAttr == nullptr)
-        fieldAttr = &cells[pos];
+    if (start + len > screenPos_max)
+    {
+        invalidateRows(0, screen_y);
+        invalidateBacking();
+        update();
+        return;
+    }
 
-    // Set character attribute flags if applicable
-    if (useCharAttr)
-       applyCharAttributes(pos, fieldAttr);
+    int firstRow = start / screen_x;
+    int lastRow = (start + len - 1) / screen_x;
 
-    // Choose a graphic character if needed
-    thisCell.setGraphic(geActive);
+    invalidateRows(firstRow, lastRow + 1);
 
-    if (!fromKB)
+    if (firstRow == lastRow)
     {
-        thisCell.setChar(c);
+        if (useBacking)
+        {
+            backingStale += QRect(start % screen_x, firstRow, len, 1);
+        }
+
+        update(QRectF((start % screen_x) * gridSize_X, firstRow * gridSize_Y, len * gridSize_X, gridSize_Y));
+        return;
     }
-    else
+
+    if (useBacking)
     {
-        thisCell.setChar(cp.getEBCDIC(c));
+        backingStale += QRect(0, firstRow, screen_x, lastRow - firstRow + 1);
     }
 
-    geActive = false;
+    update(QRectF(0, firstRow * gridSize_Y, screen_x * gridSize_X, (lastRow - firstRow + 1) * gridSize_Y));
+}
 
-    // Unformatted screen - use character attributes if present, otherwise default colours and no highlighting
-    if (unformatted)
+/**
+ * @brief   DisplayScreen::endWrite - finish a write from the host
+ *
+ * @details Publishes the screen. Called at the end of every record from the host.
+ *
+ *          On the screen that is shown, the record now waits for the paint, for the latency measurements. The
+ *          model a SessionWorker keeps has none; its records wait for the snapshot to be applied.
+ */
+void DisplayScreen::endWrite()
+{
+    publish();
+
+    if (latency)
     {
-        if (thisCell.hasCharAttrs(Q3270::ColourAttr) && !charAttr.colour_default)
-             thisCell.setColour(charAttr.colNum);
-        else
-             thisCell.setColour(Q3270::UnprotectedNormal);
+        latency->published(LatencyStats::now());
+    }
+}
 
-         if (thisCell.hasCharAttrs(Q3270::CharAttr::ExtendedAttr))
-             thisCell.setHighlight(charAttr.highlight_default ? Q3270::NoHighlight : charAttr.highlight);
-         else
-             thisCell.setHighlight(Q3270::NoHighlight);
+/**
+ * @brief   DisplayScreen::publish - make what has been written the screen that is painted
+ *
+ * @details The host and the keyboard write to cells, the back buffer, and to fields; paint() only reads front
+ *          and frontFields. Publishing swaps the two buffers and copies the field directory, which is what
+ *          makes a whole record appear at once, and then brings the new back buffer up to date by copying the
+ *          blocks that changed. The directory's lists are shared until the next write changes them. The cost is in proportion to what changed,
+ *          not to the size of the screen, and only the cells that look different are repainted.
+ *
+ *          A write from the host is published when it ends, by endWrite(). Keyboard edits are published as they
+ *          are made.
+ *
+ *          Published blocks are remembered until the next takeSnapshot(), which sends them to another
+ *          DisplayScreen.
+ */
+void DisplayScreen::publish()
+{
+    if (!cells.isChanged())
+    {
+        return;
     }
-    else
+
+    std::swap(cells, front);
+    frontFields = fields;
+
+    // Until it is brought up to date, cells holds what was painted before
+    updateChanged(front.changedBlocks());
+
+    cells.clearChanges();
+    cells.copyBlocks(front, front.changedBlocks());
+
+    PresentationSpace::mergeBlocks(unsent, front.changedBlocks());
+}
+
+/**
+ * @brief   DisplayScreen::updateChanged - schedule a repaint of the cells that publishing changed
+ * @param   blocks - the blocks published
+ *
+ * @details Called by publish() while cells still holds the screen that was painted before. The cells in the
+ *          blocks are compared with it, and each run of cells that now looks different is repainted. A cell
+ *          that became or stopped being a field start, or a field start whose attributes changed, changes how
+ *          every cell up to the next field start is shown, so the run is taken that far.
+ *
+ *          The blinking cells in each run are found again at the same time.
+ */
+void DisplayScreen::updateChanged(const QVector<quint64> &blocks)
+{
+    // The run of cells to be repainted; it may go past the end of the screen, wrapping to the start
+    int runStart = -1;
+    int runEnd = -1;
+
+    bool wasBlinking = isBlinking();
+    bool blinkChanged = false;
+
+    auto flushRun = [&]() {
+        updateRange(runStart, runEnd - runStart);
+        blinkChanged |= updateBlink(runStart, runEnd - runStart);
+    };
+
+    for (int w = 0; w < blocks.size(); w++)
     {
-        // Colour
-        if (thisCell.hasCharAttrs(Q3270::CharAttr::ColourAttr) && !charAttr.colour_default)
-            thisCell.setColour(charAttr.colNum);
-        else
-            thisCell.setColour(fieldAttr->getColour());
+        for (quint64 bits = blocks[w]; bits; bits &= bits - 1)
+        {
+            int first = ((w << 6) + qCountTrailingZeroBits(bits)) * PresentationSpace::BlockSize;
+            int last = qMin(first + PresentationSpace::BlockSize, screenPos_max);
 
-        // Extended attributes
-        if (thisCell.hasCharAttrs(Q3270::CharAttr::ExtendedAttr))
-            thisCell.setHighlight(charAttr.highlight_default ? fieldAttr->getHighlight() : charAttr.highlight);
-        else
-            thisCell.setHighlight(fieldAttr->getHighlight());
+            for (int pos = first; pos < last; pos++)
+            {
+                if (front.looksSame(pos, cells))
+                {
+                    continue;
+                }
+
+                int end = pos + 1;
+
+                if (front.isFieldStart(pos) || cells.isFieldStart(pos))
+                {
+                    int next = frontFields.next(pos);
+
+                    // With no field start left, every cell goes back to the defaults
+                    end = next < 0 ? pos + screenPos_max : (next > pos ? next : next + screenPos_max);
+                }
+
+                if (runStart >= 0 && pos <= runEnd)
+                {
+                    runEnd = qMax(runEnd, end);
+                }
+                else
+                {
+                    flushRun();
+
+                    runStart = pos;
+                    runEnd = end;
+                }
+            }
+        }
     }
 
-    // Maintain blink cells rectangles for blink()
-    int row = pos / screen_x;
-    int col = pos % screen_x;
+    flushRun();
 
-    QRect cellRect(col * gridSize_X, row * gridSize_Y, gridSize_X, gridSize_Y);
+    if (blinkChanged)
+    {
+        updateBlinkLayer(wasBlinking);
+    }
+}
 
-    if (thisCell.isBlink())
+/**
+ * @brief   DisplayScreen::updateBlink - find the blinking characters in a range of cells
+ * @param   start - the first cell
+ * @param   len   - the number of cells, which may wrap to the start of the screen
+ * @return  true if any cell started or stopped blinking
+ *
+ * @details A cell blinks if it shows a character, and it has blink highlighting or is in a field that has.
+ *          Called by updateChanged() with front as just published.
+ */
+bool DisplayScreen::updateBlink(int start, int len)
+{
+    if (len <= 0)
     {
-        blinkCells += cellRect;
+        return false;
+    }
+
+    len = qMin(len, screenPos_max);
+
+    bool changed = false;
+
+    int field = frontFields.fieldOf(start);
+    int pos = start;
+
+    for (int i = 0; i < len; i++, pos = pos + 1 < screenPos_max ? pos + 1 : 0)
+    {
+        bool fieldStart = front.isFieldStart(pos);
+
+        if (fieldStart)
+        {
+            field = pos;
+        }
+
+        bool on = !fieldStart && front.getEBCDIC(pos) != IBM3270_CHAR_NULL && (field < 0 || front.isDisplay(field))
+                  && front.getHighlight(pos, field) == Q3270::Blink;
+
+        quint64 bit = Q_UINT64_C(1) << (pos & 63);
+
+        if (on != bool(blinking[pos >> 6] & bit))
+        {
+            blinking[pos >> 6] ^= bit;
+            blinkCount += on ? 1 : -1;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+/**
+ * @brief   DisplayScreen::updateBlinkLayer - fit the blink layer to the blinking cells
+ * @param   wasBlinking - whether anything blinked before the change
+ *
+ * @details The layer is set to cover the rows from the first blinking cell to the last. When the screen
+ *          starts or stops blinking, the characters are shown and blinkingChanged() is emitted, so that
+ *          Terminal only runs its blink timer while there is something to blink.
+ */
+void DisplayScreen::updateBlinkLayer(bool wasBlinking)
+{
+    int first = -1;
+    int last = -1;
+
+    for (int w = 0; w < blinking.size(); w++)
+    {
+        if (blinking[w])
+        {
+            if (first < 0)
+            {
+                first = (w << 6) + qCountTrailingZeroBits(blinking[w]);
+            }
+
+            last = (w << 6) + 63 - qCountLeadingZeroBits(blinking[w]);
+        }
+    }
+
+    if (first < 0)
+    {
+        blinkLayer.setArea(QRectF());
     }
     else
     {
-        blinkCells -= cellRect;
+        int firstRow = first / screen_x;
+        int lastRow = last / screen_x;
+
+        blinkLayer.setArea(QRectF(0, firstRow * gridSize_Y, screen_x * gridSize_X, (lastRow - firstRow + 1) * gridSize_Y));
     }
 
-    // If character colour attributes are present, use them instead
-//    if (cells[pos].hasCharAttrs(Q3270::ColourAttr) || cells[pos].hasCharAttrs(Q3270::ExtendedAttr))
-//        applyCharAttrsOverrides(pos, fieldAttr);
+    if (isBlinking() != wasBlinking)
+    {
+        blinkShow = true;
+        blinkLayer.show();
+
+        emit blinkingChanged(isBlinking());
+    }
 }
 
 /**
@@ -419,7 +806,7 @@ void DisplayScreen::setCharAttr(unsigned char extendedType, unsigned char extend
 //                    printf("uscore");
                     break;
                 default:
-                    printf("** Extended Value %02X Not Implemented **", extendedValue);
+                    TRACE_WARN(datastream) << "Extended highlight value" << Qt::hex << (int) extendedValue << "not implemented";
             }
             break;
         case IBM3270_EXT_FG_COLOUR:
@@ -430,7 +817,6 @@ void DisplayScreen::setCharAttr(unsigned char extendedType, unsigned char extend
             }
             else
             {
-                charAttr.colour = palette->colour(Q3270::Colour(extendedValue&7));
                 charAttr.colNum = (Q3270::Colour)(extendedValue&7);
                 charAttr.colour_default = false;
 //                printf("fg colour %s (extendedValue %02X)", colName[charAttr.colNum], extendedValue);
@@ -444,14 +830,13 @@ void DisplayScreen::setCharAttr(unsigned char extendedType, unsigned char extend
             }
             else
             {
-                charAttr.colour = palette->colour(Q3270::Colour(extendedValue&7));
                 charAttr.colNum = (Q3270::Colour)(extendedValue&7);
                 charAttr.colour_default = false;
 //                printf("bg colour %s", colName[charAttr.colNum]);
             }
             break;
         default:
-            printf(" ** Extended Type %02X Not implemented **", extendedType);
+            TRACE_WARN(datastream) << "Extended type" << Qt::hex << (int) extendedType << "not implemented";
     }
 //    printf("]");
 //    fflush(stdout);
@@ -506,9 +891,8 @@ void DisplayScreen::setGraphicEscape()
  *            6 | Reserved. Must be 0.
  *            7 | MDT flag. Set when a field is modified
  *
- *          setField characters are always displayed as nulls. When a Start Field (or SFE) is
- *          encountered, the characters following the field are modified to reflect the field
- *          attribute via the cascadeAttrs function.
+ *          setField characters are always displayed as nulls. The field is recorded in the field
+ *          directory, through which the cells following it find their field attributes.
  */
 void DisplayScreen::setField(int pos, unsigned char c, bool sfe)
 {
@@ -520,27 +904,25 @@ void DisplayScreen::setField(int pos, unsigned char c, bool sfe)
     bool intens = ((c >> 2) & 3) == 2;
     bool mdt    = c & 1;
 
-    cells[pos].setProtected(prot);
-    cells[pos].setNumeric(num);
-    cells[pos].setDisplay(disp);
-    cells[pos].setPenSelect(pensel);
-    cells[pos].setIntensify(intens);
-    cells[pos].setMDT(mdt);
+    cells.setProtected(pos, prot);
+    cells.setNumeric(pos, num);
+    cells.setDisplay(pos, disp);
+    cells.setPenSelect(pos, pensel);
+    cells.setIntensify(pos, intens);
+    cells.setMDT(pos, mdt);
 
-    cells[pos].setExtended(sfe);
+    cells.setExtended(pos, sfe);
 
     // Keep track of fields
-    if(!cells[pos].isFieldStart())
+    if(!cells.isFieldStart(pos))
     {
-        cells[pos].setFieldStart(true);
-        fieldCount++;
-//        qDebug() << "Field count now" << fieldCount;
+        cells.setFieldStart(pos, true);
     }
 
-    // Fields are set to 0x00
-    cells[pos].setChar(IBM3270_CHAR_NULL);
+    fields.add(pos, !prot);
 
-    cascadeAttrs(pos);
+    // Fields are set to 0x00
+    cells.setChar(pos, IBM3270_CHAR_NULL);
 
     // At least one field is defined
     unformatted = false;
@@ -550,19 +932,26 @@ void DisplayScreen::setField(int pos, unsigned char c, bool sfe)
  * @brief   DisplayScreen::cascadeAttrs - cascade a field attribute to the cells in the field
  * @param   pos - the position of the field
  *
- * @details When a field is set on the display, all the character cells following it inherit the field
- *          attributes. This routine copies the field attributes to the cells in the field until the next
- *          field start.
+ * @details When a field's attributes are modified, all the character cells following it take on the new
+ *          attributes. The cells look their field up in the field directory, so only the directory's record
+ *          of whether the field is protected needs to follow the change.
  */
 void DisplayScreen::cascadeAttrs(int pos)
 {
-    int endPos = pos + screenPos_max;
+    fields.setUnprotected(pos, !cells.isProtected(pos));
+}
+
+/**
+ * @brief   DisplayScreen::setFieldMDT - mark the field containing a cell as modified
+ * @param   pos - screen position
+ */
+void DisplayScreen::setFieldMDT(int pos)
+{
+    int field = fields.fieldOf(pos);
 
-    int i = pos + 1;
-    while(i < endPos && !(cells[i % screenPos_max].isFieldStart()))
+    if (field >= 0)
     {
-        int offset = i++ % screenPos_max;
-        cells[offset].setField(&cells[pos]);
+        cells.setMDT(field, true);
     }
 }
 
@@ -578,13 +967,13 @@ void DisplayScreen::resetExtended(int pos)
 {
     resetExtendedHilite(pos);
 
-    cells[pos].setColour(Q3270::UnprotectedNormal);
+    cells.setColour(pos, Q3270::UnprotectedNormal);
 
-    cells[pos].setDisplay(true);
-    cells[pos].setNumeric(false);
-    cells[pos].setMDT(false);
-    cells[pos].setPenSelect(false);
-    cells[pos].setProtected(false);
+    cells.setDisplay(pos, true);
+    cells.setNumeric(pos, false);
+    cells.setMDT(pos, false);
+    cells.setPenSelect(pos, false);
+    cells.setProtected(pos, false);
 }
 
 /**
@@ -596,7 +985,7 @@ void DisplayScreen::resetExtended(int pos)
  */
 void DisplayScreen::resetExtendedHilite(int pos)
 {
-    cells[pos].setHighlight(Q3270::NoHighlight);
+    cells.setHighlight(pos, Q3270::NoHighlight);
 }
 
 /**
@@ -616,7 +1005,7 @@ void DisplayScreen::setExtendedColour(int pos, bool foreground, unsigned char c)
         return;
         c = IBM3270_EXT_DEFAULT_COLOR;
     }
-    cells[pos].setColour((Q3270::Colour)(c&7));
+    cells.setColour(pos, (Q3270::Colour)(c&7));
 }
 
 /**
@@ -627,7 +1016,7 @@ void DisplayScreen::setExtendedColour(int pos, bool foreground, unsigned char c)
  */
 void DisplayScreen::setExtendedBlink(int pos)
 {
-    cells[pos].setHighlight(Q3270::Blink);
+    cells.setHighlight(pos, Q3270::Blink);
 }
 
 /**
@@ -638,7 +1027,7 @@ void DisplayScreen::setExtendedBlink(int pos)
  */
 void DisplayScreen::setExtendedReverse(int pos)
 {
-    cells[pos].setHighlight(Q3270::Reverse);
+    cells.setHighlight(pos, Q3270::Reverse);
 }
 
 /**
@@ -649,25 +1038,19 @@ void DisplayScreen::setExtendedReverse(int pos)
  */
 void DisplayScreen::setExtendedUscore(int pos)
 {
-    cells[pos].setHighlight(Q3270::Underscore);
+    cells.setHighlight(pos, Q3270::Underscore);
 }
 
 /**
  * @brief   DisplayScreen::resetMDTs - reset all the MDTs on the screen
  *
- * @details Reset all MDTs in the display; it's probably faster to just loop through the entire buffer
- *          rather than calling findNextField()
+ * @details Reset all MDTs in the display; only the field starts in the field directory are visited.
  */
 void DisplayScreen::resetMDTs()
 {
-    for (int i = 0; i < screenPos_max; i++)
+    for (int pos : fields.positions())
     {
-        if (cells[i].isFieldStart() && cells[i].isMdtOn())
-        {
-  /*        qDebug() << "Resetting MDT at" << i;*/
-            cells[i].setMDT(false);
-        }
-
+        cells.setMDT(pos, false);
     }
 }
 
@@ -686,10 +1069,9 @@ void DisplayScreen::resetMDTs()
  */
 bool DisplayScreen::insertChar(unsigned char c, bool insertMode)
 {
-    if (cells[cursor_pos].isProtected() || cells[cursor_pos].isFieldStart())
+    if (isProtected(cursor_pos) || cells.isFieldStart(cursor_pos))
     {
-        printf("Protected!\n");
-        fflush(stdout);
+        TRACE(keyboard) << "Protected at" << cursor_pos;
         return false;
     }
 
@@ -720,20 +1102,21 @@ bool DisplayScreen::insertChar(unsigned char c, bool insertMode)
          **/
         int nextField = findNextField(cursor_pos);
 //        printf("This Field at: %d,%d, next field at %d,%d - last byte of this field %02X\n", (int)(thisField/screen_x), (int)(thisField-((int)(thisField/screen_x)*screen_x)), (int)(nextField/screen_x), (int)(nextField-((int)(nextField/screen_x)*screen_x)), cell.at(nextField - 1)->getEBCDIC() );
-        uchar lastChar = cells[nextField - 1].getEBCDIC();
+        uchar lastChar = cells.getEBCDIC(nextField - 1);
         if (lastChar != IBM3270_CHAR_NULL && lastChar != IBM3270_CHAR_SPACE)
         {
             // Insert not okay
         }
+        // Every cell up to the next field start is in the cursor's (unprotected) field
         int endPos = -1;
         for(int i = cursor_pos; i < (cursor_pos + screenPos_max); i++)
         {
             int offset = i % screenPos_max;
-            if (cells[offset].isProtected() || cells[offset].isFieldStart())
+            if (cells.isFieldStart(offset))
             {
                 break;
             }
-            if (cells[offset].getEBCDIC() == IBM3270_CHAR_NULL)
+            if (cells.getEBCDIC(offset) == IBM3270_CHAR_NULL)
             {
                 endPos = i;
                 break;
@@ -741,8 +1124,7 @@ bool DisplayScreen::insertChar(unsigned char c, bool insertMode)
         }
         if (endPos == -1)
         {
-            printf("Overflow!\n");
-            fflush(stdout);
+            TRACE(keyboard) << "Field overflow at" << cursor_pos;
             return false;
         }
 
@@ -751,15 +1133,15 @@ bool DisplayScreen::insertChar(unsigned char c, bool insertMode)
             int offset = fld % screenPos_max;
             int offsetPrev = (fld - 1) % screenPos_max;
 
-            cells[offset].copy(cells[offsetPrev]);
+            cells.copy(offset, offsetPrev);
         }
     }
 
-    cells[cursor_pos].setMDT(true);
+    setFieldMDT(cursor_pos);
 
     setChar(cursor_pos, c, true);
 
-//    cells[cursor_pos].updateCell();
+//    cells.updateCell(cursor_pos);
 
     setCursor((cursor_pos + 1) % screenPos_max);
 
@@ -768,7 +1150,7 @@ bool DisplayScreen::insertChar(unsigned char c, bool insertMode)
         tab(0);
     }
 
-    update();
+    publish();
 
     return true;
 }
@@ -783,7 +1165,9 @@ bool DisplayScreen::insertChar(unsigned char c, bool insertMode)
  */
 bool DisplayScreen::isAskip(int pos) const
 {
-    return cells[pos].isAutoSkip();
+    int field = fields.fieldOf(pos);
+
+    return field >= 0 && cells.isAutoSkip(field);
 }
 
 /**
@@ -791,11 +1175,14 @@ bool DisplayScreen::isAskip(int pos) const
  * @param   pos - screen position
  * @return  true if protected, false otherwise
  *
- * @details isProtected returns true if the Cell is protected.
+ * @details isProtected returns true if the Cell is in a protected field. Cells on an unformatted screen
+ *          are unprotected.
  */
 bool DisplayScreen::isProtected(int pos) const
 {
-    return cells[pos].isProtected();
+    int field = fields.fieldOf(pos);
+
+    return field >= 0 && cells.isProtected(field);
 }
 
 /**
@@ -807,7 +1194,7 @@ bool DisplayScreen::isProtected(int pos) const
  */
 bool DisplayScreen::isFieldStart(int pos) const
 {
-    return cells[pos].isFieldStart();
+    return cells.isFieldStart(pos);
 }
 
 /**
@@ -820,10 +1207,9 @@ bool DisplayScreen::isFieldStart(int pos) const
  */
 void DisplayScreen::deleteChar()
 {
-    if (cells[cursor_pos].isProtected())
+    if (isProtected(cursor_pos))
     {
-        printf("Protected!\n");
-        fflush(stdout);
+        TRACE(keyboard) << "Protected at" << cursor_pos;
         return;
     }
 
@@ -834,18 +1220,18 @@ void DisplayScreen::deleteChar()
         endPos += screenPos_max;
     }
 
-    for(int fld = cursor_pos; fld < endPos - 1 && cells[fld % screenPos_max].getEBCDIC() != IBM3270_CHAR_NULL; fld++)
+    for(int fld = cursor_pos; fld < endPos - 1 && cells.getEBCDIC(fld % screenPos_max) != IBM3270_CHAR_NULL; fld++)
     {        
         int offset = fld % screenPos_max;
         int offsetNext = (fld + 1) % screenPos_max;
 
-        cells[offset].copy(cells[offsetNext]);
+        cells.copy(offset, offsetNext);
     }
 
-    cells[(endPos - 1) % screenPos_max].setChar(IBM3270_CHAR_NULL);
-    cells[cursor_pos].setMDT(true);
+    cells.setChar((endPos - 1) % screenPos_max, IBM3270_CHAR_NULL);
+    setFieldMDT(cursor_pos);
 
-    update();
+    publish();
 }
 
 /**
@@ -867,50 +1253,75 @@ void DisplayScreen::eraseEOF()
     /* Blank field */
     for(int i = cursor_pos; i < nextField; i++)
     {
-        cells[i % screenPos_max].setChar(0x00);
+        cells.setChar(i % screenPos_max, 0x00);
     }
 
-    cells[cursor_pos].setMDT(true);
+    setFieldMDT(cursor_pos);
 
-    update();
+    publish();
 }
 
 
 /**
  * @brief   DisplayScreen::eraseUnprotected - erase unprotected fields between addresses
- * @param   start - screen position
- * @param   end   - screen position
+ * @param   start    - screen position
+ * @param   end      - screen position after the last one to erase; if it is the same as start, the whole
+ *                     screen is erased
+ * @param   resetMDT - whether to reset the MDT of the unprotected fields
+ *
+ * @details eraseUnprotected is called when the EUA (Erase Unprotected to Address) order or the EAU (Erase All
+ *          Unprotected) command is encountered in the 3270 data stream. All unprotected character positions
+ *          between the specified positions are set to nulls. The range wraps from the end of the screen to
+ *          the start.
  *
- * @details eraseUnprotected is called when the EUA (Erase Unprotected to Address) order is encountered
- *          in the 3270 data stream. All unprotected fields between the specified positions are
- *          set to nulls.
+ *          The range is walked once, a field at a time: a field start sets whether the cells after it are
+ *          erased, and the cells of an unprotected field up to the next field start, or the end of the screen,
+ *          are filled with nulls as a block.
  */
 void DisplayScreen::eraseUnprotected(int start, int end, Q3270::EraseResetMDT resetMDT)
 {
-    if (end < start)
-    {
-        end += screenPos_max;
-    }
+    int len = end > start ? end - start : end - start + screenPos_max;
 
-    if (cells[start].isProtected())
-    {
-        start = findNextUnprotectedField(start);
-    }
+    len = qMin(len, screenPos_max);
+
+    // Whether the field the range starts in is protected; an unformatted screen has no protected cells
+    bool prot = isProtected(start);
 
-    for(int i = start; i < end; i++)
+    int pos = start;
+
+    while (len > 0)
     {
-        if(cells[i].isProtected() || cells[i].isFieldStart())
+        if (cells.isFieldStart(pos))
         {
-            if (!cells[i].isProtected() && resetMDT == Q3270::EraseResetMDT::ResetMDT)
+            prot = cells.isProtected(pos);
+
+            if (!prot && resetMDT == Q3270::EraseResetMDT::ResetMDT)
             {
-                cells[i].setMDT(false);
+                cells.setMDT(pos, false);
             }
-            i = findNextUnprotectedField(i);
+
+            len--;
+            pos = pos + 1 < screenPos_max ? pos + 1 : 0;
+
+            continue;
         }
-        else
+
+        // The cells up to the next field start, the end of the range or the end of the screen
+        int next = fields.next(pos);
+        int run = qMin(len, screenPos_max - pos);
+
+        if (next > pos)
+        {
+            run = qMin(run, next - pos);
+        }
+
+        if (!prot)
         {
-            cells[i].setChar(IBM3270_CHAR_NULL);
+            cells.fillChars(pos, run, IBM3270_CHAR_NULL);
         }
+
+        len -= run;
+        pos = (pos + run) % screenPos_max;
     }
 }
 
@@ -948,38 +1359,32 @@ void DisplayScreen::processAID(int aid, bool allowShortRead)
     {
         setCursor(0);
         clear();
+        publish();
     }
 
     emit bufferReady(respBuffer);
 }
 
 /**
- * @brief   ProcessDataStream::interruptProcess - interrupt the current process
+ * @brief   DisplayScreen::interruptProcess - interrupt the current process
  *
- * @details This is processing for ATTN
+ * @details This is processing for ATTN. Telnet IP is sent on its own, not as a 3270 record.
  */
 void DisplayScreen::interruptProcess()
 {
-    QByteArray b = QByteArray();
-
-    b.append((uchar) IAC);
-    b.append((uchar) IP);
-
-    emit bufferReady(b);
+    emit telnetCommand(IP);
 }
 
 /**
  * @brief   DisplayScreen::blink - blink the display
  *
- * @details Called by a timer in Terminal to blink any characters that have blink enabled
+ * @details Called by a timer in Terminal to blink any characters that have blink enabled. The blinking
+ *          characters are all in the blink layer, so this is the same amount of work however many there are.
  */
 void DisplayScreen::blink()
 {
     blinkShow = !blinkShow;
-    for(QRectF r : blinkCells)
-    {
-        update(r);
-    }
+    blinkLayer.setVisible(blinkShow);
 }
 
 /**
@@ -1012,22 +1417,9 @@ void DisplayScreen::cursorBlink()
  */
 int DisplayScreen::findField(int pos)
 {
-//    qDebug() << "Searching for field for" << pos;
-    int endPos = pos - screenPos_max;
-    int offset = pos;
+    int field = fields.fieldOf(pos);
 
-    for (int i = pos; i > endPos ; i--)
-    {
-        if (cells[offset].isFieldStart())
-        {
-            return offset;
-        }
-        if (--offset < 0)
-        {
-            offset = screenPos_max - 1;
-        }
-    }
-    return pos;
+    return field < 0 ? pos : field;
 }
 
 /**
@@ -1041,22 +1433,9 @@ int DisplayScreen::findField(int pos)
  */
 int DisplayScreen::findNextField(int pos)
 {
-    int tmpPos;
+    int field = fields.next(pos % screenPos_max);
 
-    if(cells[pos].isFieldStart())
-    {
-        pos++;
-    }
-
-    for(int i = pos; i < (pos + screenPos_max); i++)
-    {
-        tmpPos = i % screenPos_max;
-        if (cells[tmpPos].isFieldStart())
-        {
-            return tmpPos;
-        }
-    }
-    return pos;
+    return field < 0 ? pos : field;
 }
 
 /**
@@ -1067,24 +1446,29 @@ int DisplayScreen::findNextField(int pos)
  * @details Find the next field that is unprotected. This incorporates two field start attributes next
  *          to each other - field start attributes are protected, so with two adjacent Field Starts,
  *          the first cannot be an unprotected field. Used by tab, home, and the PT order.
+ *
+ *          The candidates come from the field directory's bitmap of unprotected fields, so each one costs
+ *          a few word-sized bit scans rather than a walk over the cells in between.
  */
 int DisplayScreen::findNextUnprotectedField(int pos)
 {
-    int tmpPos;
-    int tmpNxt;
-    for(int i = pos; i < (pos + screenPos_max); i++)
+    pos %= screenPos_max;
+
+    int field = fields.nextUnprotected(pos);
+
+    // Each unprotected field is looked at no more than once
+    for (int i = 0; field >= 0 && i < fields.count(); i++)
     {
-        // Check this position for unprotected and fieldStart and check the next position for
-        // fieldStart - an unprotected field cannot start where two fieldStarts are adajacent
-        tmpPos = i % screenPos_max;
-        tmpNxt = (i + 1) % screenPos_max;
-        if (cells[tmpPos].isFieldStart() && !cells[tmpPos].isProtected() && !cells[tmpNxt].isFieldStart())
+        // An unprotected field cannot start where two fieldStarts are adjacent
+        if (!cells.isFieldStart((field + 1) % screenPos_max))
         {
-            return tmpPos;
+            return field;
         }
+
+        field = fields.nextUnprotected((field + 1) % screenPos_max);
     }
-    printf("No unprotected field found: start = %d, end = %d\n", pos, pos + screenPos_max);
-    fflush(stdout);
+
+    TRACE(datastream) << "No unprotected field found: start =" << pos << "end =" << pos + screenPos_max;
     return 0;
 }
 
@@ -1096,32 +1480,34 @@ int DisplayScreen::findNextUnprotectedField(int pos)
  * @details Find the previous field that is unprotected. This incorporates two field start attributes
  *          next to each other - field start attributes are protected, so with two adjacent Field Starts,
  *          the first cannot be an unprotected field.
+ *
+ *          The search starts two positions before pos, so that the field the cursor is at the start of is
+ *          skipped, and goes back no further than the position after pos.
  */
 int DisplayScreen::findPrevUnprotectedField(int pos)
 {
-    int tmpPos;
-    int tmpNxt;
+    int from = ((pos - 2) % screenPos_max + screenPos_max) % screenPos_max;
 
-    int endPos = pos - screenPos_max;
+    int field = fields.prevUnprotected(from);
 
-    for(int i = pos - 2; i > endPos; i--)
+    for (int i = 0; field >= 0 && i < fields.count(); i++)
     {
-        tmpPos = i;
-        if (tmpPos < 0)
+        // Stop once the search has come back round to pos
+        if ((from - field + screenPos_max) % screenPos_max > screenPos_max - 3)
         {
-            tmpPos = screenPos_max + i;
+            break;
         }
-        // Check this position for unprotected and fieldStart and check the next position for
-        // fieldStart - an unprotected field cannot start where two fieldStarts are adajacent
-        // As we're searching backwards, providing the next position isn't a fieldStart, we're good.
-        tmpNxt = (tmpPos + 1) % screenPos_max;
-        if (cells[tmpPos].isFieldStart() && !cells[tmpPos].isProtected() && !cells[tmpNxt].isFieldStart())
+
+        // As we're searching backwards, providing the next position isn't a fieldStart, we're good
+        if (!cells.isFieldStart((field + 1) % screenPos_max))
         {
-            return tmpPos;
+            return field;
         }
+
+        field = fields.prevUnprotected(field > 0 ? field - 1 : screenPos_max - 1);
     }
-    printf("No unprotected field found: start = %d, end = %d\n", pos, pos + screenPos_max);
-    fflush(stdout);
+
+    TRACE(datastream) << "No unprotected field found: start =" << pos << "end =" << pos + screenPos_max;
     return pos - 1;
 }
 
@@ -1134,93 +1520,80 @@ int DisplayScreen::findPrevUnprotectedField(int pos)
  */
 void DisplayScreen::getModifiedFields(QByteArray &buffer)
 {
-    for(int i = 0; i < screenPos_max; i++)
+    if (unformatted)
     {
-        if (!unformatted)
+        for(int i = 0; i < screenPos_max; i++)
         {
-            if (!cells[i].isProtected())
+            uchar b = cells.getEBCDIC(i);
+            if (b != IBM3270_CHAR_NULL)
             {
-                if (cells[i].isFieldStart())
-                {
-                    qDebug() << "Input field found at " << i << "MDT is" << cells[i].isMdtOn();
-                    // This assumes that where two fields are adajcent to each other, the first cannot have MDT set
-                    if (cells[i].isMdtOn())
-                    {
-                        buffer.append(IBM3270_SBA);
-
-                        int nextPos = (i + 1) % screenPos_max;
-
-                        addPosToBuffer(buffer, nextPos);
-
-                        do
-                        {
-                            uchar b = cells[nextPos++].getEBCDIC();
-                            if (b != IBM3270_CHAR_NULL)
-                            {
-                                buffer.append(b);
-                            }
-                            nextPos = nextPos % screenPos_max;
-                        }
-                        while(!cells[nextPos].isFieldStart());
-                    }
-                }
+                buffer.append(b);
             }
         }
-        else
+
+        return;
+    }
+
+    // Only the field starts need to be looked at, in screen order
+    for (int i : fields.positions())
+    {
+        if (!cells.isProtected(i))
         {
-            uchar b = cells[i].getEBCDIC();
-            if (b != IBM3270_CHAR_NULL)
+            TRACE(datastream) << "Input field found at" << i << "MDT is" << cells.isMdtOn(i);
+            // This assumes that where two fields are adajcent to each other, the first cannot have MDT set
+            if (cells.isMdtOn(i))
             {
-                buffer.append(b);
-            }
+                buffer.append(IBM3270_SBA);
+
+                int nextPos = (i + 1) % screenPos_max;
 
+                addPosToBuffer(buffer, nextPos);
+
+                do
+                {
+                    uchar b = cells.getEBCDIC(nextPos++);
+                    if (b != IBM3270_CHAR_NULL)
+                    {
+                        buffer.append(b);
+                    }
+                    nextPos = nextPos % screenPos_max;
+                }
+                while(!cells.isFieldStart(nextPos));
+            }
         }
     }
 }
 
 /**
- * @brief   DisplayScreen::addPosToBuffer - insert 'pos' into 'buffer' as two bytes, doubling 0xFF if needed.
+ * @brief   DisplayScreen::addPosToBuffer - insert 'pos' into 'buffer' as two bytes
  * @param   buffer - QByteArray to append pos into
  * @param   pos    - screen position
  *
- * @details Adds the screen position pos into the buffer. The 3270 datastream uses 0xFF as an control byte
- *          so any actual 0xFF bytes are doubled - a 0xFF 0xFF sequence in the stream indicates a single
- *          0xFF byte.
+ * @details Adds the screen position pos into the buffer. Any 0xFF bytes are doubled when the response is
+ *          framed by SocketConnection::sendResponse.
+ *
+ *          Screens of up to 4K cells use 12 bit addresses, and larger ones 14 bit, as the Query Reply
+ *          (Usable Area) tells the host. 16 bit addresses are only used in explicit partitions, which Q3270
+ *          does not create, and screens are never larger than 14 bits can address.
  */
 void DisplayScreen::addPosToBuffer(QByteArray &buffer, int pos)
 {
     int byte1;
     int byte2;
 
-    if (screenPos_max < 4096) // 12 bit
+    if (screenPos_max <= 4096) // 12 bit
     {
         byte1 = twelveBitBufferAddress[(pos>>6) & 0x3F];
         byte2 = twelveBitBufferAddress[(pos & 0x3F)];
     }
-    else if (screenPos_max < 16384) // 14 bit
+    else // 14 bit
     {
         byte1 = (pos>>8) & 0x3F;
         byte2 = pos & 0xFF;
     }
-    else // 16 bit
-    {
-        byte1 = (pos>>8) & 0xFF;
-        byte2 = pos & 0xFF;
-    }
 
     buffer.append(byte1);
-
-    if (byte1 == 0xFF)
-    {
-        buffer.append(0xFF);
-    }
-
     buffer.append(byte2);
-
-    if (byte2 == 0xFF)
-    {
-        buffer.append(0xFF);
-    }
 }
 
 /**
@@ -1242,7 +1615,7 @@ void DisplayScreen::dumpFields()
         line.append(QString("%1").arg(i%10));
     }
 
-    qDebug() << "Fields on screen:" << fieldCount;
+    qDebug() << "Fields on screen:" << fields.count();
 
     qDebug() << "     " << line;
 
@@ -1253,12 +1626,12 @@ void DisplayScreen::dumpFields()
         {
             int tmppos = i * screen_x + j;
 
-            if (cells[tmppos].isFieldStart())
-                if (cells[tmppos].isMdtOn())
+            if (cells.isFieldStart(tmppos))
+                if (cells.isMdtOn(tmppos))
                     line.append("F");
                 else
                     line.append("f");
-            else if (cells[tmppos].getField() && cells[tmppos].getField()->isFieldStart())
+            else if (!unformatted)
                 line.append(".");
             else
                 line.append("X");
@@ -1289,8 +1662,8 @@ void DisplayScreen::dumpDisplay()
             hexline = "";
             ascii = "";
         }
-        ascii.append(cp.getUnicodeChar(cells[i].getEBCDIC()));
-        hexline.append(QString::asprintf("%02X ", cells[i].getEBCDIC()));
+        ascii.append(cp.getUnicodeChar(cells.getEBCDIC(i)));
+        hexline.append(QString::asprintf("%02X ", cells.getEBCDIC(i)));
     }
 
     if (!hexline.isEmpty())
@@ -1310,31 +1683,35 @@ void DisplayScreen::dumpInfo()
     int x = cursor_pos - y * screen_x;
 
     qDebug().noquote() << QString::asprintf("Cell at %d (%d, %d)", cursor_pos, x, y);
-    qDebug().noquote() << "    Character: \"" << cp.getUnicodeChar(cells[cursor_pos].getEBCDIC()) << "\""
-                       << " (hex EBCDIC " << Qt::hex << (int) cells[cursor_pos].getEBCDIC()
-                       << "ASCII " << Qt::hex << (int) (cp.getUnicodeChar(cells[cursor_pos].getEBCDIC()).length() > 0 ? cp.getUnicodeChar(cells[cursor_pos].getEBCDIC()).at(0).unicode() : 0) << ")";
-
-    qDebug().noquote() << "    Field Attribute: " << cells[cursor_pos].isFieldStart();
-    qDebug().noquote() << "        MDT:       " << cells[cursor_pos].isMdtOn();
-    qDebug().noquote() << "        Protected: " << cells[cursor_pos].isProtected();
-    qDebug().noquote() << "        Numeric:   " << cells[cursor_pos].isNumeric();
-    qDebug().noquote() << "        Display:   " << cells[cursor_pos].isDisplay();
-
-    qDebug().noquote() << "    Extended: " << cells[cursor_pos].isExtended();
-    qDebug().noquote() << "        Intensify: " << cells[cursor_pos].isIntensify();
-    qDebug().noquote() << "        UScore:    " << cells[cursor_pos].isUScore();
-    qDebug().noquote() << "        Reverse:   " << cells[cursor_pos].isReverse();
-    qDebug().noquote() << "        Blink:     " << cells[cursor_pos].isBlink();
+    qDebug().noquote() << "    Character: \"" << cp.getUnicodeChar(cells.getEBCDIC(cursor_pos)) << "\""
+                       << " (hex EBCDIC " << Qt::hex << (int) cells.getEBCDIC(cursor_pos)
+                       << "ASCII " << Qt::hex << (int) (cp.getUnicodeChar(cells.getEBCDIC(cursor_pos)).length() > 0 ? cp.getUnicodeChar(cells.getEBCDIC(cursor_pos)).at(0).unicode() : 0) << ")";
+
+    // Field attributes come from the field start; a cell on an unformatted screen has the defaults
+    int field = fields.fieldOf(cursor_pos);
+    Q3270::Highlight highlight = cells.getHighlight(cursor_pos, field);
+
+    qDebug().noquote() << "    Field Attribute: " << cells.isFieldStart(cursor_pos);
+    qDebug().noquote() << "        MDT:       " << (field >= 0 && cells.isMdtOn(field));
+    qDebug().noquote() << "        Protected: " << (field >= 0 && cells.isProtected(field));
+    qDebug().noquote() << "        Numeric:   " << (field >= 0 && cells.isNumeric(field));
+    qDebug().noquote() << "        Display:   " << (field < 0 || cells.isDisplay(field));
+
+    qDebug().noquote() << "    Extended: " << (field >= 0 && cells.isExtended(field));
+    qDebug().noquote() << "        Intensify: " << (field >= 0 && cells.isIntensify(field));
+    qDebug().noquote() << "        UScore:    " << (highlight == Q3270::Underscore);
+    qDebug().noquote() << "        Reverse:   " << (highlight == Q3270::Reverse);
+    qDebug().noquote() << "        Blink:     " << (highlight == Q3270::Blink);
 
     qDebug().noquote() << "    Character Attributes:";
-    qDebug().noquote() << "        Extended: " << cells[cursor_pos].hasCharAttrs(Q3270::ExtendedAttr);
-    qDebug().noquote() << "        CharSet:  " << cells[cursor_pos].hasCharAttrs(Q3270::CharsetAttr);
-    qDebug().noquote() << "        Colour:   " << cells[cursor_pos].hasCharAttrs(Q3270::ColourAttr);
+    qDebug().noquote() << "        Extended: " << cells.hasCharAttrs(cursor_pos, Q3270::ExtendedAttr);
+    qDebug().noquote() << "        CharSet:  " << cells.hasCharAttrs(cursor_pos, Q3270::CharsetAttr);
+    qDebug().noquote() << "        Colour:   " << cells.hasCharAttrs(cursor_pos, Q3270::ColourAttr);
 
-    qDebug().noquote() << "    Colour:   " << cells[cursor_pos].getColour();
-    qDebug().noquote() << "    Graphic:  " << cells[cursor_pos].isGraphic();
+    qDebug().noquote() << "    Colour:   " << cells.getColour(cursor_pos, field);
+    qDebug().noquote() << "    Graphic:  " << cells.isGraphic(cursor_pos);
 
-    int fieldStart = cells[cursor_pos].getField() - cells.data();
+    int fieldStart = fields.fieldOf(cursor_pos);
     qDebug().noquote() << "    Field Position: " << fieldStart << "(" << fieldStart / screen_x << "," << (fieldStart - (int) (fieldStart / screen_x) * screen_x) << ")";
 }
 
@@ -1351,160 +1728,434 @@ void DisplayScreen::getScreen(QByteArray &buffer)
 
     addPosToBuffer(buffer, cursor_pos);
 
-    dumpDisplay();
+    if (TRACE_ENABLED(datastream))
+    {
+        dumpDisplay();
+    }
 
     for (int i = 0; i < screenPos_max; i++)
     {
-        if (cells[i].isFieldStart())
+        if (cells.isFieldStart(i))
         {
             buffer.append(IBM3270_SF);
+
+            // Display/selector pen bits, as setField() decodes them
             uchar attr;
-            if (cells[i].isDisplay() && !cells[i].isPenSelect())
+            if (!cells.isDisplay(i))
             {
-                attr = 0x00;
+                attr = 3;
             }
-            else if (cells[i].isDisplay() && cells[i].isPenSelect())
+            else if (cells.isIntensify(i))
             {
-                attr = 0x01;
+                attr = 2;
             }
-            else if(cells[i].isIntensify())
+            else if (cells.isPenSelect(i))
             {
-                attr = 0x10;
+                attr = 1;
             }
             else
             {
-                attr = 0x11;
+                attr = 0;
             }
 
-            int byte = twelveBitBufferAddress[cells[i].isMdtOn() | attr << 3 | cells[i].isNumeric() << 4 | cells[i].isProtected() << 5];
+            int byte = twelveBitBufferAddress[cells.isMdtOn(i) | attr << 2 | cells.isNumeric(i) << 4 | cells.isProtected(i) << 5];
 
             buffer.append(byte);
-
-            // Double up 0xFF bytes
-            if (byte == 0xFF)
-            {
-                buffer.append(byte);
-            }
         }
         else
         {
-            buffer.append(cells[i].getEBCDIC());
+            buffer.append(cells.getEBCDIC(i));
         }
     }
 }
 
 /**
  * @brief   DisplayScreen::applyCharAttributes - apply the character attributes to the cell
- * @param   pos       - screen position
- * @param   fieldAttr - field attribute
+ * @param   pos - screen position
  *
- * @details Apply the character attributes to the cell at pos. This is used when the datastream
- *          selected a different colour for the specified cell.
+ * @details A cell written while an SA order has set a colour or highlighting keeps it as its own, with the
+ *          character attribute bit set so that it is shown instead of the field's. Any other cell is shown with
+ *          the colour and highlighting of its field, which is found when it is painted, so nothing is stored.
+ *
+ *          A cell that still has the bit from an earlier character is given the attribute of its field as it
+ *          is now.
  */
-void DisplayScreen::applyCharAttributes(int pos, Cell *field)
+void DisplayScreen::applyCharAttributes(int pos)
 {
     if (!charAttr.colour_default)
-        cells[pos].setCharAttrs(Q3270::ColourAttr, true);
-    else
-        cells[pos].setColour(field->getColour());
+    {
+        cells.setCharAttrs(pos, Q3270::ColourAttr, true);
+        cells.setColour(pos, charAttr.colNum);
+    }
+    else if (cells.hasCharAttrs(pos, Q3270::ColourAttr))
+    {
+        int field = fields.fieldOf(pos);
+
+        cells.setColour(pos, field >= 0 ? cells.getColour(field) : Q3270::UnprotectedNormal);
+    }
 
     if (!charAttr.highlight_default)
-        cells[pos].setCharAttrs(Q3270::ExtendedAttr, true);
+    {
+        cells.setCharAttrs(pos, Q3270::ExtendedAttr, true);
+        cells.setHighlight(pos, charAttr.highlight);
+    }
+    else if (cells.hasCharAttrs(pos, Q3270::ExtendedAttr))
+    {
+        int field = fields.fieldOf(pos);
+
+        cells.setHighlight(pos, field >= 0 ? cells.getHighlight(field) : Q3270::NoHighlight);
+    }
+}
+
+/**
+ * @brief   DisplayScreen::paint - paint the screen
+ * @param   p      - the painter
+ * @param   option - gives the area to be painted; without one, the whole screen is painted
+ *
+ * @details Only the cells in the exposed area are painted, which after a keystroke or a small write is only
+ *          those publish() found had changed. The number painted is kept for cellsPainted().
+ *
+ *          Only front is read. Publishing is left to endWrite() and the keyboard edits, as it can schedule
+ *          repaints and change the blink layer, neither of which may be done while the scene is painting.
+ *
+ *          With the backing image turned on, the cells are drawn into it by paintBacking() and the exposed area
+ *          copied from it; only the cells that changed since it was last painted are drawn.
+ */
+void DisplayScreen::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    QRectF exposed = option ? option->exposedRect : boundingRect();
+
+    if (useBackingImage(p))
+    {
+        paintBacking(p, exposed);
+    }
     else
-        cells[pos].setHighlight(field->getHighlight());
+    {
+        int firstRow;
+        int lastRow;
+        int firstCol;
+        int lastCol;
+
+        cellsIn(exposed, firstRow, lastRow, firstCol, lastCol);
+
+        painted = (lastRow - firstRow) * (lastCol - firstCol);
+
+        paintCells(p, firstRow, lastRow, firstCol, lastCol);
+    }
+
+    TRACE(render) << "paint" << screen_x << "x" << screen_y << "-" << painted << "cells";
+
+/*
+    QPen pen(QColor(128,128,128,64));
+    pen.setWidth(0);
+    p->setPen(pen);
+
+    for (int c = 0; c <= screen_x; ++c) {
+        qreal x = c * gridSize_X + 0.5;
+        p->drawLine(x, 0, x, screen_y * gridSize_Y);
+    }
+    for (int r = 0; r <= screen_y; ++r) {
+        qreal y = r * gridSize_Y + 0.5;
+        p->drawLine(0, y, screen_x * gridSize_X, y);
+    }
+*/
+
+    if (latency)
+    {
+        latency->painted(LatencyStats::now());
+    }
 }
 
-void DisplayScreen::paint(QPainter *p, const QStyleOptionGraphicsItem *, QWidget *)
+/**
+ * @brief   DisplayScreen::paintCells - paint a range of cells
+ * @param   p        - the painter
+ * @param   firstRow - the first row to paint
+ * @param   lastRow  - the row after the last one
+ * @param   firstCol - the first column to paint
+ * @param   lastCol  - the column after the last one
+ *
+ * @details The cells are copied from the glyph atlas by paintGlyphs() or, where the atlas is not used, drawn as
+ *          runs of text by paintText(). Blinking characters are left to the blink layer.
+ */
+void DisplayScreen::paintCells(QPainter *p, int firstRow, int lastRow, int firstCol, int lastCol)
+{
+    const QColor black = palette->colour(Q3270::Black);
+
+    p->fillRect(QRectF(firstCol * gridSize_X, firstRow * gridSize_Y,
+                       (lastCol - firstCol) * gridSize_X, (lastRow - firstRow) * gridSize_Y), black);
+
+    if (useAtlas(p))
+    {
+        paintGlyphs(p, firstRow, lastRow, firstCol, lastCol);
+    }
+    else
+    {
+        paintText(p, firstRow, lastRow, firstCol, lastCol);
+    }
+}
+
+/**
+ * @brief   DisplayScreen::cellsIn - find the cells an area touches
+ * @param   rect     - the area
+ * @param   firstRow - set to the first row
+ * @param   lastRow  - set to the row after the last one
+ * @param   firstCol - set to the first column
+ * @param   lastCol  - set to the column after the last one
+ *
+ * @details If the area is outside the screen, the ranges are empty.
+ */
+void DisplayScreen::cellsIn(const QRectF &rect, int &firstRow, int &lastRow, int &firstCol, int &lastCol) const
+{
+    QRectF area = rect & boundingRect();
+
+    firstRow = qMax(0, qFloor(area.top() / gridSize_Y));
+    lastRow = qMax(firstRow, qMin(screen_y, qCeil(area.bottom() / gridSize_Y)));
+    firstCol = qMax(0, qFloor(area.left() / gridSize_X));
+    lastCol = qMax(firstCol, qMin(screen_x, qCeil(area.right() / gridSize_X)));
+}
+
+/**
+ * @brief   DisplayScreen::useAtlas - whether to paint from the glyph atlas
+ * @param   p - the painter
+ * @return  true to use the atlas
+ *
+ * @details The atlas is set to the scale of the painter. It is not used if it has been turned off, if the
+ *          painter keeps text as text (as a PDF writer does), or if the screen is scaled up so far that the
+ *          images would be too big to keep.
+ */
+bool DisplayScreen::useAtlas(QPainter *p)
 {
-    p->fillRect(boundingRect(), palette->colour(Q3270::Black));
+    const QTransform &t = p->deviceTransform();
 
-    p->setFont(font);
+    glyphs.setScale(qAbs(t.m11()), qAbs(t.m22()));
 
-    QPen us;
+    QPaintEngine::Type engine = p->paintEngine() ? p->paintEngine()->type() : QPaintEngine::Raster;
 
-    us.setWidth(0);
-    us.setCosmetic(true);
+    return useGlyphs && glyphs.isUsable() && (engine == QPaintEngine::Raster || engine == QPaintEngine::OpenGL2);
+}
 
-    for (int r = 0; r < screen_y; ++r)
+/**
+ * @brief   DisplayScreen::atlasGlyph - find the image of a cell in the glyph atlas
+ * @param   ebcdic     - the character, or a null for none
+ * @param   graphic    - whether the character is from the graphic character set
+ * @param   fg         - the colour it is drawn in
+ * @param   underscore - whether the cell is underscored
+ * @return  where the image is in the atlas
+ */
+QRectF DisplayScreen::atlasGlyph(uchar ebcdic, bool graphic, const QColor &fg, bool underscore)
+{
+    quint64 key = quint64(fg.rgba()) << 10 | quint64(underscore) << 9 | quint64(graphic) << 8 | ebcdic;
+
+    return glyphs.glyph(key, [&](QPainter *gp) {
+        drawGlyph(gp, QRectF(0, 0, gridSize_X, gridSize_Y), ebcdic, graphic, fg, underscore);
+    });
+}
+
+/**
+ * @brief   DisplayScreen::paintGlyphs - paint cells from the glyph atlas
+ * @param   p        - the painter
+ * @param   firstRow - the first row to paint
+ * @param   lastRow  - the row after the last one
+ * @param   firstCol - the first column to paint
+ * @param   lastCol  - the column after the last one
+ *
+ * @details Each cell is painted by copying its image from the glyph atlas, all in one drawPixmapFragments()
+ *          call; only cells seen for the first time are drawn with text. The atlas is kept at the scale the
+ *          screen is shown at, so that the characters are as sharp as text drawn directly.
+ *
+ *          A cell's image is found by its character, whether it is a graphic character, whether it is
+ *          underscored and its colour. Reverse video cells have their background filled here, and a black
+ *          image drawn over it.
+ */
+void DisplayScreen::paintGlyphs(QPainter *p, int firstRow, int lastRow, int firstCol, int lastCol)
+{
+    const QColor black = palette->colour(Q3270::Black);
+
+    std::vector<QPainter::PixmapFragment> fragments;
+
+    fragments.reserve((lastRow - firstRow) * (lastCol - firstCol));
+
+    for (int r = firstRow; r < lastRow; ++r)
     {
-        for (int c = 0; c < screen_x; ++c)
+        // The field the row starts in
+        int field = frontFields.fieldOf(r * screen_x + firstCol);
+
+        for (int c = firstCol; c < lastCol; ++c)
         {
-            const Cell &cs = cells[r * screen_x + c];
+            int pos = r * screen_x + c;
+
+            bool fieldStart = front.isFieldStart(pos);
+
+            if (fieldStart)
+            {
+                field = pos;
+            }
+
+            bool display = (field < 0 || front.isDisplay(field)) && !fieldStart;
+            Q3270::Highlight highlight = front.getHighlight(pos, field);
 
             QRectF rect(c * gridSize_X, r * gridSize_Y, gridSize_X, gridSize_Y);
 
-            QColor fg = palette->colour(cs.getColour());
-            QColor bg = palette->colour(Q3270::Black);
+            QColor fg = palette->colour(front.getColour(pos, field));
 
             // reverse
-            if (cs.isReverse())
+            if (highlight == Q3270::Reverse)
             {
-                std::swap(fg, bg);
-                p->fillRect(rect, bg);
+                p->fillRect(rect, fg);
+                fg = black;
             }
 
-            // blink
-            if (!(cs.isBlink() && !blinkShow))
+            // Blinking characters are in the blink layer
+            uchar ebcdic = front.getEBCDIC(pos);
+
+            if (!display || highlight == Q3270::Blink)
             {
+                ebcdic = IBM3270_CHAR_NULL;
+            }
 
-                // glyph
-                if (!(cs.getEBCDIC() == IBM3270_CHAR_NULL) && cs.isDisplay() && !cs.isFieldStart())
-                {
-                    p->setPen(fg);
-                    if (!cs.isGraphic())
-                    {
-                        p->drawText(rect, Qt::AlignCenter, cp.getUnicodeChar(cs.getEBCDIC()));
-                        if (cs.getEBCDIC() == IBM3270_CHAR_ZERO)
-                        {
-                            // Slash/dot overlay
-                            p->save();
-                            p->setRenderHint(QPainter::Antialiasing, true);
-                            switch(fontTweak)
-                            {
-                                case Q3270::None:
-                                    break;
-                                case Q3270::ZeroDot:
-                                    p->setBrush(fg);
-                                    p->setPen(Qt::NoPen);
-                                    p->drawEllipse(rect.topLeft() + dotOffset, dotRadius, dotRadius);
-                                    break;
-                                case Q3270::ZeroSlash:
-                                    p->setBrush(Qt::NoBrush);   // no fill needed
-                                    p->setPen(fg);              // stroke colour
-                                    p->drawLine(rect.topLeft() + slashStart,
-                                                rect.topLeft() + slashEnd);
-                                    break;
-                            }
-                            p->restore();
-                        }
-                    }
-                    else
-                    {
-                        p->drawText(rect, Qt::AlignCenter, cp.getUnicodeGraphicChar(cs.getEBCDIC()));
-                    }
-                }
+            bool graphic = ebcdic != IBM3270_CHAR_NULL && front.isGraphic(pos);
+            bool underscore = display && highlight == Q3270::Underscore;
+
+            if (ebcdic == IBM3270_CHAR_NULL && !underscore)
+            {
+                continue;
             }
 
-            // underscore
-            if (cs.isUScore() && !cs.isFieldStart() && cs.isDisplay())
+            QRectF source = atlasGlyph(ebcdic, graphic, fg, underscore);
+
+            fragments.push_back(QPainter::PixmapFragment::create(rect.center(), source,
+                                                                 1 / glyphs.scaleX(), 1 / glyphs.scaleY()));
+        }
+    }
+
+    if (!fragments.empty())
+    {
+        p->drawPixmapFragments(fragments.data(), int(fragments.size()), glyphs.pixmap());
+    }
+}
+
+/**
+ * @brief   DisplayScreen::paintBlinking - paint the blinking characters
+ * @param   p       - the painter
+ * @param   exposed - the area to be painted
+ *
+ * @details Called by the blink layer, over what paint() has painted. Only the cells set in the blinking bitmap
+ *          are looked at. A blinking cell has no other highlighting, so only its character is drawn.
+ */
+void DisplayScreen::paintBlinking(QPainter *p, const QRectF &exposed)
+{
+    int firstRow;
+    int lastRow;
+    int firstCol;
+    int lastCol;
+
+    cellsIn(exposed, firstRow, lastRow, firstCol, lastCol);
+
+    int start = firstRow * screen_x;
+    int end = lastRow * screen_x;
+
+    if (start >= end || firstCol >= lastCol)
+    {
+        return;
+    }
+
+    bool atlas = useAtlas(p);
+
+    std::vector<QPainter::PixmapFragment> fragments;
+
+    for (int w = start >> 6; w <= (end - 1) >> 6; w++)
+    {
+        for (quint64 bits = blinking[w]; bits; bits &= bits - 1)
+        {
+            int pos = (w << 6) + qCountTrailingZeroBits(bits);
+            int c = pos % screen_x;
+
+            if (pos < start || pos >= end || c < firstCol || c >= lastCol)
+            {
+                continue;
+            }
+
+            QRectF rect(c * gridSize_X, (pos / screen_x) * gridSize_Y, gridSize_X, gridSize_Y);
+            QColor fg = palette->colour(front.getColour(pos, frontFields.fieldOf(pos)));
+
+            if (atlas)
+            {
+                QRectF source = atlasGlyph(front.getEBCDIC(pos), front.isGraphic(pos), fg, false);
+
+                fragments.push_back(QPainter::PixmapFragment::create(rect.center(), source,
+                                                                     1 / glyphs.scaleX(), 1 / glyphs.scaleY()));
+            }
+            else
             {
-                p->setPen(fg);
-                p->drawLine(QPoint(rect.left(), rect.bottom() - 1), QPoint(rect.right(), rect.bottom() - 1));
+                drawGlyph(p, rect, front.getEBCDIC(pos), front.isGraphic(pos), fg, false);
             }
         }
     }
-/*
-    QPen pen(QColor(128,128,128,64));
-    pen.setWidth(0);
-    p->setPen(pen);
 
-    for (int c = 0; c <= screen_x; ++c) {
-        qreal x = c * gridSize_X + 0.5;
-        p->drawLine(x, 0, x, screen_y * gridSize_Y);
+    if (!fragments.empty())
+    {
+        p->drawPixmapFragments(fragments.data(), int(fragments.size()), glyphs.pixmap());
     }
-    for (int r = 0; r <= screen_y; ++r) {
-        qreal y = r * gridSize_Y + 0.5;
-        p->drawLine(0, y, screen_x * gridSize_X, y);
+}
+
+/**
+ * @brief   DisplayScreen::drawGlyph - draw the contents of a cell
+ * @param   p          - the painter
+ * @param   rect       - the cell
+ * @param   ebcdic     - the character, or a null for none
+ * @param   graphic    - whether the character is from the graphic character set
+ * @param   fg         - the colour to draw in
+ * @param   underscore - whether the cell is underscored
+ *
+ * @details Used to draw each image in the glyph atlas, and by paintText() for the cells it does not draw as
+ *          part of a run. A zero is drawn with the font tweak overlay.
+ */
+void DisplayScreen::drawGlyph(QPainter *p, const QRectF &rect, uchar ebcdic, bool graphic, const QColor &fg,
+                              bool underscore) const
+{
+    p->setPen(fg);
+
+    // glyph
+    if (ebcdic != IBM3270_CHAR_NULL)
+    {
+        p->setFont(font);
+
+        if (!graphic)
+        {
+            p->drawText(rect, Qt::AlignCenter, cp.getUnicodeChar(ebcdic));
+            if (ebcdic == IBM3270_CHAR_ZERO)
+            {
+                // Slash/dot overlay
+                p->save();
+                p->setRenderHint(QPainter::Antialiasing, true);
+                switch(fontTweak)
+                {
+                    case Q3270::None:
+                        break;
+                    case Q3270::ZeroDot:
+                        p->setBrush(fg);
+                        p->setPen(Qt::NoPen);
+                        p->drawEllipse(rect.topLeft() + dotOffset, dotRadius, dotRadius);
+                        break;
+                    case Q3270::ZeroSlash:
+                        p->setBrush(Qt::NoBrush);   // no fill needed
+                        p->setPen(fg);              // stroke colour
+                        p->drawLine(rect.topLeft() + slashStart,
+                                    rect.topLeft() + slashEnd);
+                        break;
+                }
+                p->restore();
+            }
+        }
+        else
+        {
+            p->drawText(rect, Qt::AlignCenter, cp.getUnicodeGraphicChar(ebcdic));
+        }
+    }
+
+    // underscore
+    if (underscore)
+    {
+        p->drawLine(QPointF(rect.left(), rect.bottom() - 1), QPointF(rect.right(), rect.bottom() - 1));
     }
-*/
 }
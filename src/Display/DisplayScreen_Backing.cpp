@@ -0,0 +1,170 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <QPaintEngine>
+#include <QtMath>
+
+#include "DisplayScreen.h"
+
+/**
+ * @brief   DisplayScreen::setBackingImage - choose whether the screen is painted through a backing image
+ * @param   on - true to keep the painted cells in an image at the resolution of the device
+ *
+ * @details With the backing image, paint() draws only the cells that have changed since the image was last
+ *          brought up to date, and copies the rest of the exposed area from the image.
+ */
+void DisplayScreen::setBackingImage(bool on)
+{
+    useBacking = on;
+
+    if (!on)
+    {
+        backing = QImage();
+    }
+
+    invalidateBacking();
+    update();
+}
+
+/**
+ * @brief   DisplayScreen::invalidateBacking - mark every cell of the backing image to be drawn again
+ *
+ * @details Called when something changes how every cell looks, such as the font or the colours.
+ */
+void DisplayScreen::invalidateBacking()
+{
+    backingStale = useBacking ? QRegion(0, 0, screen_x, screen_y) : QRegion();
+}
+
+/**
+ * @brief   DisplayScreen::fitScale - the scale that fits an area holding the screen into a viewport
+ * @param   area     - the size of the area, in scene coordinates
+ * @param   viewport - the size of the viewport, in logical pixels
+ * @param   dpr      - the device pixel ratio of the viewport
+ * @param   mode     - whether the scale is to be the same across as down
+ * @return  the scale from the scene to the viewport, across and down
+ *
+ * @details The scale that would just fit the area is reduced until a cell is a whole number of device pixels
+ *          each way. The characters are then drawn at the font size that fills the cell on the device, every
+ *          cell starts on a pixel, and the backing image is copied to the device one pixel for one.
+ */
+QSizeF DisplayScreen::fitScale(const QSizeF &area, const QSize &viewport, qreal dpr, Qt::AspectRatioMode mode) const
+{
+    if (area.isEmpty() || viewport.isEmpty() || dpr <= 0)
+    {
+        return QSizeF(1, 1);
+    }
+
+    qreal sx = viewport.width() / area.width();
+    qreal sy = viewport.height() / area.height();
+
+    if (mode == Qt::KeepAspectRatio)
+    {
+        sx = sy = qMin(sx, sy);
+    }
+
+    // The size of a cell in device pixels
+    int cellWidth = qMax(1, qFloor(gridSize_X * sx * dpr));
+    int cellHeight = qMax(1, qFloor(gridSize_Y * sy * dpr));
+
+    return QSizeF(cellWidth / (gridSize_X * dpr), cellHeight / (gridSize_Y * dpr));
+}
+
+/**
+ * @brief   DisplayScreen::useBackingImage - whether to paint through the backing image
+ * @param   p - the painter
+ * @return  true to use the backing image
+ *
+ * @details The image is only used when it has been turned on and the painter draws to pixels with no more than
+ *          a scale, as a view does; a painter that keeps text as text, or that rotates, is painted directly.
+ */
+bool DisplayScreen::useBackingImage(QPainter *p) const
+{
+    if (!useBacking || !p->paintEngine() || p->paintEngine()->type() != QPaintEngine::Raster)
+    {
+        return false;
+    }
+
+    const QTransform &t = p->deviceTransform();
+
+    return t.type() <= QTransform::TxScale && t.m11() > 0 && t.m22() > 0;
+}
+
+/**
+ * @brief   DisplayScreen::paintBacking - paint the screen from the backing image
+ * @param   p       - the painter
+ * @param   exposed - the area to be painted
+ *
+ * @details The image is the size of the screen on the device; the device transform includes the device pixel
+ *          ratio. If the scale has changed since it was last drawn, it is drawn again in full; otherwise only
+ *          the cells updateRange() has marked are drawn. The cells are drawn as paint() would draw them,
+ *          clipped to the whole pixels they cover, together with any cell that shares one of those pixels.
+ *
+ *          The exposed area is then copied from the image, each pixel of the image to one pixel of the device.
+ */
+void DisplayScreen::paintBacking(QPainter *p, const QRectF &exposed)
+{
+    const QTransform t = p->deviceTransform();
+    const QRectF screen = boundingRect();
+
+    QSize size(qCeil(screen.width() * t.m11()), qCeil(screen.height() * t.m22()));
+
+    if (backing.size() != size || !qFuzzyCompare(backingScale.width(), t.m11())
+            || !qFuzzyCompare(backingScale.height(), t.m22()))
+    {
+        backing = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        backingScale = QSizeF(t.m11(), t.m22());
+
+        invalidateBacking();
+    }
+
+    painted = 0;
+
+    if (!backingStale.isEmpty())
+    {
+        QTransform scale = QTransform::fromScale(backingScale.width(), backingScale.height());
+        QTransform unscale = scale.inverted();
+
+        QPainter bp(&backing);
+
+        for (const QRect &r : backingStale)
+        {
+            QRectF area(r.x() * gridSize_X, r.y() * gridSize_Y, r.width() * gridSize_X, r.height() * gridSize_Y);
+            QRect pixels = scale.mapRect(area).toAlignedRect() & backing.rect();
+
+            int firstRow;
+            int lastRow;
+            int firstCol;
+            int lastCol;
+
+            cellsIn(unscale.mapRect(QRectF(pixels)), firstRow, lastRow, firstCol, lastCol);
+
+            // The clip is in pixels, so it is set before the scale
+            bp.resetTransform();
+            bp.setClipRect(pixels);
+            bp.setTransform(scale);
+
+            paintCells(&bp, firstRow, lastRow, firstCol, lastCol);
+
+            painted += (lastRow - firstRow) * (lastCol - firstCol);
+        }
+
+        backingStale = QRegion();
+    }
+
+    // The image starts on the pixel nearest the top left of the screen
+    QPoint origin = t.map(QPointF(0, 0)).toPoint();
+    QRect target = t.mapRect(exposed & screen).toAlignedRect() & QRect(origin, backing.size());
+
+    if (!target.isEmpty())
+    {
+        p->drawImage(t.inverted().mapRect(QRectF(target)), backing, QRectF(target.translated(-origin)));
+    }
+}
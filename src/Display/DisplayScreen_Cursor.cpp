@@ -41,8 +41,8 @@ void DisplayScreen::setCursor(const int x, const int y)
 
     if (cursorColour)
     {
-        const Cell c = cells[cursor_pos];
-        const Q3270::Colour colour = c.isReverse() ? Q3270::Black : c.getColour();
+        int field = fields.fieldOf(cursor_pos);
+        const Q3270::Colour colour = cells.getHighlight(cursor_pos, field) == Q3270::Reverse ? Q3270::Black : cells.getColour(cursor_pos, field);
 
         cursor.setBrush(palette->colour(colour));
     }
@@ -149,9 +149,10 @@ void DisplayScreen::endline()
     endField = cursor_pos;
     bool letter = false;
 
-    while(i < endPos && !isProtected(offset) && !isFieldStart(offset))
+    // The cells up to the next field start are all in the cursor's unprotected field
+    while(i < endPos && !isFieldStart(offset))
     {
-        uchar thisChar = cp.getEBCDIC(cells[offset].getEBCDIC());
+        uchar thisChar = cp.getEBCDIC(cells.getEBCDIC(offset));
         if (letter && (thisChar == 0x00 || thisChar == ' '))
         {
             endField = offset;
@@ -220,7 +221,9 @@ void DisplayScreen::setCursorColour(bool inherit)
     cursorColour = inherit;
     if (inherit)
     {
-        cursor.setBrush(palette->colour(cells[cursor.data(0).toInt()].getColour()));
+        int pos = cursor.data(0).toInt();
+
+        cursor.setBrush(palette->colour(cells.getColour(pos, fields.fieldOf(pos))));
     }
     else
     {
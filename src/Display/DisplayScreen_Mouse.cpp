@@ -99,6 +99,9 @@ void DisplayScreen::mouseMoveEvent(QGraphicsSceneMouseEvent *mEvent)
  * @details Called when the left mouse button is released. If the mouse button was released without
  *          moving the mouse, the rubberband will be invisible, and this is interpreted as the user
  *          wishing to move the cursor by clicking somewhere in the display.
+ *
+ *          cursorClicked is emitted so that, when the session runs on a SessionWorker, the cursor in the
+ *          worker's screen can be moved too.
  */
 void DisplayScreen::mouseReleaseEvent(QGraphicsSceneMouseEvent *mEvent)
 {
@@ -109,6 +112,7 @@ void DisplayScreen::mouseReleaseEvent(QGraphicsSceneMouseEvent *mEvent)
     {
 //        qDebug() << "Single click";
         setCursor(myRb->data(0).toInt(), myRb->data(1).toInt());
+        emit cursorClicked(myRb->data(0).toInt(), myRb->data(1).toInt());
         return;
     }
 
@@ -156,7 +160,7 @@ void DisplayScreen::copyText()
         for(int x = left; x <= right; x++)
         {
             int thisPos = screen_x * y + x;
-            cbText = cbText + cp.getUnicodeChar(cells[thisPos].getEBCDIC());
+            cbText = cbText + cp.getUnicodeChar(cells.getEBCDIC(thisPos));
         }
     }
 
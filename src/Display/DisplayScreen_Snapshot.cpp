@@ -0,0 +1,84 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include "DisplayScreen.h"
+
+/**
+ * @brief   DisplayScreen::takeSnapshot - copy the changes to the display matrix for another thread
+ * @param   replacing - a snapshot that was never applied and is being replaced, or nullptr
+ * @return  the snapshot
+ *
+ * @details Used by SessionWorker, on the worker thread, to publish the state of the screen after the host
+ *          or the keyboard has changed it. Anything not yet published is published first, and the snapshot
+ *          takes the blocks published since the last one. A screen size change counts as a change to every
+ *          block, so a snapshot of a different size from the one it replaces already holds everything.
+ */
+ScreenSnapshotPtr DisplayScreen::takeSnapshot(const ScreenSnapshot *replacing)
+{
+    publish();
+
+    if (replacing && replacing->width == screen_x && replacing->height == screen_y)
+    {
+        PresentationSpace::mergeBlocks(unsent, replacing->changes.changed);
+    }
+
+    ScreenSnapshot *snapshot = new ScreenSnapshot;
+
+    snapshot->width = screen_x;
+    snapshot->height = screen_y;
+    snapshot->cursorPos = cursor_pos;
+    snapshot->taken = LatencyStats::now();
+
+    snapshot->changes = front.extractBlocks(unsent);
+
+    unsent.fill(0);
+
+    return ScreenSnapshotPtr(snapshot);
+}
+
+/**
+ * @brief   DisplayScreen::applySnapshot - replace the display matrix with a snapshot
+ * @param   snapshot - the snapshot published by the SessionWorker
+ *
+ * @details Called on the GUI thread. The changed cells, the cursor position and, if it has changed, the
+ *          screen size are taken from the snapshot. The field directory is rebuilt from the new cells, which
+ *          are then published; the cells that look different are repainted, and the blinking cells found. The
+ *          records the snapshot holds are then waiting for the paint, for the latency measurements.
+ */
+void DisplayScreen::applySnapshot(const ScreenSnapshot &snapshot)
+{
+    if (snapshot.width != screen_x || snapshot.height != screen_y)
+    {
+        setSize(snapshot.width, snapshot.height);
+    }
+
+    cells.applyBlocks(snapshot.changes);
+
+    fields.clear();
+
+    for (int i = 0; i < screenPos_max; i++)
+    {
+        if (cells.isFieldStart(i))
+        {
+            fields.add(i, !cells.isProtected(i));
+        }
+    }
+
+    unformatted = fields.isEmpty();
+
+    setCursor(snapshot.cursorPos);
+
+    publish();
+
+    if (latency)
+    {
+        latency->published(snapshot.taken);
+    }
+}
@@ -0,0 +1,216 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include "DisplayScreen.h"
+
+/**
+ * @brief   DisplayScreen::invalidateRows - mark rows to be laid out again
+ * @param   firstRow - the first row
+ * @param   lastRow  - the row after the last one
+ */
+void DisplayScreen::invalidateRows(int firstRow, int lastRow)
+{
+    lastRow = qMin(lastRow, rows.size());
+
+    for (int r = firstRow; r < lastRow; r++)
+    {
+        rows[r].valid = false;
+    }
+}
+
+/**
+ * @brief   DisplayScreen::layoutRow - split a row into runs of cells shown the same way
+ * @param   row - the row
+ *
+ * @details A new run starts wherever the colour, the highlighting or whether the characters are shown changes.
+ *          The characters of a run are kept as one QGlyphRun, each glyph centred in its cell as drawText()
+ *          would centre it, so that the run is drawn with a single call however the font's advances differ
+ *          from the cell width.
+ *
+ *          Blinking characters are left out, as they are drawn by the blink layer. Runs with nothing to draw
+ *          are dropped. The colours are kept as Q3270 colours, so a change of colour
+ *          theme does not need the rows to be laid out again.
+ */
+void DisplayScreen::layoutRow(int row)
+{
+    QVector<TextRun> &runs = rows[row].runs;
+
+    runs.clear();
+
+    QVector<quint32> indexes;
+    QVector<QPointF> positions;
+
+    // Put the glyphs collected for the last run into it, or drop it if it has nothing to draw
+    auto finishRun = [&]() {
+        if (runs.isEmpty())
+        {
+            return;
+        }
+
+        TextRun &run = runs.last();
+
+        if (indexes.isEmpty() && run.singles.isEmpty() && run.highlight != Q3270::Reverse
+                && !(run.shown && run.highlight == Q3270::Underscore))
+        {
+            runs.removeLast();
+            return;
+        }
+
+        run.text.setRawFont(rawFont);
+        run.text.setGlyphIndexes(indexes);
+        run.text.setPositions(positions);
+
+        indexes.clear();
+        positions.clear();
+    };
+
+    int field = frontFields.fieldOf(row * screen_x);
+
+    for (int c = 0; c < screen_x; c++)
+    {
+        int pos = row * screen_x + c;
+
+        bool fieldStart = front.isFieldStart(pos);
+
+        if (fieldStart)
+        {
+            field = pos;
+        }
+
+        bool shown = (field < 0 || front.isDisplay(field)) && !fieldStart;
+        Q3270::Colour colour = front.getColour(pos, field);
+        Q3270::Highlight highlight = front.getHighlight(pos, field);
+
+        if (runs.isEmpty() || runs.last().colour != colour || runs.last().highlight != highlight
+                || runs.last().shown != shown)
+        {
+            finishRun();
+
+            TextRun run;
+
+            run.first = c;
+            run.count = 0;
+            run.colour = colour;
+            run.highlight = highlight;
+            run.shown = shown;
+
+            runs.append(run);
+        }
+
+        TextRun &run = runs.last();
+
+        run.count++;
+
+        uchar ebcdic = front.getEBCDIC(pos);
+
+        // Blinking characters are in the blink layer
+        if (!shown || ebcdic == IBM3270_CHAR_NULL || highlight == Q3270::Blink)
+        {
+            continue;
+        }
+
+        if (front.isGraphic(pos) || (ebcdic == IBM3270_CHAR_ZERO && fontTweak != Q3270::None))
+        {
+            run.singles.append(c);
+            continue;
+        }
+
+        QString ch = cp.getUnicodeChar(ebcdic);
+
+        quint32 glyph = 0;
+        int count = 1;
+
+        if (ch.size() != 1 || !rawFont.glyphIndexesForChars(ch.constData(), 1, &glyph, &count) || !glyph)
+        {
+            run.singles.append(c);
+            continue;
+        }
+
+        QPointF advance;
+
+        rawFont.advancesForGlyphIndexes(&glyph, &advance, 1);
+
+        indexes.append(glyph);
+        positions.append(QPointF(c * gridSize_X + (gridSize_X - advance.x()) / 2, baseline));
+    }
+
+    finishRun();
+
+    rows[row].valid = true;
+}
+
+/**
+ * @brief   DisplayScreen::paintText - paint cells as runs of text
+ * @param   p        - the painter
+ * @param   firstRow - the first row to paint
+ * @param   lastRow  - the row after the last one
+ * @param   firstCol - the first column to paint
+ * @param   lastCol  - the column after the last one
+ *
+ * @details Used by paint() when the glyph atlas is not. Each run laid out by layoutRow() that falls in the
+ *          columns to be painted is drawn with one fillRect() for a reverse video background, one
+ *          drawGlyphRun() for its characters and one line for an underscore. Rows that have changed since they
+ *          were last painted are laid out again first.
+ */
+void DisplayScreen::paintText(QPainter *p, int firstRow, int lastRow, int firstCol, int lastCol)
+{
+    const QColor black = palette->colour(Q3270::Black);
+
+    for (int r = firstRow; r < lastRow; r++)
+    {
+        if (!rows[r].valid)
+        {
+            layoutRow(r);
+        }
+
+        qreal top = r * gridSize_Y;
+
+        for (const TextRun &run : std::as_const(rows[r].runs))
+        {
+            if (run.first >= lastCol || run.first + run.count <= firstCol)
+            {
+                continue;
+            }
+
+            QRectF rect(run.first * gridSize_X, top, run.count * gridSize_X, gridSize_Y);
+
+            QColor fg = palette->colour(run.colour);
+
+            // reverse
+            if (run.highlight == Q3270::Reverse)
+            {
+                p->fillRect(rect, fg);
+                fg = black;
+            }
+
+            p->setPen(fg);
+
+            if (!run.text.glyphIndexes().isEmpty())
+            {
+                p->drawGlyphRun(QPointF(0, top), run.text);
+            }
+
+            for (int c : run.singles)
+            {
+                int pos = r * screen_x + c;
+
+                drawGlyph(p, QRectF(c * gridSize_X, top, gridSize_X, gridSize_Y), front.getEBCDIC(pos),
+                          front.isGraphic(pos), fg, false);
+            }
+
+            // underscore
+            if (run.shown && run.highlight == Q3270::Underscore)
+            {
+                p->setPen(fg);
+                p->drawLine(QPointF(rect.left(), rect.bottom() - 1), QPointF(rect.right(), rect.bottom() - 1));
+            }
+        }
+    }
+}
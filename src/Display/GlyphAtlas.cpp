@@ -0,0 +1,158 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <cmath>
+
+#include "GlyphAtlas.h"
+
+/**
+ * @brief   GlyphAtlas::GlyphAtlas - an empty atlas
+ * @param   cellWidth  - the width of a cell, unscaled
+ * @param   cellHeight - the height of a cell, unscaled
+ */
+GlyphAtlas::GlyphAtlas(qreal cellWidth, qreal cellHeight)
+    : cellWidth(cellWidth)
+    , cellHeight(cellHeight)
+    , sx(0)
+    , sy(0)
+    , stale(false)
+{
+    setScale(1, 1);
+}
+
+/**
+ * @brief   GlyphAtlas::clear - discard all the images
+ *
+ * @details Called when something that changes how the cells are drawn, such as the font, has changed.
+ */
+void GlyphAtlas::clear()
+{
+    slots.clear();
+
+    image = QImage();
+    atlas = QPixmap();
+    stale = false;
+}
+
+/**
+ * @brief   GlyphAtlas::setScale - set the scale the screen is painted at
+ * @param   sx - horizontal scale from the screen to the device
+ * @param   sy - vertical scale
+ *
+ * @details If the scale has changed, the images are discarded and are drawn again at the new scale as they
+ *          are needed.
+ */
+void GlyphAtlas::setScale(qreal sx, qreal sy)
+{
+    if (sx <= 0 || sy <= 0)
+    {
+        sx = 1;
+        sy = 1;
+    }
+
+    if (qFuzzyCompare(sx, this->sx) && qFuzzyCompare(sy, this->sy))
+    {
+        return;
+    }
+
+    this->sx = sx;
+    this->sy = sy;
+
+    slot = QSize(std::ceil(cellWidth * sx), std::ceil(cellHeight * sy));
+
+    clear();
+}
+
+/**
+ * @brief   GlyphAtlas::glyph - find the image for a key, drawing it if need be
+ * @param   key  - what the image shows
+ * @param   draw - draws the image, in cell coordinates from (0, 0), if the atlas does not have it
+ * @return  where the image is in the atlas
+ *
+ * @details The rectangle returned is the cell at the atlas scale, which may be a fraction of a pixel smaller
+ *          than the space the image has.
+ */
+QRectF GlyphAtlas::glyph(quint64 key, const std::function<void(QPainter *)> &draw)
+{
+    auto it = slots.constFind(key);
+
+    int n;
+
+    if (it != slots.cend())
+    {
+        n = it.value();
+    }
+    else
+    {
+        n = slots.size();
+
+        QPoint origin((n % Columns) * slot.width(), (n / Columns) * slot.height());
+
+        if (origin.y() + slot.height() > image.height())
+        {
+            grow();
+        }
+
+        QPainter p(&image);
+
+        p.setClipRect(QRect(origin, slot));
+        p.translate(origin);
+        p.scale(sx, sy);
+
+        draw(&p);
+
+        slots.insert(key, n);
+        stale = true;
+    }
+
+    return QRectF((n % Columns) * slot.width(), (n / Columns) * slot.height(), cellWidth * sx, cellHeight * sy);
+}
+
+/**
+ * @brief   GlyphAtlas::pixmap - the atlas
+ * @return  the images drawn so far
+ *
+ * @details Images drawn since the last call are copied to the pixmap first.
+ */
+const QPixmap &GlyphAtlas::pixmap()
+{
+    if (stale)
+    {
+        atlas = QPixmap::fromImage(image);
+        stale = false;
+    }
+
+    return atlas;
+}
+
+/**
+ * @brief   GlyphAtlas::grow - make room for more images
+ *
+ * @details The atlas starts with a few rows of images and doubles the number each time it is full, keeping
+ *          the images it has.
+ */
+void GlyphAtlas::grow()
+{
+    int rows = image.isNull() ? 4 : 2 * image.height() / slot.height();
+
+    QImage bigger(Columns * slot.width(), rows * slot.height(), QImage::Format_ARGB32_Premultiplied);
+
+    bigger.fill(Qt::transparent);
+
+    if (!image.isNull())
+    {
+        QPainter p(&bigger);
+
+        p.setCompositionMode(QPainter::CompositionMode_Source);
+        p.drawImage(0, 0, image);
+    }
+
+    image = bigger;
+}
@@ -0,0 +1,84 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <functional>
+
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+
+/**
+ * @brief   The GlyphAtlas class
+ *
+ * @details GlyphAtlas keeps the cells DisplayScreen has drawn as images in one pixmap, so that a cell seen
+ *          before is painted by copying its image rather than by laying out and rasterising its text again.
+ *
+ *          Each image is the size of a cell at the scale the screen is painted at, and is found by a key that
+ *          the caller builds from everything that changes how the cell looks. An image is drawn the first time
+ *          its key is asked for; the atlas grows as needed. Anything that changes how a key is drawn, such as
+ *          the font, must clear() the atlas.
+ *
+ *          At a scale where a cell is more than MaxSlotHeight pixels high, keeping the images would cost more
+ *          memory than it saves time, and isUsable() is false.
+ *
+ *          The atlas is a QPixmap, so it must only be used on the GUI thread.
+ */
+class GlyphAtlas
+{
+    public:
+
+        GlyphAtlas(qreal cellWidth, qreal cellHeight);
+
+        void clear();
+        void setScale(qreal sx, qreal sy);
+
+        QRectF glyph(quint64 key, const std::function<void(QPainter *)> &draw);
+        const QPixmap &pixmap();
+
+        // The scale the images are drawn at; painting an image at 1/scale gives a cell
+        qreal scaleX() const                        { return sx; }
+        qreal scaleY() const                        { return sy; }
+
+        int count() const                           { return slots.size(); }
+        bool isUsable() const                       { return slot.height() <= MaxSlotHeight; }
+
+    private:
+
+        // Images across the atlas
+        static constexpr int Columns = 32;
+
+        // Largest height of an image, in pixels
+        static constexpr int MaxSlotHeight = 128;
+
+        qreal cellWidth;
+        qreal cellHeight;
+
+        qreal sx;
+        qreal sy;
+
+        // Size of an image, in pixels
+        QSize slot;
+
+        // The images are drawn here, and copied to the pixmap when it is next asked for
+        QImage image;
+        QPixmap atlas;
+        bool stale;
+
+        // The image for each key
+        QHash<quint64, int> slots;
+
+        void grow();
+};
+
+#endif // GLYPHATLAS_H
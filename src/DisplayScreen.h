@@ -18,12 +18,19 @@
 #include <QtSvg>
 #include <QTimer>
 #include <QObject>
+#include <QGlyphRun>
+#include <QRawFont>
 
-#include "Cell.h"
+#include "PresentationSpace.h"
+#include "ScreenSnapshot.h"
 #include "CodePage.h"
+#include "FieldDirectory.h"
 #include "Q3270.h"
+#include "LatencyStats.h"
 #include "Models/Colours.h"
+#include "Display/BlinkLayer.h"
 #include "Display/ClickableSvgItem.h"
+#include "Display/GlyphAtlas.h"
 #include "Display/LockIndicator.h"
 
 class DisplayScreen : public QGraphicsObject
@@ -42,22 +49,28 @@ class DisplayScreen : public QGraphicsObject
         QRectF boundingRect() const override;
 
         void paint(QPainter *p, const QStyleOptionGraphicsItem *, QWidget *) override;
+        void paintBlinking(QPainter *p, const QRectF &exposed);
 
 
         int width() const;
         int height() const;
         qreal gridWidth() const;
         qreal gridHeight() const;
+        const CodePage &codePage() const;
 
         void setSize(const int x, const int y);
 
         void setChar(int pos, uchar c, bool fromKB);
+        void setChars(int pos, const uchar *text, int len);
+        void fillChars(int start, int end, uchar c, bool graphic);
+        void endWrite();
         void setCharAttr(unsigned char c, unsigned char d);
 
         void resetExtendedHilite(int pos);
         void resetExtended(int pos);
         void resetCharAttr();
         void resetColours();
+        void codePageChanged();
         void resetMDTs();
 
         void setExtendedColour(int pos, bool foreground, unsigned char c);
@@ -90,6 +103,12 @@ class DisplayScreen : public QGraphicsObject
         void clear();
         void setFont(const QFont &font);
         void setFontTweak(const Q3270::FontTweak f);
+        void setGlyphCache(bool on);
+        void setBackingImage(bool on);
+        QSizeF fitScale(const QSizeF &area, const QSize &viewport, qreal dpr, Qt::AspectRatioMode mode) const;
+        void setLatencyStats(LatencyStats *stats)   { latency = stats; }
+        int cellsPainted() const                    { return painted; }
+        bool isBlinking() const                     { return blinkCount > 0; }
 
         void toggleRuler();
         void setRuler();
@@ -106,10 +125,16 @@ class DisplayScreen : public QGraphicsObject
         void dumpDisplay();
         void dumpInfo();
 
+        ScreenSnapshotPtr takeSnapshot(const ScreenSnapshot *replacing = nullptr);
+        void applySnapshot(const ScreenSnapshot &snapshot);
+
     signals:
 
         void bufferReady(QByteArray &buffer);
+        void telnetCommand(uchar command);
         void cursorMoved(int x, int y);
+        void cursorClicked(int x, int y);
+        void blinkingChanged(bool blinking);
 
     public slots:
 
@@ -154,7 +179,15 @@ class DisplayScreen : public QGraphicsObject
 
         int cursor_pos;             /* Cursor position */
 
-        QVector<Cell> cells;        /* Screen slot */
+        PresentationSpace cells;    /* Screen slot */
+        FieldDirectory fields;      // Where the fields start
+
+        // The screen as last published, which is what is painted, and where its fields start
+        PresentationSpace front;
+        FieldDirectory frontFields;
+
+        // Blocks published since the last snapshot was taken
+        QVector<quint64> unsent;
 
         bool blinkShow;             /* Whether the character is shown/hidden for a given blink event */
         bool cursorShow;            /* Whether the cursor is shown/hidden for a given blink event */
@@ -176,7 +209,6 @@ class DisplayScreen : public QGraphicsObject
                 Q3270::Highlight highlight;
                 bool highlight_default;
 
-                QBrush colour;
                 Q3270::Colour colNum;
                 bool colour_default;
         } charAttr;
@@ -189,7 +221,10 @@ class DisplayScreen : public QGraphicsObject
         qreal gridSize_X;
         qreal gridSize_Y;
 
-        QRegion blinkCells;
+        // One bit per cell, set for each character that blinks on the screen as published, and the number set
+        QVector<quint64> blinking;
+        int blinkCount;
+
         QGraphicsRectItem *myRb;
         QPointF mouseStart;
 
@@ -202,12 +237,76 @@ class DisplayScreen : public QGraphicsObject
         QPoint slashEnd;
         int dotRadius;
 
+        // Images of the cells painted so far, and whether they are used
+        GlyphAtlas glyphs;
+        bool useGlyphs;
+
+        // A run of cells in a row that are shown the same way, drawn without the glyph atlas
+        struct TextRun
+        {
+            int first;                      // The first cell in the row, and the number of cells
+            int count;
+            Q3270::Colour colour;
+            Q3270::Highlight highlight;
+            bool shown;                     // False for field starts and the cells of hidden fields
+            QGlyphRun text;                 // The characters, each centred in its cell, relative to the row
+            QVector<int> singles;           // Cells drawn on their own: graphic characters, characters the
+                                            // font does not have, and zeros with a font tweak
+        };
+
+        // The runs for each row, and whether they are up to date with front
+        struct RowLayout
+        {
+            bool valid = false;
+            QVector<TextRun> runs;
+        };
+
+        QVector<RowLayout> rows;
+
+        // The font, and the baseline of the characters in a cell, for the glyph runs
+        QRawFont rawFont;
+        qreal baseline;
+
+        // The blinking characters, shown and hidden by blink()
+        BlinkLayer blinkLayer;
+
+        // The screen as painted, at the resolution of the device, and whether it is used
+        QImage backing;
+        QSizeF backingScale;
+        bool useBacking;
+
+        // Cells to be drawn again in the backing image, in cells
+        QRegion backingStale;
+
+        // Cells drawn by the last paint
+        int painted;
+
+        // Stamped at the end of each paint; not owned
+        LatencyStats *latency;
+
         int findField(int pos);
         int findNextField(int pos);
-        void applyCharAttributes(int pos, Cell *field);
+        void setFieldMDT(int pos);
+        void applyCharAttributes(int pos);
+        void writeCells(int pos, const uchar *text, int len, bool repeat, bool graphic);
+        void updateRange(int start, int len);
+        void publish();
+        void updateChanged(const QVector<quint64> &blocks);
+        bool updateBlink(int start, int len);
+        void updateBlinkLayer(bool wasBlinking);
         void updateFontMetrics();
-
-        int fieldCount;
+        void drawGlyph(QPainter *p, const QRectF &rect, uchar ebcdic, bool graphic, const QColor &fg, bool underscore) const;
+        bool useAtlas(QPainter *p);
+        QRectF atlasGlyph(uchar ebcdic, bool graphic, const QColor &fg, bool underscore);
+        void cellsIn(const QRectF &rect, int &firstRow, int &lastRow, int &firstCol, int &lastCol) const;
+        void paintCells(QPainter *p, int firstRow, int lastRow, int firstCol, int lastCol);
+        bool useBackingImage(QPainter *p) const;
+        void paintBacking(QPainter *p, const QRectF &exposed);
+        void invalidateBacking();
+        void paintGlyphs(QPainter *p, int firstRow, int lastRow, int firstCol, int lastCol);
+        void paintText(QPainter *p, int firstRow, int lastRow, int firstCol, int lastCol);
+        void layoutRow(int row);
+        void invalidateRows(int firstRow, int lastRow);
 };
 
 #endif // DISPLAYSCREEN_H
@@ -0,0 +1,228 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <algorithm>
+
+#include <QtAlgorithms>
+
+#include "FieldDirectory.h"
+
+/**
+ * @brief   FieldDirectory::FieldDirectory - an empty directory
+ *
+ * @details resize() must be called with the size of the screen before fields are added.
+ */
+FieldDirectory::FieldDirectory()
+{
+}
+
+/**
+ * @brief   FieldDirectory::resize - set the number of cells on the screen
+ * @param   cells - the number of cells
+ *
+ * @details Any fields are discarded.
+ */
+void FieldDirectory::resize(int cells)
+{
+    starts.clear();
+    unprotectedBits.fill(0, (cells + 63) / 64);
+}
+
+/**
+ * @brief   FieldDirectory::clear - discard all fields
+ */
+void FieldDirectory::clear()
+{
+    starts.clear();
+    unprotectedBits.fill(0);
+}
+
+/**
+ * @brief   FieldDirectory::add - record a field start
+ * @param   pos         - the field start position
+ * @param   unprotected - whether the field is unprotected
+ *
+ * @details If there is already a field at pos, only its protection is updated.
+ */
+void FieldDirectory::add(int pos, bool unprotected)
+{
+    auto it = std::lower_bound(starts.begin(), starts.end(), pos);
+
+    if (it == starts.end() || *it != pos)
+    {
+        starts.insert(it, pos);
+    }
+
+    setUnprotected(pos, unprotected);
+}
+
+/**
+ * @brief   FieldDirectory::remove - forget a field start
+ * @param   pos - the field start position
+ *
+ * @details Called when a field start is overwritten; the cells that were in the field become part of the
+ *          field before it.
+ */
+void FieldDirectory::remove(int pos)
+{
+    auto it = std::lower_bound(starts.begin(), starts.end(), pos);
+
+    if (it != starts.end() && *it == pos)
+    {
+        starts.erase(it);
+    }
+
+    setUnprotected(pos, false);
+}
+
+/**
+ * @brief   FieldDirectory::setUnprotected - change the protection of a field
+ * @param   pos         - the field start position
+ * @param   unprotected - whether the field is unprotected
+ */
+void FieldDirectory::setUnprotected(int pos, bool unprotected)
+{
+    quint64 bit = Q_UINT64_C(1) << (pos & 63);
+
+    if (unprotected)
+    {
+        unprotectedBits[pos >> 6] |= bit;
+    }
+    else
+    {
+        unprotectedBits[pos >> 6] &= ~bit;
+    }
+}
+
+/**
+ * @brief   FieldDirectory::contains - is there a field start at a position
+ * @param   pos - screen position
+ * @return  true if a field starts at pos
+ */
+bool FieldDirectory::contains(int pos) const
+{
+    return std::binary_search(starts.cbegin(), starts.cend(), pos);
+}
+
+/**
+ * @brief   FieldDirectory::fieldOf - find the field that contains a cell
+ * @param   pos - screen position
+ * @return  the field start at or before pos, wrapping to the last field on the screen, or -1 if there are
+ *          no fields
+ */
+int FieldDirectory::fieldOf(int pos) const
+{
+    if (starts.isEmpty())
+    {
+        return -1;
+    }
+
+    auto it = std::upper_bound(starts.cbegin(), starts.cend(), pos);
+
+    if (it == starts.cbegin())
+    {
+        return starts.last();
+    }
+
+    return *(it - 1);
+}
+
+/**
+ * @brief   FieldDirectory::next - find the next field start
+ * @param   pos - screen position
+ * @return  the first field start after pos, wrapping to the first field on the screen, or -1 if there are
+ *          no fields
+ *
+ * @details If pos is the only field start, pos is returned.
+ */
+int FieldDirectory::next(int pos) const
+{
+    if (starts.isEmpty())
+    {
+        return -1;
+    }
+
+    auto it = std::upper_bound(starts.cbegin(), starts.cend(), pos);
+
+    if (it == starts.cend())
+    {
+        return starts.first();
+    }
+
+    return *it;
+}
+
+/**
+ * @brief   FieldDirectory::nextUnprotected - find the next unprotected field start
+ * @param   pos - screen position
+ * @return  the first unprotected field start at or after pos, wrapping to the start of the screen, or -1 if
+ *          there are no unprotected fields
+ */
+int FieldDirectory::nextUnprotected(int pos) const
+{
+    int words = unprotectedBits.size();
+
+    if (!words)
+    {
+        return -1;
+    }
+
+    int w = pos >> 6;
+
+    // Ignore the bits before pos in the first word; they are looked at last, after wrapping
+    quint64 bits = unprotectedBits[w] & (~Q_UINT64_C(0) << (pos & 63));
+
+    for (int i = 0; i <= words; i++)
+    {
+        if (bits)
+        {
+            return (w << 6) + qCountTrailingZeroBits(bits);
+        }
+
+        w = w + 1 < words ? w + 1 : 0;
+        bits = unprotectedBits[w];
+    }
+
+    return -1;
+}
+
+/**
+ * @brief   FieldDirectory::prevUnprotected - find the previous unprotected field start
+ * @param   pos - screen position
+ * @return  the last unprotected field start at or before pos, wrapping to the end of the screen, or -1 if
+ *          there are no unprotected fields
+ */
+int FieldDirectory::prevUnprotected(int pos) const
+{
+    int words = unprotectedBits.size();
+
+    if (!words)
+    {
+        return -1;
+    }
+
+    int w = pos >> 6;
+
+    // Ignore the bits after pos in the first word; they are looked at last, after wrapping
+    quint64 bits = unprotectedBits[w] & (~Q_UINT64_C(0) >> (63 - (pos & 63)));
+
+    for (int i = 0; i <= words; i++)
+    {
+        if (bits)
+        {
+            return (w << 6) + 63 - qCountLeadingZeroBits(bits);
+        }
+
+        w = w > 0 ? w - 1 : words - 1;
+        bits = unprotectedBits[w];
+    }
+
+    return -1;
+}
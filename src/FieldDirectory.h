@@ -0,0 +1,61 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef FIELDDIRECTORY_H
+#define FIELDDIRECTORY_H
+
+#include <QList>
+#include <QVector>
+
+/**
+ * @brief   The FieldDirectory class
+ *
+ * @details FieldDirectory records where the fields on a 3270 display start, so that DisplayScreen can find the
+ *          field that holds a cell without each cell carrying a pointer to it. The field start positions are
+ *          kept in a sorted list, searched by bisection, and the unprotected ones are also marked in a bitmap
+ *          that is scanned a 64-bit word at a time.
+ *
+ *          All searches wrap from the end of the screen to the start, as the fields on a 3270 display do.
+ *          A search that finds nothing returns -1.
+ */
+class FieldDirectory
+{
+    public:
+
+        FieldDirectory();
+
+        void resize(int cells);
+        void clear();
+
+        void add(int pos, bool unprotected);
+        void remove(int pos);
+        void setUnprotected(int pos, bool unprotected);
+
+        int count() const                           { return starts.size(); }
+        bool isEmpty() const                        { return starts.isEmpty(); }
+        bool contains(int pos) const;
+
+        int fieldOf(int pos) const;
+        int next(int pos) const;
+        int nextUnprotected(int pos) const;
+        int prevUnprotected(int pos) const;
+
+        const QList<int> &positions() const         { return starts; }
+
+    private:
+
+        // Field start positions, in ascending order
+        QList<int> starts;
+
+        // One bit per cell, set for the start of each unprotected field
+        QVector<quint64> unprotectedBits;
+};
+
+#endif // FIELDDIRECTORY_H
@@ -10,8 +10,8 @@
 
 #include "Keyboard.h"
 #include <QDebug>
-#include <QDateTime>
 #include "Q3270.h"
+#include "Trace.h"
 
 
 /**
@@ -174,7 +174,7 @@ void Keyboard::clearBufferEntry()
  */
 void Keyboard::lockKeyboard()
 {
-    qDebug() << QDateTime::currentMSecsSinceEpoch() << "Keyboard        : setEnterInhibit";
+    TRACE(keyboard) << "setEnterInhibit";
     systemLock = true;
     emit setEnterInhibit();
 }
@@ -202,7 +202,7 @@ bool Keyboard::eventFilter( QObject *dist, QEvent *event )
 
     QKeyEvent *keyEvent = static_cast<QKeyEvent *>(event);
 
-    qDebug() << "Keyboard        : Type:" << (keyEvent->type() == QEvent::KeyPress ? "Press" : "Release") <<
+    TRACE(keyboard) << "Type:" << (keyEvent->type() == QEvent::KeyPress ? "Press" : "Release") <<
                 " Count:" << keyEvent->count() <<
                 " Key:" << keyEvent->key() <<
                 " Native:" << keyEvent->nativeScanCode() <<
@@ -226,20 +226,20 @@ bool Keyboard::eventFilter( QObject *dist, QEvent *event )
         waitRelease = needtoWait(keyEvent);
         if (!waitRelease)
         {
-            qDebug() << "Keyboard        : Processing Key - No need to wait";
+            TRACE(keyboard) << "Processing Key - No need to wait";
             keyUsed = processKey();
         }
 
     }
     else if (waitRelease)
     {
-        qDebug() << "Keyboard        : Processing key - KeyRelease";
+        TRACE(keyboard) << "Processing key - KeyRelease";
         waitRelease = false;
         keyUsed = processKey();
     }
     else
     {
-        qDebug() << "Keyboard        : Ignoring KeyRelease (already processed press)";
+        TRACE(keyboard) << "Ignoring KeyRelease (already processed press)";
     }
 
     if (keyUsed)
@@ -278,7 +278,7 @@ bool Keyboard::processKey()
 {
     int key = kbBuffer[bufferEnd].key;
 
-    qDebug() << "processKey: looking up key" << Qt::hex << kbBuffer[bufferEnd].key << "in map";
+    TRACE(keyboard) << "processKey: looking up key" << Qt::hex << kbBuffer[bufferEnd].key << "in map";
 
     kbBuffer[bufferEnd].isMapped = kbBuffer[bufferEnd].map->contains(key);
 
@@ -292,11 +292,11 @@ bool Keyboard::processKey()
         }
         key = kbBuffer[bufferEnd].nativeKey;
         kbBuffer[bufferEnd].isMapped = kbBuffer[bufferEnd].map->contains(key);
-        qDebug() << "Keyboard        : Modifier key is mapped: " << kbBuffer[bufferEnd].isMapped;
+        TRACE(keyboard) << "Modifier key is mapped: " << kbBuffer[bufferEnd].isMapped;
     }
 
     keyCount++;
-    qDebug() << "Keyboard        : Keycount incremented. Key:" << kbBuffer[bufferEnd].key << "isMapped:" << kbBuffer[bufferEnd].isMapped << "mustMap:" << kbBuffer[bufferEnd].mustMap;
+    TRACE(keyboard) << "Keycount incremented. Key:" << kbBuffer[bufferEnd].key << "isMapped:" << kbBuffer[bufferEnd].isMapped << "mustMap:" << kbBuffer[bufferEnd].mustMap;
 
     if ((kbBuffer[bufferEnd].key != 0  || kbBuffer[bufferEnd].isMapped) && connectedState)
     {
@@ -319,17 +319,17 @@ bool Keyboard::processKey()
         {
             if (kbBuffer[bufferEnd].mustMap && kbBuffer[bufferEnd].isMapped)
             {
-                qDebug() << "Keyboard        : Processing nextKey (mapped and mustMap set)";
+                TRACE(keyboard) << "Processing nextKey (mapped and mustMap set)";
                 nextKey();
             }
             else if (!kbBuffer[bufferEnd].mustMap)
             {
-                qDebug() << "Keyboard        : Processing nextKey (not mapped, and mustMap not set)";
+                TRACE(keyboard) << "Processing nextKey (not mapped, and mustMap not set)";
                 nextKey();
             }
             else
             {
-                qDebug() << "Keyboard        : Ignoring key";
+                TRACE(keyboard) << "Ignoring key";
                 keyCount--;
                 clearBufferEntry();
                 return false;
@@ -337,7 +337,7 @@ bool Keyboard::processKey()
         }
         else
         {
-            qDebug() << "Keyboard        : Locked, cannot process, buffering";
+            TRACE(keyboard) << "Locked, cannot process, buffering";
 
             bufferEnd++;
 
@@ -349,7 +349,7 @@ bool Keyboard::processKey()
         }
     } else
     {
-        qDebug() << "Keyboard        : Ignoring key";
+        TRACE(keyboard) << "Ignoring key";
         keyCount--;
         clearBufferEntry();
         return false;
@@ -388,7 +388,7 @@ bool Keyboard::needtoWait(QKeyEvent *event)
             //            printf("Keyboard        : Storing modifiers %8.8x\n", event->modifiers());
             kbBuffer[bufferEnd].modifiers = event->modifiers();
             kbBuffer[bufferEnd].nativeKey = event->nativeVirtualKey();
-            qDebug() << "Keyboard        : Need to wait";
+            TRACE(keyboard) << "Need to wait";
             wait = true;
             break;
         default:
@@ -405,31 +405,31 @@ bool Keyboard::needtoWait(QKeyEvent *event)
     switch(kbBuffer[bufferEnd].modifiers)
     {
         case Q3270_CTRL_MOD:
-            qDebug() << "Keyboard        : Switching to CTRL map";
+            TRACE(keyboard) << "Switching to CTRL map";
             kbBuffer[bufferEnd].map = &ctrlMap;
             kbBuffer[bufferEnd].mustMap = true;
             break;
 
         case Q3270_META_MOD:
-            qDebug() << "Keyboard        : Switching to META map";
+            TRACE(keyboard) << "Switching to META map";
             kbBuffer[bufferEnd].map = &metaMap;
             kbBuffer[bufferEnd].mustMap = true;
             break;
 
         case Qt::AltModifier:
-            qDebug() << "Keyboard        : Switching to ALT map";
+            TRACE(keyboard) << "Switching to ALT map";
             kbBuffer[bufferEnd].map = &altMap;
             kbBuffer[bufferEnd].mustMap = true;
             break;
 
         case Qt::ShiftModifier:
-            qDebug() << "Keyboard        : Switching to SHIFT map";
+            TRACE(keyboard) << "Switching to SHIFT map";
             kbBuffer[bufferEnd].map = &shiftMap;
             kbBuffer[bufferEnd].mustMap = false;
             break;
 
         default:
-            qDebug() << "Keyboard        : Switching to default map";
+            TRACE(keyboard) << "Switching to default map";
             kbBuffer[bufferEnd].mustMap = false;
             kbBuffer[bufferEnd].map = &defaultMap;
             break;
@@ -455,7 +455,7 @@ void Keyboard::nextKey()
 {
     if (keyCount > 0)
     {
-        qDebug() << "Keyboard        : Keycount now" << keyCount << "(buffer pos" << bufferPos << ", buffer end" << bufferEnd;
+        TRACE(keyboard) << "Keycount now" << keyCount << "(buffer pos" << bufferPos << ", buffer end" << bufferEnd;
         keyCount--;
         if (kbBuffer[bufferPos].isMapped)
         {
@@ -476,7 +476,7 @@ void Keyboard::nextKey()
             }
             if (!systemLock && keyCount > 0)
             {
-                qDebug() << "Keyboard        : processing next key (more stored)";
+                TRACE(keyboard) << "processing next key (more stored)";
                 nextKey();
             }
         }
@@ -888,7 +888,7 @@ void Keyboard::attn()
     insMode = false;
     emit setInsert(false);
 
-    qDebug() << "Keyboard        : ATTN pressed";
+    TRACE(keyboard) << "ATTN pressed";
 }
 
 /**
@@ -1131,12 +1131,12 @@ void Keyboard::setMapping(QString key, QString function)
 
     if (!functionMap.contains(function))
     {
-        qDebug() << "Keyboard        : ERROR: Function" << function.toLatin1().data() << "unknown - ignored";
+        TRACE_WARN(keyboard) << "Function" << function.toLatin1().data() << "unknown - ignored";
     }
 
     setMap->insert(keyCode, { functionMap.value(function), key, function });
 
-    qDebug() << "setMapping: storing keyCode" << Qt::hex << keyCode << "in map for function" << function;
+    TRACE(keyboard) << "setMapping: storing keyCode" << Qt::hex << keyCode << "in map for function" << function;
 
 }
 
@@ -0,0 +1,388 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <chrono>
+#include <cstring>
+
+#include <QFile>
+#include <QtAlgorithms>
+
+#include "LatencyStats.h"
+
+/**
+ * @brief   LatencyHistogram::LatencyHistogram - an empty histogram
+ */
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+/**
+ * @brief   LatencyHistogram::reset - discard all values
+ */
+void LatencyHistogram::reset()
+{
+    memset(counts, 0, sizeof(counts));
+
+    total = 0;
+    minimum = 0;
+    maximum = 0;
+}
+
+/**
+ * @brief   LatencyHistogram::bucket - the bucket a value is counted in
+ * @param   ns - the value
+ * @return  the bucket index
+ *
+ * @details Values below 32 have a bucket each. Above that, the top bit of the value selects a group of 32
+ *          buckets and the next five bits select the bucket within it.
+ */
+int LatencyHistogram::bucket(qint64 ns)
+{
+    if (ns < SubBuckets)
+    {
+        return ns < 0 ? 0 : (int) ns;
+    }
+
+    int magnitude = 63 - qCountLeadingZeroBits((quint64) ns);
+
+    if (magnitude > MaxMagnitude)
+    {
+        return Buckets - 1;
+    }
+
+    int shift = magnitude - 5;
+
+    return (magnitude - 4) * SubBuckets + (int) ((ns >> shift) & (SubBuckets - 1));
+}
+
+/**
+ * @brief   LatencyHistogram::bucketLimit - the largest value counted in a bucket
+ * @param   bucket - the bucket index
+ * @return  the value
+ */
+qint64 LatencyHistogram::bucketLimit(int bucket)
+{
+    if (bucket < 2 * SubBuckets)
+    {
+        return bucket;
+    }
+
+    int shift = bucket / SubBuckets - 1;
+    qint64 top = SubBuckets + bucket % SubBuckets;
+
+    return ((top + 1) << shift) - 1;
+}
+
+/**
+ * @brief   LatencyHistogram::record - count a value
+ * @param   ns - the value, in nanoseconds
+ */
+void LatencyHistogram::record(qint64 ns)
+{
+    if (ns < 0)
+    {
+        ns = 0;
+    }
+
+    counts[bucket(ns)]++;
+
+    if (!total || ns < minimum)
+    {
+        minimum = ns;
+    }
+
+    if (ns > maximum)
+    {
+        maximum = ns;
+    }
+
+    total++;
+}
+
+/**
+ * @brief   LatencyHistogram::percentile - the value below which a given proportion of values fall
+ * @param   p - the proportion, from 0 to 1
+ * @return  the value, to the precision of the buckets
+ */
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if (!total)
+    {
+        return 0;
+    }
+
+    quint64 wanted = qMax((quint64) 1, (quint64) (p * total + 0.5));
+    quint64 seen = 0;
+
+    for (int i = 0; i < Buckets; i++)
+    {
+        seen += counts[i];
+
+        if (seen >= wanted)
+        {
+            return qBound(minimum, bucketLimit(i), maximum);
+        }
+    }
+
+    return maximum;
+}
+
+/**
+ * @brief   LatencyHistogram::writeBuckets - write the non-empty buckets as CSV
+ * @param   out  - the stream
+ * @param   name - the name written in the first column
+ */
+void LatencyHistogram::writeBuckets(QTextStream &out, const QString &name) const
+{
+    for (int i = 0; i < Buckets; i++)
+    {
+        if (counts[i])
+        {
+            out << name << "," << bucketLimit(i) / 1000.0 << "," << counts[i] << "\n";
+        }
+    }
+}
+
+/**
+ * @brief   LatencyStats::LatencyStats - latency measurements for a session
+ */
+LatencyStats::LatencyStats() : responsePending(0), paintPending(false), publishedUpTo(0)
+{
+}
+
+/**
+ * @brief   LatencyStats::now - the clock used for the stamps
+ * @return  nanoseconds from an arbitrary starting point
+ */
+qint64 LatencyStats::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief   LatencyStats::reset - discard all measurements
+ *
+ * @details Called when a session starts.
+ */
+void LatencyStats::reset()
+{
+    QMutexLocker locker(&lock);
+
+    for (LatencyHistogram &h : histograms)
+    {
+        h.reset();
+    }
+
+    responsePending = 0;
+    unpublished.clear();
+    unpainted.clear();
+    paintPending = false;
+    publishedUpTo = 0;
+}
+
+/**
+ * @brief   LatencyStats::responseSent - an outbound record has been written
+ * @param   when - the time it was written
+ *
+ * @details The host response time is measured from the last record written before the reply.
+ */
+void LatencyStats::responseSent(qint64 when)
+{
+    QMutexLocker locker(&lock);
+
+    responsePending = when;
+}
+
+/**
+ * @brief   LatencyStats::recordProcessed - an inbound record has been processed
+ * @param   stamps - the times the record passed each stage
+ *
+ * @details If the screen has already been published with the record on it, the record waits for the next paint
+ *          to be completed; otherwise it waits for published() first. At most MaxUnpainted records wait at each
+ *          step; if more arrive, the oldest are dropped and their local and paint times are not recorded.
+ */
+void LatencyStats::recordProcessed(const Stamps &stamps)
+{
+    QMutexLocker locker(&lock);
+
+    if (responsePending)
+    {
+        histograms[HostResponse].record(stamps.read - responsePending);
+        responsePending = 0;
+    }
+
+    histograms[Receive].record(stamps.eor - stamps.read);
+    histograms[Process].record(stamps.processEnd - stamps.processStart);
+
+    // Without a session thread, the record is published by the end of processStream
+    if (stamps.processStart <= publishedUpTo)
+    {
+        keep(unpainted, stamps);
+        paintPending = true;
+    }
+    else
+    {
+        keep(unpublished, stamps);
+    }
+}
+
+/**
+ * @brief   LatencyStats::published - the screen that is painted has been brought up to date
+ * @param   upTo - the time the screen was taken from the record being processed; records started before this
+ *                 are on it
+ *
+ * @details Called by the DisplayScreen that is shown. Without a session thread, that is at the end of each
+ *          write, while the record is being processed; with one, it is when Terminal applies a snapshot, with
+ *          the time the snapshot was taken. The records now shown are completed by the next paint.
+ */
+void LatencyStats::published(qint64 upTo)
+{
+    QMutexLocker locker(&lock);
+
+    publishedUpTo = qMax(publishedUpTo, upTo);
+
+    // The records are in the order they were processed
+    while (!unpublished.isEmpty() && unpublished.first().processStart <= publishedUpTo)
+    {
+        keep(unpainted, unpublished.takeFirst());
+    }
+
+    if (!unpainted.isEmpty())
+    {
+        paintPending = true;
+    }
+}
+
+/**
+ * @brief   LatencyStats::keep - add a record to those waiting
+ * @param   list    - the records waiting
+ * @param   stamps  - the record
+ *
+ * @details With nothing publishing or painting, such as a minimised window, only the latest MaxUnpainted
+ *          records are kept.
+ */
+void LatencyStats::keep(QList<Stamps> &list, const Stamps &stamps)
+{
+    if (list.size() >= MaxUnpainted)
+    {
+        list.removeFirst();
+    }
+
+    list.append(stamps);
+}
+
+/**
+ * @brief   LatencyStats::painted - the screen has been painted
+ * @param   when - the time the paint finished
+ *
+ * @details Completes every record published since the last paint.
+ */
+void LatencyStats::painted(qint64 when)
+{
+    if (!paintPending)
+    {
+        return;
+    }
+
+    QMutexLocker locker(&lock);
+
+    for (const Stamps &s : std::as_const(unpainted))
+    {
+        histograms[Paint].record(when - s.processEnd);
+        histograms[Local].record(when - s.read);
+    }
+
+    unpainted.clear();
+    paintPending = false;
+}
+
+/**
+ * @brief   LatencyStats::histogram - a copy of one of the histograms
+ * @param   m - the measure
+ * @return  the histogram
+ */
+LatencyHistogram LatencyStats::histogram(Measure m) const
+{
+    QMutexLocker locker(&lock);
+
+    return histograms[m];
+}
+
+/**
+ * @brief   LatencyStats::measureName - a description of a measure
+ * @param   m - the measure
+ * @return  the description
+ */
+QString LatencyStats::measureName(Measure m)
+{
+    switch (m)
+    {
+        case HostResponse:
+            return "Host response";
+        case Local:
+            return "Local total";
+        case Receive:
+            return "Receive";
+        case Process:
+            return "Process";
+        case Paint:
+            return "Paint";
+        default:
+            return "";
+    }
+}
+
+/**
+ * @brief   LatencyStats::writeCsv - export the measurements
+ * @param   fileName - the file to write
+ * @return  false if the file can't be written
+ *
+ * @details The file has a summary line for each measure, followed by the count in each non-empty bucket.
+ *          Times are in microseconds.
+ */
+bool LatencyStats::writeCsv(const QString &fileName) const
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        return false;
+    }
+
+    QTextStream out(&file);
+
+    LatencyHistogram copies[MeasureCount];
+
+    for (int m = 0; m < MeasureCount; m++)
+    {
+        copies[m] = histogram((Measure) m);
+    }
+
+    out << "measure,count,min_us,p50_us,p90_us,p99_us,p999_us,max_us\n";
+
+    for (int m = 0; m < MeasureCount; m++)
+    {
+        const LatencyHistogram &h = copies[m];
+
+        out << measureName((Measure) m) << "," << h.count() << "," << h.min() / 1000.0 << ","
+            << h.percentile(0.5) / 1000.0 << "," << h.percentile(0.9) / 1000.0 << ","
+            << h.percentile(0.99) / 1000.0 << "," << h.percentile(0.999) / 1000.0 << "," << h.max() / 1000.0 << "\n";
+    }
+
+    out << "\nmeasure,bucket_limit_us,count\n";
+
+    for (int m = 0; m < MeasureCount; m++)
+    {
+        copies[m].writeBuckets(out, measureName((Measure) m));
+    }
+
+    return true;
+}
@@ -0,0 +1,140 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <atomic>
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QTextStream>
+
+/**
+ * @brief   The LatencyHistogram class
+ *
+ * @details LatencyHistogram counts durations in nanoseconds in log-linear buckets, in the manner of an HDR
+ *          histogram: each power of two is split into 32 buckets, so any value is recorded to within about
+ *          3%, from 1ns to around 18 minutes, in a fixed amount of memory and without allocating.
+ */
+class LatencyHistogram
+{
+    public:
+
+        static constexpr int SubBuckets = 32;
+        static constexpr int MaxMagnitude = 40;
+        static constexpr int Buckets = (MaxMagnitude - 3) * SubBuckets;
+
+        LatencyHistogram();
+
+        void record(qint64 ns);
+        void reset();
+
+        quint64 count() const                       { return total; }
+        qint64 min() const                          { return total ? minimum : 0; }
+        qint64 max() const                          { return maximum; }
+
+        qint64 percentile(double p) const;
+
+        void writeBuckets(QTextStream &out, const QString &name) const;
+
+    private:
+
+        quint64 counts[Buckets];
+        quint64 total;
+
+        qint64 minimum;
+        qint64 maximum;
+
+        static int bucket(qint64 ns);
+        static qint64 bucketLimit(int bucket);
+};
+
+/**
+ * @brief   The LatencyStats class
+ *
+ * @details LatencyStats follows each inbound record through Q3270 and keeps a histogram of each stage, so that
+ *          a slow session can be put down to the host or to the emulator. A record is stamped when the
+ *          socket read that brought its first bytes completes, when its EOR is found, at the start and end of
+ *          ProcessDataStream::processStream, and at the end of the first DisplayScreen::paint after the screen
+ *          that shows it has been published.
+ *
+ *          With a session thread, the record is processed on the worker's model and shown once Terminal applies
+ *          a snapshot taken after it; a paint before that, such as the cursor blinking, does not complete it.
+ *
+ *          The host response time runs from an outbound record being written until the first bytes of the
+ *          next inbound record are read. The local time runs from the read until the record is painted.
+ *
+ *          The stamps are made by SocketConnection, which may be on the session thread, and DisplayScreen, on
+ *          the GUI thread, so updates are serialised with a mutex. A paint with nothing waiting costs one
+ *          atomic load.
+ */
+class LatencyStats
+{
+    public:
+
+        enum Measure
+        {
+            HostResponse,       // Outbound record written to first read of the reply
+            Local,              // Read to paint
+            Receive,            // Read to EOR
+            Process,            // processStream
+            Paint,              // End of processStream to the end of the paint
+            MeasureCount
+        };
+
+        struct Stamps
+        {
+            qint64 read;
+            qint64 eor;
+            qint64 processStart;
+            qint64 processEnd;
+        };
+
+        LatencyStats();
+
+        static qint64 now();
+
+        void responseSent(qint64 when);
+        void recordProcessed(const Stamps &stamps);
+        void published(qint64 upTo);
+        void painted(qint64 when);
+
+        void reset();
+
+        LatencyHistogram histogram(Measure m) const;
+        static QString measureName(Measure m);
+
+        bool writeCsv(const QString &fileName) const;
+
+    private:
+
+        mutable QMutex lock;
+
+        LatencyHistogram histograms[MeasureCount];
+
+        // When the last outbound record was written, until the reply arrives
+        qint64 responsePending;
+
+        // Records processed but not yet published or painted, and the most of each that are kept
+        static constexpr int MaxUnpainted = 1024;
+
+        QList<Stamps> unpublished;
+        QList<Stamps> unpainted;
+        std::atomic<bool> paintPending;
+
+        // Records processed from before this time are on the published screen
+        qint64 publishedUpTo;
+
+        static void keep(QList<Stamps> &list, const Stamps &stamps);
+};
+
+#endif // LATENCYSTATS_H
@@ -61,6 +61,14 @@ PreferencesDialog::PreferencesDialog(CodePage &codepages, ActiveSettings &active
 
     connect(ui->FontWidgetBox, &FontWidget::fontChanged, this, &PreferencesDialog::changeFont);
     connect(ui->fontTweak, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PreferencesDialog::changeFontTweak);
+
+    // A dynamic screen can be no larger than 14 bit buffer addresses can reach
+    connect(ui->terminalCols, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int cols) {
+        ui->terminalRows->setMaximum(Q3270_MAX_CELLS / qMax(cols, 1));
+    });
+    connect(ui->terminalRows, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int rows) {
+        ui->terminalCols->setMaximum(Q3270_MAX_CELLS / qMax(rows, 1));
+    });
 }
 
 /**
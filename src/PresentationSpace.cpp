@@ -0,0 +1,360 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <cstring>
+
+#include <QtAlgorithms>
+
+#include "PresentationSpace.h"
+
+/**
+ * @brief   forEachBlock - call a function for each block with its bit set
+ * @param   blocks - one bit per block
+ * @param   cells  - the number of cells; the last block may be short
+ * @param   f      - called with the first cell of the block and its number of cells
+ */
+template <typename F>
+static void forEachBlock(const QVector<quint64> &blocks, int cells, F f)
+{
+    for (int w = 0; w < blocks.size(); w++)
+    {
+        for (quint64 bits = blocks[w]; bits; bits &= bits - 1)
+        {
+            int start = ((w << 6) + qCountTrailingZeroBits(bits)) * PresentationSpace::BlockSize;
+
+            if (start >= cells)
+            {
+                return;
+            }
+
+            f(start, qMin(PresentationSpace::BlockSize, cells - start));
+        }
+    }
+}
+
+/**
+ * @brief   PresentationSpace::PresentationSpace - an empty presentation space
+ *
+ * @details resize() sets the number of cells.
+ */
+PresentationSpace::PresentationSpace()
+{
+}
+
+/**
+ * @brief   PresentationSpace::resize - set the number of cells
+ * @param   cells - the number of cells
+ *
+ * @details Every cell is reset, and so counts as changed.
+ */
+void PresentationSpace::resize(int cells)
+{
+    chars.fill(IBM3270_CHAR_NULL, cells);
+    attrs.fill(DefaultAttrs, cells);
+    changed.fill(~Q_UINT64_C(0), (cells + BlockSize * 64 - 1) / (BlockSize * 64));
+}
+
+/**
+ * @brief   PresentationSpace::reset - reset a cell to default values
+ * @param   pos - screen position
+ *
+ * @details The cell is set to a null, with no field, highlighting or character attributes, in the
+ *          unprotected normal colour.
+ */
+void PresentationSpace::reset(int pos)
+{
+    touch(pos);
+    chars[pos] = IBM3270_CHAR_NULL;
+    attrs[pos] = DefaultAttrs;
+}
+
+/**
+ * @brief   PresentationSpace::resetAll - reset every cell
+ *
+ * @details Called at power on, and by a Clear or EW(A).
+ */
+void PresentationSpace::resetAll()
+{
+    chars.fill(IBM3270_CHAR_NULL);
+    attrs.fill(DefaultAttrs);
+    changed.fill(~Q_UINT64_C(0));
+}
+
+/**
+ * @brief   PresentationSpace::setFieldStart - set whether a cell is the start of a field
+ * @param   pos - screen position
+ * @param   fs  - true for a field start, false for a normal character
+ *
+ * @details setFieldStart() is called when the incoming data stream contains a SF or SFE order; it is also
+ *          called when the cell used to be a field start, but that has now been overwritten.
+ *
+ *          Setting the cell to a Field Start causes underscore, reverse and blinking to be switched off and,
+ *          for a basic field, the colour to be chosen from the protection and intensity.
+ */
+void PresentationSpace::setFieldStart(int pos, bool fs)
+{
+    setFlag(pos, FieldStart, fs);
+
+    if (fs)
+    {
+        setHighlight(pos, Q3270::NoHighlight);
+
+        if (!isExtended(pos))
+        {
+            bool prot = isProtected(pos);
+            bool intensify = isIntensify(pos);
+
+            if (prot && !intensify)
+            {
+                setColour(pos, Q3270::ProtectedNormal);
+            }
+            else if (prot && intensify)
+            {
+                setColour(pos, Q3270::ProtectedIntensified);
+            }
+            else if (!prot && !intensify)
+            {
+                setColour(pos, Q3270::UnprotectedNormal);
+            }
+            else
+            {
+                setColour(pos, Q3270::UnprotectedIntensified);
+            }
+        }
+    }
+}
+
+/**
+ * @brief   PresentationSpace::copy - copy the character and its attributes from one cell to another
+ * @param   to   - the destination position
+ * @param   from - the source position
+ *
+ * @details When moving characters around on the screen through the keyboard (ie, through insert or delete
+ *          actions), character attributes move with the character. The field attributes of the destination
+ *          are left alone.
+ */
+void PresentationSpace::copy(int to, int from)
+{
+    const quint32 moved = Graphic | CharAttrMask | HighlightMask | ColourMask;
+
+    touch(to);
+    attrs[to] = (attrs[to] & ~moved) | (attrs[from] & moved);
+    chars[to] = chars[from];
+}
+
+/**
+ * @brief   PresentationSpace::fillChars - put the same character in a run of cells
+ * @param   pos    - the first cell
+ * @param   len    - the number of cells; the run must not go past the end
+ * @param   ebcdic - the character
+ *
+ * @details Only the characters are changed; the blocks they are in are recorded as changed once.
+ */
+void PresentationSpace::fillChars(int pos, int len, uchar ebcdic)
+{
+    if (len <= 0)
+    {
+        return;
+    }
+
+    memset(chars.data() + pos, ebcdic, len);
+    touchRange(pos, len);
+}
+
+/**
+ * @brief   PresentationSpace::copyChars - put a run of characters in a run of cells
+ * @param   pos  - the first cell
+ * @param   len  - the number of cells; the run must not go past the end
+ * @param   text - the characters
+ */
+void PresentationSpace::copyChars(int pos, int len, const uchar *text)
+{
+    if (len <= 0)
+    {
+        return;
+    }
+
+    memcpy(chars.data() + pos, text, len);
+    touchRange(pos, len);
+}
+
+/**
+ * @brief   PresentationSpace::setPlainAttrs - set the attributes of a run of cells written with no character
+ *                                             attributes in effect
+ * @param   pos       - the first cell
+ * @param   len       - the number of cells; the run must not go past the end, nor hold a field start
+ * @param   graphic   - whether the characters are from the graphic code page
+ * @param   colour    - the colour of the field the run is in
+ * @param   highlight - its highlighting
+ *
+ * @details The graphic flag is set or cleared. A cell that still has a character attribute bit from an
+ *          earlier character is given the field's colour or highlighting, as DisplayScreen::applyCharAttributes()
+ *          gives it one cell at a time; the other cells are shown with their field's, so are left alone.
+ */
+void PresentationSpace::setPlainAttrs(int pos, int len, bool graphic, Q3270::Colour colour, Q3270::Highlight highlight)
+{
+    if (len <= 0)
+    {
+        return;
+    }
+
+    const quint32 ge = graphic ? Graphic : 0;
+    const quint32 col = quint32(colour) << ColourShift;
+    const quint32 hl = quint32(highlight) << HighlightShift;
+
+    quint32 *a = attrs.data() + pos;
+
+    for (int i = 0; i < len; i++)
+    {
+        quint32 v = (a[i] & ~Graphic) | ge;
+
+        if (v & (CharAttrs << Q3270::ColourAttr))
+        {
+            v = (v & ~ColourMask) | col;
+        }
+
+        if (v & (CharAttrs << Q3270::ExtendedAttr))
+        {
+            v = (v & ~HighlightMask) | hl;
+        }
+
+        a[i] = v;
+    }
+
+    touchRange(pos, len);
+}
+
+/**
+ * @brief   PresentationSpace::touchRange - record a run of cells as changed
+ * @param   pos - the first cell
+ * @param   len - the number of cells, at least one
+ */
+void PresentationSpace::touchRange(int pos, int len)
+{
+    int last = (pos + len - 1) / BlockSize;
+
+    for (int b = pos / BlockSize; b <= last; b++)
+    {
+        changed[b >> 6] |= Q_UINT64_C(1) << (b & 63);
+    }
+}
+
+/**
+ * @brief   PresentationSpace::isChanged - has anything changed since the changes were last cleared
+ * @return  true if any block has changed
+ */
+bool PresentationSpace::isChanged() const
+{
+    for (quint64 bits : changed)
+    {
+        if (bits)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief   PresentationSpace::copyBlocks - copy some blocks from another presentation space
+ * @param   from   - a presentation space of the same size
+ * @param   blocks - the blocks to copy, one bit per block
+ *
+ * @details The blocks copied are not recorded as changed.
+ */
+void PresentationSpace::copyBlocks(const PresentationSpace &from, const QVector<quint64> &blocks)
+{
+    if (from.size() != size())
+    {
+        return;
+    }
+
+    uchar *c = chars.data();
+    quint32 *a = attrs.data();
+
+    forEachBlock(blocks, size(), [&](int start, int len) {
+        memcpy(c + start, from.chars.constData() + start, len);
+        memcpy(a + start, from.attrs.constData() + start, len * sizeof(quint32));
+    });
+}
+
+/**
+ * @brief   PresentationSpace::extractBlocks - take a copy of some blocks
+ * @param   blocks - the blocks to copy, one bit per block
+ * @return  the blocks, to be passed to applyBlocks()
+ */
+PresentationSpace::Blocks PresentationSpace::extractBlocks(const QVector<quint64> &blocks) const
+{
+    Blocks b;
+
+    b.changed = blocks;
+
+    forEachBlock(blocks, size(), [&](int start, int len) {
+        int at = b.chars.size();
+
+        b.chars.resize(at + len);
+        b.attrs.resize(at + len);
+
+        memcpy(b.chars.data() + at, chars.constData() + start, len);
+        memcpy(b.attrs.data() + at, attrs.constData() + start, len * sizeof(quint32));
+    });
+
+    return b;
+}
+
+/**
+ * @brief   PresentationSpace::applyBlocks - copy in blocks taken by extractBlocks()
+ * @param   b - the blocks, from a presentation space of the same size
+ *
+ * @details The blocks are recorded as changed.
+ */
+void PresentationSpace::applyBlocks(const Blocks &b)
+{
+    if (b.changed.size() != changed.size())
+    {
+        return;
+    }
+
+    uchar *c = chars.data();
+    quint32 *a = attrs.data();
+
+    int at = 0;
+
+    forEachBlock(b.changed, size(), [&](int start, int len) {
+        memcpy(c + start, b.chars.constData() + at, len);
+        memcpy(a + start, b.attrs.constData() + at, len * sizeof(quint32));
+
+        at += len;
+    });
+
+    mergeBlocks(changed, b.changed);
+}
+
+/**
+ * @brief   PresentationSpace::mergeBlocks - add one set of changed blocks to another
+ * @param   into - the set to add to
+ * @param   from - the blocks to add
+ *
+ * @details Sets for different sizes of presentation space can't be merged; into is replaced by from.
+ */
+void PresentationSpace::mergeBlocks(QVector<quint64> &into, const QVector<quint64> &from)
+{
+    if (into.size() != from.size())
+    {
+        into = from;
+        return;
+    }
+
+    for (int i = 0; i < into.size(); i++)
+    {
+        into[i] |= from[i];
+    }
+}
@@ -0,0 +1,221 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef PRESENTATIONSPACE_H
+#define PRESENTATIONSPACE_H
+
+#include <QVector>
+
+#include "Q3270.h"
+
+/**
+ * @brief   The PresentationSpace class
+ *
+ * @details PresentationSpace holds the 3270 display matrix as two parallel arrays, indexed by screen position:
+ *          a byte per cell for the EBCDIC character and a 32-bit word per cell packing its attributes. A
+ *          24x80 screen takes under 10KB.
+ *
+ *          The field attributes (protection, display, numeric and so on) are only meaningful on a field start;
+ *          DisplayScreen's FieldDirectory gives the field start for any other cell, and the colour and
+ *          highlighting shown are resolved against it.
+ *
+ *          Every change is recorded against the block of BlockSize cells it falls in. DisplayScreen uses the
+ *          changed blocks to publish what the host wrote from one PresentationSpace to another, and to send
+ *          it to another thread, copying only the blocks that changed.
+ */
+class PresentationSpace
+{
+    public:
+
+        // Changes are recorded for blocks of this many cells; touch() relies on it being 64
+        static constexpr int BlockSize = 64;
+
+        /**
+         * @brief   The Blocks struct
+         *
+         * @details Some of the blocks of a PresentationSpace, taken by extractBlocks() to be applied to another
+         *          of the same size.
+         */
+        struct Blocks
+        {
+            QVector<quint64> changed;       // One bit for each block held
+            QVector<uchar> chars;           // The characters of the blocks held, in screen order
+            QVector<quint32> attrs;         // Their attributes
+        };
+
+        PresentationSpace();
+
+        void resize(int cells);
+        int size() const                                        { return chars.size(); }
+
+        void reset(int pos);
+        void resetAll();
+
+        void copy(int to, int from);
+
+        // Change tracking, one bit per block
+        bool isChanged() const;
+        const QVector<quint64> &changedBlocks() const           { return changed; }
+        void clearChanges()                                     { changed.fill(0); }
+
+        void copyBlocks(const PresentationSpace &from, const QVector<quint64> &blocks);
+        Blocks extractBlocks(const QVector<quint64> &blocks) const;
+        void applyBlocks(const Blocks &b);
+
+        static void mergeBlocks(QVector<quint64> &into, const QVector<quint64> &from);
+
+        inline bool looksSame(int pos, const PresentationSpace &other) const;
+
+        // Inline getters, for speed
+        uchar getEBCDIC(int pos) const                          { return chars[pos]; }
+        bool isFieldStart(int pos) const                        { return attrs[pos] & FieldStart; }
+        bool isGraphic(int pos) const                           { return attrs[pos] & Graphic; }
+
+        // The cell's own highlight and colour
+        Q3270::Highlight getHighlight(int pos) const            { return Q3270::Highlight((attrs[pos] & HighlightMask) >> HighlightShift); }
+        Q3270::Colour getColour(int pos) const                  { return Q3270::Colour((attrs[pos] & ColourMask) >> ColourShift); }
+
+        bool isBlink(int pos) const                             { return getHighlight(pos) == Q3270::Blink; }
+
+        // The highlight and colour shown, given the field start that owns the cell, or -1
+        inline Q3270::Highlight getHighlight(int pos, int field) const;
+        inline Q3270::Colour getColour(int pos, int field) const;
+
+        // Field attributes; these are only meaningful on a field start
+        bool isExtended(int pos) const                          { return attrs[pos] & Extended; }
+        bool isProtected(int pos) const                         { return attrs[pos] & Protected; }
+        bool isDisplay(int pos) const                           { return attrs[pos] & Display; }
+        bool isAutoSkip(int pos) const                          { return (attrs[pos] & (Protected | Numeric)) == (Protected | Numeric); }
+        bool isNumeric(int pos) const                           { return attrs[pos] & Numeric; }
+        bool isMdtOn(int pos) const                             { return attrs[pos] & Mdt; }
+        bool isPenSelect(int pos) const                         { return attrs[pos] & PenSelect; }
+        bool isIntensify(int pos) const                         { return attrs[pos] & Intensify; }
+
+        bool hasCharAttrs(int pos, Q3270::CharAttr ca) const    { return attrs[pos] & (CharAttrs << ca); }
+
+        // Setters
+        void setChar(int pos, uchar ebcdic)                     { touch(pos); chars[pos] = ebcdic; }
+        void setColour(int pos, Q3270::Colour c)                { touch(pos); attrs[pos] = (attrs[pos] & ~ColourMask) | (quint32(c) << ColourShift); }
+        void setHighlight(int pos, Q3270::Highlight h)          { touch(pos); attrs[pos] = (attrs[pos] & ~HighlightMask) | (quint32(h) << HighlightShift); }
+
+        void setFieldStart(int pos, bool fs);
+        void setNumeric(int pos, bool num)                      { setFlag(pos, Numeric, num); }
+        void setGraphic(int pos, bool ge)                       { setFlag(pos, Graphic, ge); }
+        void setMDT(int pos, bool mdt)                          { setFlag(pos, Mdt, mdt); }
+        void setProtected(int pos, bool prot)                   { setFlag(pos, Protected, prot); }
+        void setDisplay(int pos, bool display)                  { setFlag(pos, Display, display); }
+        void setPenSelect(int pos, bool pensel)                 { setFlag(pos, PenSelect, pensel); }
+        void setIntensify(int pos, bool intens)                 { setFlag(pos, Intensify, intens); }
+        void setExtended(int pos, bool extend)                  { setFlag(pos, Extended, extend); }
+
+        void setCharAttrs(int pos, Q3270::CharAttr ca, bool c)  { setFlag(pos, CharAttrs << ca, c); }
+        void resetCharAttrs(int pos)                            { touch(pos); attrs[pos] &= ~CharAttrMask; }
+
+        // Runs of cells that do not wrap and hold no field start
+        void fillChars(int pos, int len, uchar ebcdic);
+        void copyChars(int pos, int len, const uchar *text);
+        void setPlainAttrs(int pos, int len, bool graphic, Q3270::Colour colour, Q3270::Highlight highlight);
+
+    private:
+
+        // Layout of the attribute word
+        enum : quint32
+        {
+            FieldStart      = 1u << 0,
+            Graphic         = 1u << 1,
+            Numeric         = 1u << 2,
+            Mdt             = 1u << 3,
+            Protected       = 1u << 4,
+            Display         = 1u << 5,
+            PenSelect       = 1u << 6,
+            Intensify       = 1u << 7,
+            Extended        = 1u << 8,
+
+            // One bit for each Q3270::CharAttr in effect
+            CharAttrs       = 1u << 9,
+            CharAttrMask    = 0xFu << 9,
+
+            HighlightShift  = 13,
+            HighlightMask   = 3u << HighlightShift,
+
+            // Q3270::Colour goes up to 35
+            ColourShift     = 16,
+            ColourMask      = 0x3Fu << ColourShift
+        };
+
+        // A cell after reset(): displayed, unprotected normal colour, no highlighting
+        static constexpr quint32 DefaultAttrs = Display | (quint32(Q3270::UnprotectedNormal) << ColourShift);
+
+        // EBCDIC code for each cell
+        QVector<uchar> chars;
+
+        // Attributes for each cell
+        QVector<quint32> attrs;
+
+        // One bit for each block with a cell that has changed
+        QVector<quint64> changed;
+
+        void touch(int pos)                                     { changed[pos >> 12] |= Q_UINT64_C(1) << ((pos >> 6) & 63); }
+        void touchRange(int pos, int len);
+        void setFlag(int pos, quint32 flag, bool on)            { touch(pos); attrs[pos] = on ? attrs[pos] | flag : attrs[pos] & ~flag; }
+};
+
+/**
+ * @brief   PresentationSpace::getHighlight - the highlighting a cell is shown with
+ * @param   pos   - screen position
+ * @param   field - the field start that owns the cell, or -1 if there are no fields
+ * @return  the highlight
+ *
+ * @details A field start, or a cell with an extended highlighting character attribute, has its own
+ *          highlighting; any other cell takes that of its field.
+ */
+inline Q3270::Highlight PresentationSpace::getHighlight(int pos, int field) const
+{
+    if (attrs[pos] & (FieldStart | (CharAttrs << Q3270::ExtendedAttr)))
+        return getHighlight(pos);
+
+    if (field >= 0)
+        return getHighlight(field);
+
+    return Q3270::NoHighlight;
+}
+
+/**
+ * @brief   PresentationSpace::getColour - the colour a cell is shown in
+ * @param   pos   - screen position
+ * @param   field - the field start that owns the cell, or -1 if there are no fields
+ * @return  the colour
+ *
+ * @details A field start, or a cell with a colour character attribute, has its own colour; any other cell
+ *          is shown in the colour of its field.
+ */
+inline Q3270::Colour PresentationSpace::getColour(int pos, int field) const
+{
+    if (attrs[pos] & (FieldStart | (CharAttrs << Q3270::ColourAttr)))
+        return getColour(pos);
+
+    if (field >= 0)
+        return getColour(field);
+
+    return Q3270::UnprotectedNormal;
+}
+
+/**
+ * @brief   PresentationSpace::looksSame - is a cell shown as it is in another PresentationSpace
+ * @param   pos   - screen position
+ * @param   other - a PresentationSpace of the same size
+ * @return  true if the cell has the same character and attributes in both, ignoring the MDT, which is not shown
+ */
+inline bool PresentationSpace::looksSame(int pos, const PresentationSpace &other) const
+{
+    return chars[pos] == other.chars[pos] && !((attrs[pos] ^ other.attrs[pos]) & ~Mdt);
+}
+
+#endif // PRESENTATIONSPACE_H
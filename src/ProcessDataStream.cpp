@@ -10,26 +10,46 @@
 
 #include "Q3270.h"
 #include "ProcessDataStream.h"
-#include "Terminal.h"
+#include "Trace.h"
 
 /**
  * @brief   ProcessDataStream::ProcessDataStream - 3270 Data Stream processing
- * @param   t - the terminal object
+ * @param   screen    - the display matrix the data stream is applied to
+ * @param   primary   - the size of the primary screen
+ * @param   alternate - the size of the alternate screen
  *
  * @details Initialise the ProcessDataStream object, setting power on settings.
  */
-ProcessDataStream::ProcessDataStream(Terminal *t, DisplayScreen *screen)
-    : terminal(t)
-    , screen(screen)
+ProcessDataStream::ProcessDataStream(DisplayScreen *screen, const QSize &primary, const QSize &alternate)
+    : screen(screen)
+    , primarySize(primary)
+    , alternateSize(alternate)
 {
     primary_pos = 0;
 
     lastAID = IBM3270_AID_NOAID;
     lastWasCmd = false;
 
+    queryReply.setScreenSizes(primarySize, alternateSize);
+
     setScreen();
 }
 
+/**
+ * @brief   ProcessDataStream::setTerminalSize - change the size of the alternate screen
+ * @param   x - the number of columns
+ * @param   y - the number of rows
+ *
+ * @details Connected to ActiveSettings::terminalModelChanged. The new size is used from the next EWA,
+ *          and the cached Query Reply is rebuilt to report it.
+ */
+void ProcessDataStream::setTerminalSize(int x, int y)
+{
+    alternateSize = QSize(x, y);
+
+    queryReply.setScreenSizes(primarySize, alternateSize);
+}
+
 /**
  * @brief   ProcessDataStream::setScreen - change the terminal to display primary or alternate screen
  * @param   alternate - true for alternate, false for primary
@@ -39,15 +59,20 @@ ProcessDataStream::ProcessDataStream(Terminal *t, DisplayScreen *screen)
  */
 void ProcessDataStream::setScreen(bool alternate)
 {
-
-    emit setAlternateScreen(alternate);
-
     alternate_size = alternate;
 
-    screen_x = terminal->terminalWidth(alternate);
-    screen_y = terminal->terminalHeight(alternate);
+    screen_x = alternate ? alternateSize.width() : primarySize.width();
+    screen_y = alternate ? alternateSize.height() : primarySize.height();
 
     screenSize = screen_x * screen_y;
+
+    // The screen is resized here rather than by Terminal, which may be on another thread
+    if (screen->width() != screen_x || screen->height() != screen_y)
+    {
+        screen->setSize(screen_x, screen_y);
+    }
+
+    emit setAlternateScreen(alternate);
 }
 
 /**
@@ -56,8 +81,11 @@ void ProcessDataStream::setScreen(bool alternate)
  * @param   tn3270e - true for TN3270-E processing, false otherwise
  *
  * @details Called when the incoming 3270 Data Stream is complete. Commands and orders are processed.
+ *
+ *          The record is a read-only view of the SocketConnection's record arena; it is only valid until
+ *          this routine returns, so nothing may keep a reference to it.
  */
-void ProcessDataStream::processStream(QByteArray &b, bool tn3270e)
+void ProcessDataStream::processStream(QByteArrayView b, bool tn3270e)
 {
     //FIXME: buffer size 0 shouldn't happen!
 /*    if (b.isEmpty())
@@ -70,21 +98,24 @@ void ProcessDataStream::processStream(QByteArray &b, bool tn3270e)
 //    b->dump();
 
 //    qApp->processEvents();
-    wsfProcessing = false;
     lastwasWrite = false;
     reply.clear();
 
-    //TODO: Multiple structured field WRITE commands
-    // Process Command codes
-    // Structured Fields Require Multiple WRITE commands
-    // Add logic to cycle round buffer for structure field length if appropriate so we can come
-    // back here to restart.
     screen->resetCharAttr();
 
     buffer = b.begin();
+    bufferEnd = b.end();
+    ordersEnd = bufferEnd;
+    streamError = false;
 
     if (tn3270e)
     {
+        if (bufferEnd - buffer < 5)
+        {
+            TRACE_WARN(datastream) << "TN3270E header truncated - record ignored";
+            return;
+        }
+
         unsigned char dataType = *buffer++;
         unsigned char requestFlag = *buffer++;
         unsigned char responseFlag = *buffer++;
@@ -94,11 +125,19 @@ void ProcessDataStream::processStream(QByteArray &b, bool tn3270e)
         // TODO: Handling of TN3270E datatypes
         if (dataType != TN3270E_DATATYPE_3270_DATA)
         {
-            printf("\n\n[** Unimplemented TN3270E command: %02X **]\n\n", dataType);
+            TRACE_WARN(datastream) << "Unimplemented TN3270E data type" << Qt::hex << (int) dataType;
             return;
         }
     }
 
+    if (buffer == bufferEnd)
+    {
+        TRACE_WARN(datastream) << "Empty record - ignored";
+        return;
+    }
+
+    bool wsf = false;
+
     // Process the incoming command
     switch((uchar) *buffer)
     {
@@ -112,7 +151,7 @@ void ProcessDataStream::processStream(QByteArray &b, bool tn3270e)
             break;
         case IBM3270_WSF:
         case IBM3270_CCW_WSF:
-            wsfProcessing = true;
+            wsf = true;
             break;
         case IBM3270_EWA:
         case IBM3270_CCW_EWA:
@@ -135,26 +174,24 @@ void ProcessDataStream::processStream(QByteArray &b, bool tn3270e)
             processRB();
             break;
         default:
-            printf("\n\n[** Unrecognised WRITE command: %02X - Block Ignored **]\n\n", (uchar) *buffer);
+            TRACE_WARN(datastream) << "Unrecognised WRITE command" << Qt::hex << (int) (uchar) *buffer << "- block ignored";
             processing = false;
             return;
     }
 
     buffer++;
 
-    while(buffer < b.end())
+    if (wsf)
     {
-        if (wsfProcessing)
-        {
-            processWSF();
-        }
-        else
-        {
-            processOrders();
-        }
-        buffer++;
+        processWSF();
+    }
+    else
+    {
+        processOrdersTo(bufferEnd);
     }
 
+    // Show everything the record wrote at once
+    screen->endWrite();
 
 //    qDebug() << QDateTime::currentMSecsSinceEpoch() << "ProcessDataStream: processingComplete";
 
@@ -224,10 +261,61 @@ void ProcessDataStream::processOrders()
             processGE();
             break;
         default:
-            placeChar((uchar) *buffer);
+            if ((uchar) *buffer >= IBM3270_ORDER_LIMIT)
+            {
+                placeRun();
+            }
+            else
+            {
+                placeChar((uchar) *buffer);
+            }
+    }
+}
+
+/**
+ * @brief   ProcessDataStream::processOrdersTo - Process 3270 Orders up to a given point
+ * @param   end - the end of the orders; the end of the record, or of the structured field they are in
+ *
+ * @details Characters and orders are processed until buffer reaches end. Runs of characters stop at end.
+ */
+void ProcessDataStream::processOrdersTo(QByteArrayView::const_iterator end)
+{
+    ordersEnd = end;
+
+    while (buffer < end && !streamError)
+    {
+        processOrders();
+        buffer++;
     }
 }
 
+/**
+ * @brief   ProcessDataStream::need - check that the operands of an order are all present
+ * @param   bytes - the number of bytes the order needs after the one buffer is on
+ * @return  true if they are there, false if the record ends first
+ *
+ * @details Each command, order and structured field checks once, before it reads its operands, so they can
+ *          then be read without further checks. The operands must lie before ordersEnd, which is the end of
+ *          the record or of the structured field being processed.
+ *
+ *          A record that ends part way through an order has been truncated or is corrupt; the order is not
+ *          performed, streamError is set, and the rest of the record is ignored. What was written before
+ *          the order stays on the screen.
+ */
+bool ProcessDataStream::need(int bytes)
+{
+    if (ordersEnd - buffer > bytes)
+    {
+        return true;
+    }
+
+    TRACE_WARN(datastream) << "Record truncated at" << Qt::hex << (int) (uchar) *buffer << "- rest of record ignored";
+
+    streamError = true;
+
+    return false;
+}
+
 /**
  * @brief   ProcessDataStream::processWCC - process the Write Control Character after a WRITE type command
  *
@@ -264,47 +352,26 @@ void ProcessDataStream::processWCC()
     //TODO: Handle RESET
     int reset = (wcc>>6)&1;
 
-    printf("[");
-
     resetMDT = wcc&1;
     restoreKeyboard  = (wcc>>1)&1;
     alarm    = (wcc>>2)&1;
 
-    if (reset)
-    {
-        printf("reset");
-    }
+    TRACE(datastream).nospace() << "[WCC " << Qt::hex << (int) wcc
+                                << (reset ? " reset" : "")
+                                << (resetMDT ? " reset MDT" : "")
+                                << (restoreKeyboard ? " restore keyboard" : "")
+                                << (alarm ? " alarm" : "") << "]";
 
     if (resetMDT)
     {
-        if (reset)
-        {
-            printf(",");
-        }
-        printf("reset MDT");
         screen->resetMDTs();
     }
 
     if (restoreKeyboard)
     {
-        if(reset|resetMDT)
-        {
-            printf(",");
-        }
-        printf("restore keyboard");
         lastAID = IBM3270_AID_NOAID;
     }
 
-    if (alarm)
-    {
-        if (restoreKeyboard|resetMDT|reset)
-        {
-            printf(",");
-        }
-        printf("alarm");
-    }
-    printf("]");
-
     screen->resetCharAttr();
 
     lastWasCmd = true;
@@ -318,13 +385,15 @@ void ProcessDataStream::processWCC()
  */
 void ProcessDataStream::processW()
 {
-    printf("[Write ");
+    TRACE(datastream) << "[Write]";
+
+    if (!need(1))
+    {
+        return;
+    }
 
     buffer++;
     processWCC();
-
-    printf("]");
-//    fflush(stdout);
 }
 
 /**
@@ -337,11 +406,11 @@ void ProcessDataStream::processW()
  */
 void ProcessDataStream::processEW(bool alternate)
 {
-    printf("[Erase Write ");
+    TRACE(datastream) << (alternate ? "[Erase Write Alternate]" : "[Erase Write]");
 
-    if (alternate)
+    if (!need(1))
     {
-        printf("Alternate ");
+        return;
     }
 
     if (alternate != alternate_size)
@@ -352,9 +421,6 @@ void ProcessDataStream::processEW(bool alternate)
     buffer++;
     processWCC();
 
-    printf("]");
-//    fflush(stdout);
-
     primary_pos = 0;
 
     screen->clear();
@@ -369,7 +435,7 @@ void ProcessDataStream::processEW(bool alternate)
  */
 void ProcessDataStream::processRB()
 {
-    printf("[ReadBuffer]");
+    TRACE(datastream) << "[ReadBuffer]";
 
     screen->getScreen(reply);
 }
@@ -383,7 +449,7 @@ void ProcessDataStream::processRB()
  */
 void ProcessDataStream::processEAU()
 {
-    qDebug() << "[EraseAllUnprotected]";
+    TRACE(datastream) << "[EraseAllUnprotected]";
 
     screen->eraseUnprotected(0, screenSize, Q3270::EraseResetMDT::ResetMDT);
 
@@ -398,31 +464,57 @@ void ProcessDataStream::processEAU()
  *
  * @details The WSF command is used to perform many types of extended operation, such as allowing multiple
  *          partitions, printing, loading of programmed symbols and more.
+ *
+ *          A WSF record holds any number of structured fields, each starting with a two byte length (which
+ *          includes itself) and a one byte identifier. Each is processed in turn, and buffer is then moved
+ *          to the next by its length, so one that is not supported is skipped without looking at its
+ *          contents. A length of zero means the structured field takes up the rest of the record.
  */
 void ProcessDataStream::processWSF()
 {
-    wsfProcessing = true;
+    while (bufferEnd - buffer >= 3 && !streamError)
+    {
+        int length = ((uchar) buffer[0] << 8) | (uchar) buffer[1];
 
-    wsfLen = *buffer++<<8;
-    wsfLen += *buffer++;
+        if (length == 0)
+        {
+            length = bufferEnd - buffer;
+        }
 
-    // Decrease length by two-byte length field and structured field id byte
-    wsfLen-=3;
+        if (length < 3 || length > bufferEnd - buffer)
+        {
+            TRACE_WARN(datastream) << "Structured field length" << length << "invalid - rest of record ignored";
+            return;
+        }
 
-    switch((uchar) *buffer)
+        QByteArrayView::const_iterator sfEnd = buffer + length;
+
+        // Leave buffer on the identifier; the structured field's operands end with it
+        buffer += 2;
+        ordersEnd = sfEnd;
+
+        switch((uchar) *buffer)
+        {
+            case IBM3270_WSF_RESET:
+                WSFreset();
+                break;
+            case IBM3270_WSF_READPARTITION:
+                WSFreadPartition();
+                break;
+            case IBM3270_WSF_OB3270DS:
+                WSFoutbound3270DS(sfEnd);
+                break;
+            default:
+                TRACE_WARN(datastream) << "Unimplemented structured field" << Qt::hex << (int) (uchar) *buffer << "- skipped";
+                break;
+        }
+
+        buffer = sfEnd;
+    }
+
+    if (buffer != bufferEnd && !streamError)
     {
-        case IBM3270_WSF_RESET:
-            WSFreset();
-            break;
-        case IBM3270_WSF_READPARTITION:
-            WSFreadPartition();
-            break;
-        case IBM3270_WSF_OB3270DS:
-            WSFoutbound3270DS();
-            break;
-        default:
-            printf("\n\n[** Unimplemented WSF command: %02X **]\n\n", *buffer);
-            break;
+        TRACE_WARN(datastream) << "Structured field truncated - ignored";
     }
 }
 
@@ -433,7 +525,7 @@ void ProcessDataStream::processWSF()
  */
 void ProcessDataStream::processRM()
 {
-    printf("[ReadModified]");
+    TRACE(datastream) << "[ReadModified]";
     screen->processAID(lastAID, Q3270_SHORT_READ);
 }
 
@@ -461,6 +553,11 @@ void ProcessDataStream::processRMA()
  */
 void ProcessDataStream::processSF()
 {
+    if (!need(1))
+    {
+        return;
+    }
+
     unsigned char fa = *++buffer;
 //    printf("[Start Field: %02X ", fa);
 
@@ -483,9 +580,10 @@ void ProcessDataStream::processSF()
  */
 void ProcessDataStream::processSFE()
 {
-    screen->resetExtended(primary_pos);
-
-    processAttributePairs(IBM3270_SFE);
+    if (!processAttributePairs(IBM3270_SFE))
+    {
+        return;
+    }
 
     lastWasCmd = true;
 
@@ -500,22 +598,24 @@ void ProcessDataStream::processSFE()
  */
 void ProcessDataStream::processSBA()
 {
-//    printf("[SetBufferAddress ");
+    if (!need(2))
+    {
+        return;
+    }
+
     buffer++;
     int tmp_pos = extractBufferAddress();
 
     if (tmp_pos >= screenSize || tmp_pos < 0)
     {
-        printf("[** SBA invalid address %d - discarded **]", tmp_pos);
+        TRACE_WARN(datastream) << "SBA invalid address" << tmp_pos << "- discarded";
         return;
     }
 
     primary_pos = tmp_pos;
 
-/*    int primary_y = (primary_pos / screen_x);
-    int primary_x = primary_pos - (primary_y * screen_x);
-    printf("%d,%d]", primary_x, primary_y);
-*/
+    TRACE(datastream) << "[SetBufferAddress" << primary_pos % screen_x << primary_pos / screen_x << "]";
+
     lastWasCmd = true;
 }
 
@@ -527,6 +627,11 @@ void ProcessDataStream::processSBA()
  */
 void ProcessDataStream::processSA()
 {
+    if (!need(2))
+    {
+        return;
+    }
+
     uchar extendedType = *++buffer;
     uchar extendedValue = *++buffer;
 //    printf("[SetAttribute %02X,%02X]", extendedType, extendedValue);
@@ -544,7 +649,10 @@ void ProcessDataStream::processSA()
  */
 void ProcessDataStream::processMF()
 {
-    processAttributePairs(IBM3270_MF);
+    if (!processAttributePairs(IBM3270_MF))
+    {
+        return;
+    }
 
     if (screen->isFieldStart(primary_pos)) {
         screen->cascadeAttrs(primary_pos);
@@ -557,6 +665,7 @@ void ProcessDataStream::processMF()
  * @brief   ProcessDataStream::handleAttributePairs - Handle attribute pairs in SFE and MF
  * @param   numPairs - the number of attribute pairs
  * @param   mode     - IBM3270_SFE or IBM3270_MF
+ * @return  false if the record ends before the last pair
  *
  * @details This function processes the attribute pairs in both SFE and MF orders. If mode is SFE, it
  *          ensures that a field is defined for the SFE order; if one is not present, it creates a
@@ -566,19 +675,34 @@ void ProcessDataStream::processMF()
  *          If mode is MF, it checks that the current position is a field start. If not, it rejects the
  *          MF order and returns. This is because the MF order is used to modify an existing field's
  *          attributes, and it cannot be used to create a new field.
+ *
+ *          The count and all the pairs are checked before anything is changed, so a truncated SFE or MF
+ *          leaves the cell as it was.
  */
-void ProcessDataStream::processAttributePairs(int mode)
+bool ProcessDataStream::processAttributePairs(int mode)
 {
+    if (!need(1))
+    {
+        return false;
+    }
+
+    // The pairs follow the count
+    if (!need(1 + (uchar) buffer[1] * 2))
+    {
+        return false;
+    }
+
     uchar numPairs = *++buffer;
 
+    if (mode == IBM3270_SFE)
+    {
+        screen->resetExtended(primary_pos);
+    }
+
     bool fieldDefined = false;
 
     for (int i = 0; i < numPairs; i++)
     {
-//        if (buffer + 2 > QByteArray().end()) {
-//            printf("[** Insufficient data for attribute pairs **]\n");
-//            return;
-//        }
         uchar type = *++buffer;
         uchar value = *++buffer;
 
@@ -592,8 +716,8 @@ void ProcessDataStream::processAttributePairs(int mode)
         }
         else if (mode == IBM3270_MF && !screen->isFieldStart(primary_pos)) {
             // Modify Field: Reject processing if no field exists at the current position
-            printf("[** MF order rejected—No field at buffer position **]\n");
-            return;
+            TRACE_WARN(datastream) << "MF order rejected - no field at buffer position" << primary_pos;
+            return true;
         }
         else {
             // Process remaining attributes (colors, highlighting, etc.)
@@ -623,13 +747,13 @@ void ProcessDataStream::processAttributePairs(int mode)
                             break;
                         default:
                             // Log unsupported highlight attributes for visibility
-                            printf("[** Unimplemented attribute - %2.2X-%2.2X - Ignored **]\n", type, value);
+                            TRACE_WARN(datastream) << "Unimplemented attribute" << Qt::hex << (int) type << (int) value << "- ignored";
                             break;
                     }
                     break;
                 default:
                     // Log unsupported attributes for debugging
-                    printf("[** Unimplemented attribute - %2.2X-%2.2X - Ignored **]\n", type, value);
+                    TRACE_WARN(datastream) << "Unimplemented attribute" << Qt::hex << (int) type << (int) value << "- ignored";
                     break;
             }
         }
@@ -639,6 +763,8 @@ void ProcessDataStream::processAttributePairs(int mode)
     if (mode == IBM3270_SFE && !fieldDefined) {
         screen->setField(primary_pos, 0x00, true);
     }
+
+    return true;
 }
 
 /**
@@ -651,7 +777,7 @@ void ProcessDataStream::processIC()
 {
     int primary_y = (primary_pos / screen_x);
     int primary_x = primary_pos - (primary_y * screen_x);
-    printf("[InsertCursor(%d,%d)]", primary_x, primary_y);
+    TRACE(datastream) << "[InsertCursor" << primary_x << primary_y << "]";
 
     screen->setCursor(primary_x, primary_y);
 
@@ -689,8 +815,7 @@ void ProcessDataStream::processIC()
 void ProcessDataStream::processPT()
 {
     //TODO: <PT><PT> is not catered for properly
-    printf("[Program Tab]");
-    buffer++;
+    TRACE(datastream) << "[Program Tab]";
 
     // If the current position is a field start and not protected, move one position
     if (screen->isFieldStart(primary_pos) && !screen->isProtected(primary_pos))
@@ -744,10 +869,16 @@ void ProcessDataStream::processPT()
 /**
  * @brief   ProcessDataStream::processRA - The 3270 REPEAT TO ADDRESS order
  *
- * @details The RA order repeats the specified character from the current address to the specified one.
+ * @details The RA order repeats the specified character from the current address to the specified one,
+ *          wrapping round the end of the screen if need be. The character may be preceded by GE.
  */
 void ProcessDataStream::processRA()
 {
+    if (!need(3))
+    {
+        return;
+    }
+
     buffer++;
     int endPos = extractBufferAddress();
 
@@ -756,29 +887,25 @@ void ProcessDataStream::processRA()
     bool geRA = false;
     if (newChar == IBM3270_GE)
     {
+        if (!need(1))
+        {
+            return;
+        }
+
         geRA = true;
         newChar = *++buffer;
     }
 
     if (endPos > screenSize || endPos < 0)
     {
-        printf("[*** RA buffer end position invalid %d - discarded ***]", endPos);
+        TRACE_WARN(datastream) << "RA buffer end position invalid" << endPos << "- discarded";
         return;
     }
 
-    if (endPos <= primary_pos)
-    {
-        endPos += screenSize;
-    }
+    // An end position the same as the current one fills the whole screen
+    screen->fillChars(primary_pos, endPos % screenSize, newChar, geRA);
 
-    for(int i = primary_pos; i < endPos; i++)
-    {
-        if (geRA)
-        {
-            screen->setGraphicEscape();
-        }
-        placeChar(newChar);
-    }
+    primary_pos = endPos % screenSize;
 
     lastWasCmd = true;
 }
@@ -791,17 +918,21 @@ void ProcessDataStream::processRA()
  */
 void ProcessDataStream::processEUA()
 {
+    if (!need(2))
+    {
+        return;
+    }
 
     buffer++;
     int stopAddress = extractBufferAddress();
 
     if (stopAddress >= screenSize || stopAddress < 0)
     {
-        printf("[*** EUA buffer end position invalid %d - discarded ***]", stopAddress);
+        TRACE_WARN(datastream) << "EUA buffer end position invalid" << stopAddress << "- discarded";
         return;
     }
 
-    printf("[EraseUnprotected to Address %d]", stopAddress);
+    TRACE(datastream) << "[EraseUnprotected to Address" << stopAddress << "]";
 
     screen->eraseUnprotected(primary_pos, stopAddress, Q3270::EraseResetMDT::DoNotResetMDT);
 
@@ -815,6 +946,11 @@ void ProcessDataStream::processEUA()
  */
 void ProcessDataStream::processGE()
 {
+    if (!need(1))
+    {
+        return;
+    }
+
     screen->setGraphicEscape();
     placeChar((uchar) *++buffer);
 
@@ -823,6 +959,7 @@ void ProcessDataStream::processGE()
 
 /**
  * @brief   ProcessDataStream::WSFoutbound3270DS - The 3270 Structured Field Outbound 3270DS
+ * @param   sfEnd - the end of the structured field
  *
  * @details The Outbound 3270DS is used to direct output to a specific partition. There are
  *          four possible incoming (outbound from the host) operations:
@@ -835,46 +972,79 @@ void ProcessDataStream::processGE()
  *          These operations can be directed to a specific partition after the Create Partition
  *          structured field has been used.
  *
- * @note    Q3270 supports only WRITE currently.
+ * @note    Q3270 supports only the implicit partition, 0.
  */
-void ProcessDataStream::WSFoutbound3270DS()
+void ProcessDataStream::WSFoutbound3270DS(QByteArrayView::const_iterator sfEnd)
 {
-    printf("[Outbound 3270DS");
-    uchar partition = *++buffer;
-
-    printf(" partition #%d ", partition);
+    if (!need(2))
+    {
+        return;
+    }
 
+    uchar partition = *++buffer;
     uchar cmnd = *++buffer;
 
-    wsfLen-=2;
+    TRACE(datastream) << "[Outbound 3270DS partition" << (int) partition << "command" << Qt::hex << (int) cmnd << "]";
+
+    if (partition != 0x00)
+    {
+        TRACE_WARN(datastream) << "Outbound 3270DS for partition" << (int) partition << "- ignored";
+        return;
+    }
 
+    // As for the commands at the start of a record, buffer is left on the last byte each one uses
     switch(cmnd)
     {
         case IBM3270_W:
-            printf("Write ");
-            buffer++;
-            processWCC();
-            wsfLen--;
+        case IBM3270_CCW_W:
+            processW();
+            break;
+        case IBM3270_EW:
+        case IBM3270_CCW_EW:
+            processEW(false);
+            break;
+        case IBM3270_EWA:
+        case IBM3270_CCW_EWA:
+            processEW(true);
+            break;
+        case IBM3270_EAU:
+        case IBM3270_CCW_EAU:
+            processEAU();
             break;
         default:
-            printf("\n\n [** Unimplemented WSF command %02X - Ignored **]\n\n", cmnd);
-    }
-    while(wsfLen>0)
-    {
-        processOrders();
-        wsfLen--;
+            TRACE_WARN(datastream) << "Unimplemented Outbound 3270DS command" << Qt::hex << (int) cmnd << "- ignored";
+            return;
     }
+
+    buffer++;
+
+    processOrdersTo(sfEnd);
 }
 
 /**
- * @brief   ProcessDataStream::WSFreset - The 3270 Structured Field Reset
+ * @brief   ProcessDataStream::WSFreset - The 3270 Structured Field Reset Partition
  *
- * @details The Reset is used to reset the terminal to its power on state.
+ * @details Reset Partition returns the partition to its initial state. With only the implicit partition and
+ *          field reply mode, that leaves the character attributes to be reset.
  */
 void ProcessDataStream::WSFreset()
 {
-    printf("\n\n[** Reset Partition %02X - Not Implemented **]\n\n", *++buffer);
-    return;
+    if (!need(1))
+    {
+        return;
+    }
+
+    uchar partition = *++buffer;
+
+    TRACE(datastream) << "[Reset Partition" << (int) partition << "]";
+
+    if (partition != 0x00)
+    {
+        TRACE_WARN(datastream) << "Reset Partition for partition" << (int) partition << "- ignored";
+        return;
+    }
+
+    screen->resetCharAttr();
 }
 
 /**
@@ -887,377 +1057,29 @@ void ProcessDataStream::WSFreset()
  */
 void ProcessDataStream::WSFreadPartition()
 {
+    if (!need(2))
+    {
+        return;
+    }
+
     uchar partition = *++buffer;
     uchar type = *++buffer;
 
-    printf("ReadPartition %d - type %2.2X\n", partition, type);
-
-    reply.append((uchar) IBM3270_AID_SF);
+    TRACE(datastream) << "[ReadPartition" << (int) partition << "type" << Qt::hex << (int) type << "]";
 
-    replySummary();
-}
-
-/**
- * @brief    ProcessDataStream::replySummary - The 3270 Structured Field Query Reply (Summary)
- * @param    queryReply - the buffer to add the reply to
- *
- * @details  The Query Reply (Summary) structured field is used to inform the host of a summary of
- *           the functions that the device supports.
- *
- *           Here, the reply summary also includes, as structured fields following the summary, the
- *           device capabililties.
- *
- *           It is this function that allows the host the utilise the dynamic screen sizes.
- */
-void ProcessDataStream::replySummary()
-{
+    // Query List is answered with every reply, which a host asking for a list must accept
+    if (type != IBM3270_WSF_RP_QUERY && type != IBM3270_WSF_RP_QUERYLIST)
+    {
+        TRACE_WARN(datastream) << "Unimplemented Read Partition type" << Qt::hex << (int) type << "- ignored";
+        return;
+    }
 
-    /* 62 x 160
-
-    > 0x0   88 000e 81 80 80 81 84 85 86 87 88 95 a1 a6 0017 81 81 01 00 *00a0* *003e* 01 000a 02e5 0002
-    > 0x20  006f 09 0c *26c0* 000881840026c000001b81858200090c000000000700100002b9
-    > 0x40  00250110f103c3013600268186001000f4f1f1f2f2f3f3f4f4f5f5f6f6f7f7f8
-    > 0x60  f8f9f9fafafbfbfcfcfdfdfefeffffffff000f81870500f0f1f1f2f2f4f4f8f8
-    > 0x80  00078188000102000c81950000100010000101001281a1000000000000000006
-    > 0xa0  a7f3f2f7f0001181a600000b01000050001800a0003effef
-
-    */
-
-    /* 43 x 80
-
-0040   88 - AID
-       00 0e - length (14 bytes including length)
-       81 - reply summary
-       80 - summary query reply
-       80 81 84 85 86 87 88 95 a1 - codes supported (summary, usable area, alphanumeric partitions, char sets, colour, hilighting, reply modes, DDM, RPQ names,
-0050   a6 - implicit partitions)
-
-       00 17 - length (23 bytes)
-       81 - query reply
-       81 - usable area
-       01 - 12/14 bit addressing allowed
-       00 - variable cells not supported, matrix character, units in cells
-       00 50 - width of usable area
-       00 2b - height of usable area
-       01 - size in mm
-       00 0a 02 e5 - distance between points in X as 2 byte numerator and 2 byte denominator (10/741)
-0060   00 02 00 6f - distance between points in Y as 2 byte n/d (2/111)
-       09 - number X of UNITS in default cell (9)
-       0c - number of Y UNITS in default cell (12)
-       0d 70 - display size (3440 - 43x80)
-
-       00 08 - length
-       81 - query reply
-       84 - alphanumeric partitions
-       00  - one partition only
-       0d 70 - total partition storage (3440 - 43x80)
-       00 - no vertical scrolling, no all points addressability, no partition protection, no presentation space copy, no modify partition
-
-0070   00 1b - length
-       81 - query reply
-       85 - character sets
-       82 - 10000010
-         1  ALT         graphic escape
-         0  MULTID   no multiple LCIDs
-         0  LOADABLE no LOAD PS
-         0  EXT      no LOAD PS EXTENDED
-         0  MS       no more than one char size only
-         0  CH2      no DBCS
-         1  GF          CGCSID present
-         0  - reserved -
-       00 - no LOAD PS slot size required
-       09 - default width
-       0c - default height
-       00 00 00 00 - LOAD PS format types supported (none)
-       07 - length of each descriptor
-
-          00 - SET  - char set
-          10 - Flags
-              00010000
-                 0 - LOAD    Non-loadable
-                 0 - TRIPLE  Not triple plane
-                 0 - CHAR    Single-byte character set
-                 1 - CB      No LCID compare
-                 0000 - reserved
-          00 LCID - Local character set id
-          [ bytes SW and SH missing as MS is zero ]
-          [ bytes SUBSN and SUBSN missing as CH2 is zero ]
-
-          CGCSID - present as GF set to one
-0080      02 b9 - character set number - 697
-          00 25 - code page - 037
-
-          01 - char set
-          10 - No LCID compare
-          f1 - Local character set id
-          03 c3 - character set 963
-          01 36 - code page 310
-
-       00 26 - length (38)
-       81  - query reply
-       86 - colour
-       00
-0090   10 00 f4 f1 f1 f2 f2 f3 f3 f4 f4 f5 f5 f6 f6 f7
-00a0   f7 f8 f8 f9 f9 fa fa fb fb fc fc fd fd fe fe ff
-00b0   ff ff ff
-
-
-       00 0f - length (15)
-       81 - query reply
-       87 - highlight
-       05 00 f0 f1 f1 f2 f2 f4 f4
-00c0   f8 f8
-
-       00 07 - length (7)
-       81 - query reply
-       88 - reply modes
-       00 - field mode
-       01 - extended field mode
-       02 - character mode
-
-       00 0c - length (12)
-       81 - query reply
-       95 - DDM
-       00 00 - reserved
-       10
-00d0   00 - limin 4096
-       10 00 - limout 4096
-       01 - 1 subset
-       01 - subset id
-
-       00 12 - length (18)
-       81 - query reply
-       a1 - rpq names
-       00 00 00 00 - device type id
-       00 00 00 00 - model (all models)
-00e0   06 - length (6)
-       a7 f3 f2 f7 f0 - x3270
-
-       00 11 - length (17)
-       81 - query reply
-       a6 - implicit partition
-       00 00 - reserved
-       0b - length
-       01 - implicit partition sizes
-       00 - reserved
-00f0   00 50 - width of default screen (80)
-       00 18 - height of default screen (24)
-       00 50 - width of alternate screen (80)
-       00 2b - height of alternate screen (43)
-
-     */
-
-    unsigned char qrt[] = {
-                            0x00, 0x09,    /* Length */
-                            IBM3270_SF_QUERYREPLY,
-                            IBM3270_SF_QUERYREPLY_SUMMARY,
-                            IBM3270_SF_QUERYREPLY_COLOUR,
-                            IBM3270_SF_QUERYREPLY_IMPPARTS,
-                            IBM3270_SF_QUERYREPLY_USABLE,
-                            IBM3270_SF_QUERYREPLY_CHARSETS,
-                            IBM3270_SF_QUERYREPLY_HIGHLIGHT,
-//                            IBM3270_SF_QUERYREPLY_PARTS
-                   };
-
-    unsigned char qrcolour[] = {
-                                 0x00, 0x16,
-                                 IBM3270_SF_QUERYREPLY,
-                                 IBM3270_SF_QUERYREPLY_COLOUR,
-                                 0x00,        /* Flags:  x.xxxxxx - Reserved
-                                                         .0...... - Printer Only - Black ribbon not loaded
-                                                         .1...... - Printer Only - Black ribbon loaded
-                                              */
-                                 0x08,        /* Number of colours, plus default colour */
-                                 0x00, 0xF4,  /* Default colour */
-                                 0xF1, 0xF1,  /* Blue */
-                                 0xF2, 0xF2,  /* Red */
-                                 0xF3, 0xF3,  /* Magenta */
-                                 0xF4, 0xF4,  /* Green */
-                                 0xF5, 0xF5,  /* Cyan */
-                                 0xF6, 0xF6,  /* Yellow */
-                                 0xF7, 0xF7   /* White */
-                               };
-
-    unsigned char qpart[] = {
-                              0x00, 0x11,
-                              IBM3270_SF_QUERYREPLY,
-                              IBM3270_SF_QUERYREPLY_IMPPARTS,
-                              0x00, 0x00,  /* Reserved */
-                              0x0B,  /* Data Length */
-                              0x01,  /* Implicit Partition Sizes */
-                              0x00,  /* Reserved */
-                              0x00, 0x50,  /* Default Width in characters */
-                              0x00, 0x18,  /* Default Height in characters */
-                              0x00, 0x00,  /* Alternate Width in characters */
-                              0x00, 0x00   /* Alternate Height in characters */
-                            };
-
-    unsigned char qhighlight[] = {
-                                    0x00, 0x0D,
-                                    IBM3270_SF_QUERYREPLY,
-                                    IBM3270_SF_QUERYREPLY_HIGHLIGHT,
-                                    0x04,        /* Number of pairs */
-                                    0x00, 0xF0,  /* Default */
-                                    0xF1, 0xF1,  /* Blink */
-                                    0xF2, 0xF2,  /* Reverse */
-                                    0xF4, 0xF4   /* Uscore */
-                                 };
-
-    unsigned char qusablearea[] = {
-                                    0x00, 0x19,
-                                    IBM3270_SF_QUERYREPLY,
-                                    IBM3270_SF_QUERYREPLY_USABLE,
-                                    0x01,       /* 12/14 bit addressing */
-                                    0x00,       /* Nothing enabled */
-                                    0x00, 0x00, /*  4 & 5 - Columns */
-                                    0x00, 0x00, /*  6 & 7 - Rows */
-                                    0x01,       /* Units in mm */
-                                    0x00, 0x00, /*  9 & 10 - Xr Numerator */
-                                    0x00, 0x00, /* 11 & 12 - Xr Denominator */
-                                    0x00, 0x00, /* 13 & 14 - Yr Numerator */
-                                    0x00, 0x00, /* 15 & 16 - Yr Denominator */
-                                    0x00, 0x00, /* 17 & 18 - X units in cell */
-                                    0x00, 0x00, /* 19 & 20 - Y units in cell */
-                                    0x00, 0x00  /* 21 & 22 - Screen buffer size */
-                                  };
-
-    unsigned char qcharsets[] = {
-                                0x00, 0x1B,
-                                IBM3270_SF_QUERYREPLY,
-                                IBM3270_SF_QUERYREPLY_CHARSETS,
-                                0x82,            /* GE, CGCSGID supported only - 10000010 */
-                                                 /* x....... - ALT */
-                                                 /*            0 - Graphic Escape not supported */
-                                                 /*            1 - Graphic Escape not supported */
-                                                 /* .x...... - MULTID */
-                                                 /*            0 - Multiple LCIDs are not supported */
-                                                 /*            1 - Multiple LCIDs are supported */
-                                                 /* ..x..... - LOADABLE */
-                                                 /*            0 - LOAD PS are not supported */
-                                                 /*            1 - LOAD PS are supported */
-                                                 /* ...x.... - EXT */
-                                                 /*            0 - LOAD PS EXTENDED is not supported */
-                                                 /*            1 - LOAD PS EXTENDED is supported */
-                                                 /* ....x... - MS */
-                                                 /*            0 - Only one character slot size is supported */
-                                                 /*            1 - More than one size of character slot is supported */
-                                                 /* .....x.. - CH2 */
-                                                 /*            0 - 2-byte coded character sets are not supported */
-                                                 /*            1 - 2 byte coded character sets are supported */
-                                                 /* ......x. - GF */
-                                                 /*            0 - CGCSGID is not present */
-                                                 /*            1 - CGCSGID is present */
-                                                 /* .......x - reserved */
-
-                                0x00,            /* x.xxxxxx - reserved */
-                                                 /*  x       - Programmed Symbols Character Slot */
-                                                 /*             0 = Load PS slot size must match */
-                                                 /*             1 = Load PS slot size match not required */
-                                0x04, 0x03,      /* Default character slot width, height */
-                                0x00, 0x00, 0x00, 0x00,   /* LOAD PS format types supported - none */
-                                    0x07,   /* length of descriptor areas   */
-
-                                      // Descriptor set 1
-                                      0x00, /* char set 0 */
-                                      0x10, /* flags: no LCID compare */
-                                      0x00, /* local character set id */
-                                      0x02, 0xB9, /* character set number */
-                                      0x00, 0x25,  /* code page 037 */
-
-                                      // Descriptor set 2
-                                      0x01, /* char set 1 */
-                                      0x10, /* flags: no LCID compare */
-                                      0xF1, /* local character set id */
-                                      0x03, 0xC3, /* character set number */
-                                      0x01, 0x36  /* code page 310 */
-    };
-
-    unsigned char qalphaparts [] = {
-                    0x00, 0x08,   /* Length */
-                    0x81,         /* Query Reply */
-                    0x84,         /* Alphanumeric partitions */
-                    0x02,         /* 2 partitions supported */
-                    0xFF, 0xFE,   /* Storage allowed */
-                    0x00          /* Partition flags: */
-                                  /* x.......   SCROLL - Scrollable */
-                                  /* .xx.....   RES    - Reserved */
-                                  /* ...x....   AP     - All points addressable */
-                                  /* ....x...   PROT   - Partition Protection */
-                                  /* .....x..   COPY   - Presentation space local copy supported */
-                                  /* ......x.   MODIFY - Modify partition supported */
-                                  /* .......x   RES    - Reserved */
-    };
-
-    qpart[14] = terminal->terminalWidth(true);
-    qpart[16] = terminal->terminalHeight(true);
-
-    qusablearea[6] = 0x00;
-    qusablearea[7] = qpart[14];
-
-    qusablearea[8] = 0x00;
-    qusablearea[9] = qpart[16];
-
-    QSizeF screenSizeMM = QGuiApplication::primaryScreen()->physicalSize();
-    QSizeF screenSizePix = QGuiApplication::primaryScreen()->size();
-
-    int xmm = screenSizeMM.width();
-    int ymm = screenSizeMM.height();
-
-    qusablearea[11]  = (xmm & 0xFF00) >> 8;
-    qusablearea[12] = (xmm & 0xFF);
-
-    qusablearea[15] = (ymm & 0xFF00) >> 8;
-    qusablearea[16] = (ymm & 0xFF);
-
-    int x = screenSizePix.width();
-    int y = screenSizePix.height();
-
-    qusablearea[13] = (x & 0xFF00) >> 8;
-    qusablearea[14] = (x & 0xFF);
-
-    qusablearea[17] = (y & 0xFF00) >> 8;
-    qusablearea[18] = (y & 0xFF);
-
-    qusablearea[19] = ((int)(terminal->terminalWidth(false) * CELL_WIDTH) & 0xFF00) >> 8;
-    qusablearea[20] = ((int)(terminal->terminalWidth(false) * CELL_WIDTH) & 0xFF);
-
-    qusablearea[21] = ((int)(terminal->terminalHeight(false) * CELL_HEIGHT) & 0xFF00) >> 8;
-    qusablearea[22] = ((int)(terminal->terminalHeight(false) * CELL_HEIGHT) & 0xFF);
-
-    qusablearea[23] = ((qusablearea[5] * qusablearea[7]) & 0xFF00) >> 8;
-    qusablearea[24] = ((qusablearea[5] * qusablearea[7]) & 0xFF);
-
-
-    addBytes(qrt, 9);
-    addBytes(qrcolour, 22);
-    addBytes(qpart, 17);
-    addBytes(qhighlight, 13);
-    addBytes(qusablearea, 25);
-    addBytes(qcharsets, 27);
-//    buffer->addBlock(qalphaparts, 8);
-}
+    reply.append((uchar) IBM3270_AID_SF);
 
-/**
- * @brief   ProcessDataStream::addBytes - add bytes to a buffer
- * @param   b - the buffer
- * @param   s - the data
- * @param   l - the length
- *
- * @details addBytes is used to add bytes to a buffer that will be sent to the host. Any 0xFF characters
- *          are doubled up.
- */
-void ProcessDataStream::addBytes(uchar *s, int l)
-{
-    for (int i = 0; i < l; i++)
-    {
-        reply.append(s[i]);
+    // The reply is only built again if the code page has changed since the last query
+    queryReply.setCodePage(screen->codePage().getCPGID());
 
-        //Double up 0xFF bytes
-        if (s[i] == 0xFF)
-        {
-            reply.append(0xFF);
-        }
-    }
+    reply.append(queryReply.data());
 }
 
 /**
@@ -1267,7 +1089,8 @@ void ProcessDataStream::addBytes(uchar *s, int l)
  * @details The incoming 3270 data stream contains buffer addresses (screen positions) that are encoded
  *          in different ways depending on the first two bits of the first byte. (12 or 14 bits).
  *
- *          It is possible to use 16 bit, but only once a partition has been created explicitly.
+ *          It is possible to use 16 bit, but only once a partition has been created explicitly, which
+ *          Q3270 does not do.
  *
  *          Bit 0 and 1 patterns:
  *
@@ -1275,33 +1098,27 @@ void ProcessDataStream::addBytes(uchar *s, int l)
  *          ------- | ----------
  *            00    | 14 bit. xxyyyyyy yyyyyyyy -> 00yyyyyy yyyyyyyy
  *            01    | 12 bit. xxyyyyyy xxyyyyyy -> 0000yyyy yyyyyyyy
- *            10    | Unsupported. Reserved.
+ *            10    | Reserved; taken as 12 bit
  *            11    | 12 bit. xxyyyyyy xxyyyyyy -> 0000yyyy yyyyyyyy
  *
- *          16 bit addressing, if used, would use all 16 bits.
+ *          In a 12 bit address the top two bits of each byte only make it a printable EBCDIC character, so
+ *          they are ignored, as other 3270 terminals do. A host only sends 14 bit addresses for screens of
+ *          more than 4K cells, but both forms are accepted for any screen size; the callers reject an
+ *          address beyond the end of the screen.
  */
 int ProcessDataStream::extractBufferAddress()
 {
-    //TODO: non-12/14 bit addresses & EBCDIC characters
-
     uchar sba1 = *buffer;
     uchar sba2 = *++buffer;
 
-    switch((sba1>>6)&3)
+    if ((sba1 & 0xC0) == 0)
     {
-        case 0b00:     // 14 bit
-//            printf("%2.2X%2.2X (%d%d - 14 bit)", sba1, sba2, (sba1>>7)&1, (sba1>>6)&1);
-            return ((sba1&63)<<8)+sba2;
-        case 0b01:     // 12 bit
-//            printf("%2.2X%2.2X (%d%d - 12 bit)", sba1, sba2, (sba1>>7)&1, (sba1>>6)&1);
-            return ((sba1&63)<<6)+(sba2&63);
-        case 0b11:     // 12 bit
-//            printf("%2.2X%2.2X (%d%d - 12 bit)", sba1, sba2, (sba1>>7)&1, (sba1>>6)&1);
-            return ((sba1&63)<<6)+(sba2&63);
-        default: // case 0b10: - reserved
-            printf("\n\n[** Unimplemented BufferAddress - %2.2X%2.2X - bitmask %d%d **]\n\n", sba1, sba2, (sba1>>7)&1, (sba1>>6)&1);
-            return 0;
+        // 14 bit
+        return ((sba1 & 0x3F) << 8) | sba2;
     }
+
+    // 12 bit
+    return ((sba1 & 0x3F) << 6) | (sba2 & 0x3F);
 }
 
 /**
@@ -1317,6 +1134,32 @@ void ProcessDataStream::placeChar(uchar ebcdic)
     lastWasCmd = false;
 }
 
+/**
+ * @brief   ProcessDataStream::placeRun - place a run of characters onto the screen
+ *
+ * @details Every 3270 order is below IBM3270_ORDER_LIMIT, so the run extends from the current byte to the
+ *          next byte below it, or the end of the orders. The run is placed with a single call to
+ *          DisplayScreen::setChars, and buffer is left on its last character.
+ */
+void ProcessDataStream::placeRun()
+{
+    QByteArrayView::const_iterator end = buffer + 1;
+
+    while (end < ordersEnd && (uchar) *end >= IBM3270_ORDER_LIMIT)
+    {
+        end++;
+    }
+
+    int len = end - buffer;
+
+    screen->setChars(primary_pos, (const uchar *) buffer, len);
+
+    primary_pos = (primary_pos + len) % screenSize;
+    buffer = end - 1;
+
+    lastWasCmd = false;
+}
+
 /**
  * @brief   ProcessDataStream::incPos - increment the screen buffer position
  *
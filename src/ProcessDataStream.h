@@ -11,17 +11,14 @@
 #ifndef PROCESSDATASTREAM_H
 #define PROCESSDATASTREAM_H
 
-#include <QGuiApplication>
-#include <QScreen>
-
 #include <QObject>
 #include <QDebug>
+#include <QSize>
 
 #include <arpa/telnet.h>
 
 #include "DisplayScreen.h"
-
-class Terminal;
+#include "QueryReply.h"
 
 class ProcessDataStream : public QObject
 {
@@ -33,14 +30,15 @@ class ProcessDataStream : public QObject
 
         bool processing;
 
-        ProcessDataStream(Terminal *t, DisplayScreen *s);
+        ProcessDataStream(DisplayScreen *s, const QSize &primary, const QSize &alternate);
 
         void showFields();
         void resetMDTs();
 
     public slots:
 
-        void processStream(QByteArray &b, bool tn3270e);
+        void processStream(QByteArrayView b, bool tn3270e);
+        void setTerminalSize(int x, int y);
 
     signals:
 
@@ -53,14 +51,28 @@ class ProcessDataStream : public QObject
 
     private:
 
-        Terminal *terminal;
         DisplayScreen *screen;
 
-        QByteArray::Iterator buffer;
+        /* Primary and alternate screen sizes of the terminal model */
+        QSize primarySize;
+        QSize alternateSize;
+
+        // Read-only position in the record being processed, and its end
+        QByteArrayView::const_iterator buffer;
+        QByteArrayView::const_iterator bufferEnd;
+
+        // The end of the orders being processed; the end of the record, or of a structured field
+        QByteArrayView::const_iterator ordersEnd;
+
+        // Set when the record ends part way through an order; the rest of the record is ignored
+        bool streamError;
 
         // Used to build replies to incoming commands (eg, RMx and inbound 3270 data streams)
         QByteArray reply;
 
+        // The answer to a Read Partition Query, built once
+        QueryReply queryReply;
+
         /* Which screen size we're currently using */
         bool alternate_size;
 
@@ -77,9 +89,6 @@ class ProcessDataStream : public QObject
         bool alarm;
         int lastAID;    // Last AID encountered
 
-        bool wsfProcessing;
-        int wsfLen;
-
         // True if the previous byte/byte sequence was a command; used for PT processing
         bool lastWasCmd;
 
@@ -93,9 +102,13 @@ class ProcessDataStream : public QObject
 
         void placeChar();
         void placeChar(uchar c);
+        void placeRun();
+
+        bool need(int bytes);
 
         void processWCC();
         void processOrders();
+        void processOrdersTo(QByteArrayView::const_iterator end);
 
         /* 3270 Command Codes */
         void processW();
@@ -123,11 +136,9 @@ class ProcessDataStream : public QObject
 
         void WSFreset();
         void WSFreadPartition();
-        void WSFoutbound3270DS();
+        void WSFoutbound3270DS(QByteArrayView::const_iterator sfEnd);
 
-        void replySummary();
-        void addBytes(uchar *bytes, int len);
-        void processAttributePairs(int mode);
+        bool processAttributePairs(int mode);
 };
 
 #endif // PROCESSDATASTREAM_H
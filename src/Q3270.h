@@ -54,6 +54,8 @@
 #define IBM3270_EUA  0x12   /* Erase Unprotected to Address */
 #define IBM3270_GE   0x08   /* Graphic Escape */
 
+#define IBM3270_ORDER_LIMIT 0x40   /* All orders (and control characters) are below this */
+
 /* Constants for some EBCDIC chars */
 #define IBM3270_CHAR_NULL  0x00
 #define IBM3270_CHAR_SPACE 0x40
@@ -64,6 +66,10 @@
 #define IBM3270_WSF_READPARTITION 0x01
 #define IBM3270_WSF_OB3270DS      0x40
 
+/* Read Partition types */
+#define IBM3270_WSF_RP_QUERY      0x02
+#define IBM3270_WSF_RP_QUERYLIST  0x03
+
 /* Inbound Structured Fields */
 #define IBM3270_SF_QUERYREPLY            0x81
 
@@ -291,6 +297,13 @@ Q_DECLARE_METATYPE(Q3270::RulerStyle)
 #define Q3270_TERMINAL_MODEL5   3
 #define Q3270_TERMINAL_DYNAMIC  4
 
+/* The primary screen is 24x80 for every model; only the alternate screen size varies */
+#define Q3270_PRIMARY_COLS      80
+#define Q3270_PRIMARY_ROWS      24
+
+/* The largest dynamic screen; 14 bit buffer addresses reach 16K cells */
+#define Q3270_MAX_CELLS         16384
+
 #define Q3270_MOVE_CURSOR_RELATIVE false
 #define Q3270_MOVE_CURSOR_ABSOLUTE true
 
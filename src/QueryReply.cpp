@@ -0,0 +1,400 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <QGuiApplication>
+#include <QScreen>
+
+#include "Q3270.h"
+#include "QueryReply.h"
+
+/**
+ * @brief   QueryReply::QueryReply - the Query Reply for a terminal
+ *
+ * @details The size of the primary display is read here. Without a display (as in the benchmarks), the
+ *          usable area reports a distance between points of zero.
+ */
+QueryReply::QueryReply() : primarySize(80, 24), alternateSize(80, 24), codePage(37)
+{
+    displayWidthMM = 0;
+    displayHeightMM = 0;
+    displayWidthPixels = 1;
+    displayHeightPixels = 1;
+
+    QScreen *screen = QGuiApplication::primaryScreen();
+
+    if (screen)
+    {
+        displayWidthMM = screen->physicalSize().width();
+        displayHeightMM = screen->physicalSize().height();
+        displayWidthPixels = qMax(1, screen->size().width());
+        displayHeightPixels = qMax(1, screen->size().height());
+    }
+}
+
+/**
+ * @brief   QueryReply::setScreenSizes - set the screen sizes reported to the host
+ * @param   primary   - the size of the primary screen
+ * @param   alternate - the size of the alternate screen
+ *
+ * @details Called when the terminal model changes. The alternate size is the largest screen the terminal
+ *          shows; for a dynamic model, it is the size the user chose.
+ */
+void QueryReply::setScreenSizes(const QSize &primary, const QSize &alternate)
+{
+    if (primary != primarySize || alternate != alternateSize)
+    {
+        primarySize = primary;
+        alternateSize = alternate;
+
+        reply.clear();
+    }
+}
+
+/**
+ * @brief   QueryReply::setCodePage - set the code page reported for the base character set
+ * @param   cpgid - the code page number
+ */
+void QueryReply::setCodePage(int cpgid)
+{
+    if (cpgid != codePage)
+    {
+        codePage = cpgid;
+
+        reply.clear();
+    }
+}
+
+/**
+ * @brief   QueryReply::data - the serialised Query Reply
+ * @return  the structured fields, without the AID
+ *
+ * @details The reply is built the first time it is asked for after a change. Any 0xFF bytes in it are
+ *          doubled when SocketConnection::sendResponse frames the record.
+ */
+const QByteArray &QueryReply::data()
+{
+    if (reply.isEmpty())
+    {
+        build();
+    }
+
+    return reply;
+}
+
+/**
+ * @brief   QueryReply::build - serialise the Query Reply
+ *
+ * @details The Query Reply (Summary) structured field is used to inform the host of a summary of
+ *          the functions that the device supports.
+ *
+ *          Here, the reply summary also includes, as structured fields following the summary, the
+ *          device capabililties.
+ *
+ *          It is the usable area and the implicit partition replies that allow the host to utilise
+ *          the dynamic screen sizes.
+ */
+void QueryReply::build()
+{
+
+    /* 62 x 160
+
+    > 0x0   88 000e 81 80 80 81 84 85 86 87 88 95 a1 a6 0017 81 81 01 00 *00a0* *003e* 01 000a 02e5 0002
+    > 0x20  006f 09 0c *26c0* 000881840026c000001b81858200090c000000000700100002b9
+    > 0x40  00250110f103c3013600268186001000f4f1f1f2f2f3f3f4f4f5f5f6f6f7f7f8
+    > 0x60  f8f9f9fafafbfbfcfcfdfdfefeffffffff000f81870500f0f1f1f2f2f4f4f8f8
+    > 0x80  00078188000102000c81950000100010000101001281a1000000000000000006
+    > 0xa0  a7f3f2f7f0001181a600000b01000050001800a0003effef
+
+    */
+
+    /* 43 x 80
+
+0040   88 - AID
+       00 0e - length (14 bytes including length)
+       81 - reply summary
+       80 - summary query reply
+       80 81 84 85 86 87 88 95 a1 - codes supported (summary, usable area, alphanumeric partitions, char sets, colour, hilighting, reply modes, DDM, RPQ names,
+0050   a6 - implicit partitions)
+
+       00 17 - length (23 bytes)
+       81 - query reply
+       81 - usable area
+       01 - 12/14 bit addressing allowed
+       00 - variable cells not supported, matrix character, units in cells
+       00 50 - width of usable area
+       00 2b - height of usable area
+       01 - size in mm
+       00 0a 02 e5 - distance between points in X as 2 byte numerator and 2 byte denominator (10/741)
+0060   00 02 00 6f - distance between points in Y as 2 byte n/d (2/111)
+       09 - number X of UNITS in default cell (9)
+       0c - number of Y UNITS in default cell (12)
+       0d 70 - display size (3440 - 43x80)
+
+       00 08 - length
+       81 - query reply
+       84 - alphanumeric partitions
+       00  - one partition only
+       0d 70 - total partition storage (3440 - 43x80)
+       00 - no vertical scrolling, no all points addressability, no partition protection, no presentation space copy, no modify partition
+
+0070   00 1b - length
+       81 - query reply
+       85 - character sets
+       82 - 10000010
+         1  ALT         graphic escape
+         0  MULTID   no multiple LCIDs
+         0  LOADABLE no LOAD PS
+         0  EXT      no LOAD PS EXTENDED
+         0  MS       no more than one char size only
+         0  CH2      no DBCS
+         1  GF          CGCSID present
+         0  - reserved -
+       00 - no LOAD PS slot size required
+       09 - default width
+       0c - default height
+       00 00 00 00 - LOAD PS format types supported (none)
+       07 - length of each descriptor
+
+          00 - SET  - char set
+          10 - Flags
+              00010000
+                 0 - LOAD    Non-loadable
+                 0 - TRIPLE  Not triple plane
+                 0 - CHAR    Single-byte character set
+                 1 - CB      No LCID compare
+                 0000 - reserved
+          00 LCID - Local character set id
+          [ bytes SW and SH missing as MS is zero ]
+          [ bytes SUBSN and SUBSN missing as CH2 is zero ]
+
+          CGCSID - present as GF set to one
+0080      02 b9 - character set number - 697
+          00 25 - code page - 037
+
+          01 - char set
+          10 - No LCID compare
+          f1 - Local character set id
+          03 c3 - character set 963
+          01 36 - code page 310
+
+       00 26 - length (38)
+       81  - query reply
+       86 - colour
+       00
+0090   10 00 f4 f1 f1 f2 f2 f3 f3 f4 f4 f5 f5 f6 f6 f7
+00a0   f7 f8 f8 f9 f9 fa fa fb fb fc fc fd fd fe fe ff
+00b0   ff ff ff
+
+
+       00 0f - length (15)
+       81 - query reply
+       87 - highlight
+       05 00 f0 f1 f1 f2 f2 f4 f4
+00c0   f8 f8
+
+       00 07 - length (7)
+       81 - query reply
+       88 - reply modes
+       00 - field mode
+       01 - extended field mode
+       02 - character mode
+
+       00 0c - length (12)
+       81 - query reply
+       95 - DDM
+       00 00 - reserved
+       10
+00d0   00 - limin 4096
+       10 00 - limout 4096
+       01 - 1 subset
+       01 - subset id
+
+       00 12 - length (18)
+       81 - query reply
+       a1 - rpq names
+       00 00 00 00 - device type id
+       00 00 00 00 - model (all models)
+00e0   06 - length (6)
+       a7 f3 f2 f7 f0 - x3270
+
+       00 11 - length (17)
+       81 - query reply
+       a6 - implicit partition
+       00 00 - reserved
+       0b - length
+       01 - implicit partition sizes
+       00 - reserved
+00f0   00 50 - width of default screen (80)
+       00 18 - height of default screen (24)
+       00 50 - width of alternate screen (80)
+       00 2b - height of alternate screen (43)
+
+     */
+
+    unsigned char qrt[] = {
+                            0x00, 0x09,    /* Length */
+                            IBM3270_SF_QUERYREPLY,
+                            IBM3270_SF_QUERYREPLY_SUMMARY,
+                            IBM3270_SF_QUERYREPLY_COLOUR,
+                            IBM3270_SF_QUERYREPLY_IMPPARTS,
+                            IBM3270_SF_QUERYREPLY_USABLE,
+                            IBM3270_SF_QUERYREPLY_CHARSETS,
+                            IBM3270_SF_QUERYREPLY_HIGHLIGHT,
+//                            IBM3270_SF_QUERYREPLY_PARTS
+                   };
+
+    unsigned char qrcolour[] = {
+                                 0x00, 0x16,
+                                 IBM3270_SF_QUERYREPLY,
+                                 IBM3270_SF_QUERYREPLY_COLOUR,
+                                 0x00,        /* Flags:  x.xxxxxx - Reserved
+                                                         .0...... - Printer Only - Black ribbon not loaded
+                                                         .1...... - Printer Only - Black ribbon loaded
+                                              */
+                                 0x08,        /* Number of colours, plus default colour */
+                                 0x00, 0xF4,  /* Default colour */
+                                 0xF1, 0xF1,  /* Blue */
+                                 0xF2, 0xF2,  /* Red */
+                                 0xF3, 0xF3,  /* Magenta */
+                                 0xF4, 0xF4,  /* Green */
+                                 0xF5, 0xF5,  /* Cyan */
+                                 0xF6, 0xF6,  /* Yellow */
+                                 0xF7, 0xF7   /* White */
+                               };
+
+    unsigned char qpart[] = {
+                              0x00, 0x11,
+                              IBM3270_SF_QUERYREPLY,
+                              IBM3270_SF_QUERYREPLY_IMPPARTS,
+                              0x00, 0x00,  /* Reserved */
+                              0x0B,  /* Data Length */
+                              0x01,  /* Implicit Partition Sizes */
+                              0x00,  /* Reserved */
+                              0x00, 0x00,  /*  9 & 10 - Default Width in characters */
+                              0x00, 0x00,  /* 11 & 12 - Default Height in characters */
+                              0x00, 0x00,  /* 13 & 14 - Alternate Width in characters */
+                              0x00, 0x00   /* 15 & 16 - Alternate Height in characters */
+                            };
+
+    unsigned char qhighlight[] = {
+                                    0x00, 0x0D,
+                                    IBM3270_SF_QUERYREPLY,
+                                    IBM3270_SF_QUERYREPLY_HIGHLIGHT,
+                                    0x04,        /* Number of pairs */
+                                    0x00, 0xF0,  /* Default */
+                                    0xF1, 0xF1,  /* Blink */
+                                    0xF2, 0xF2,  /* Reverse */
+                                    0xF4, 0xF4   /* Uscore */
+                                 };
+
+
+    unsigned char qusablearea[] = {
+                                    0x00, 0x17,
+                                    IBM3270_SF_QUERYREPLY,
+                                    IBM3270_SF_QUERYREPLY_USABLE,
+                                    0x01,       /* 12/14 bit addressing */
+                                    0x00,       /* Nothing enabled */
+                                    0x00, 0x00, /*  6 & 7 - Columns */
+                                    0x00, 0x00, /*  8 & 9 - Rows */
+                                    0x01,       /* Units in mm */
+                                    0x00, 0x00, /* 11 & 12 - Xr Numerator */
+                                    0x00, 0x01, /* 13 & 14 - Xr Denominator */
+                                    0x00, 0x00, /* 15 & 16 - Yr Numerator */
+                                    0x00, 0x01, /* 17 & 18 - Yr Denominator */
+                                    CELL_WIDTH, /* 19 - X units in cell */
+                                    CELL_HEIGHT,/* 20 - Y units in cell */
+                                    0x00, 0x00  /* 21 & 22 - Screen buffer size */
+                                  };
+
+    unsigned char qcharsets[] = {
+                                0x00, 0x1B,
+                                IBM3270_SF_QUERYREPLY,
+                                IBM3270_SF_QUERYREPLY_CHARSETS,
+                                0x82,            /* GE, CGCSGID supported only - 10000010 */
+                                                 /* x....... - ALT */
+                                                 /*            0 - Graphic Escape not supported */
+                                                 /*            1 - Graphic Escape not supported */
+                                                 /* .x...... - MULTID */
+                                                 /*            0 - Multiple LCIDs are not supported */
+                                                 /*            1 - Multiple LCIDs are supported */
+                                                 /* ..x..... - LOADABLE */
+                                                 /*            0 - LOAD PS are not supported */
+                                                 /*            1 - LOAD PS are supported */
+                                                 /* ...x.... - EXT */
+                                                 /*            0 - LOAD PS EXTENDED is not supported */
+                                                 /*            1 - LOAD PS EXTENDED is supported */
+                                                 /* ....x... - MS */
+                                                 /*            0 - Only one character slot size is supported */
+                                                 /*            1 - More than one size of character slot is supported */
+                                                 /* .....x.. - CH2 */
+                                                 /*            0 - 2-byte coded character sets are not supported */
+                                                 /*            1 - 2 byte coded character sets are supported */
+                                                 /* ......x. - GF */
+                                                 /*            0 - CGCSGID is not present */
+                                                 /*            1 - CGCSGID is present */
+                                                 /* .......x - reserved */
+
+                                0x00,            /* x.xxxxxx - reserved */
+                                                 /*  x       - Programmed Symbols Character Slot */
+                                                 /*             0 = Load PS slot size must match */
+                                                 /*             1 = Load PS slot size match not required */
+                                0x04, 0x03,      /* Default character slot width, height */
+                                0x00, 0x00, 0x00, 0x00,   /* LOAD PS format types supported - none */
+                                    0x07,   /* length of descriptor areas   */
+
+                                      // Descriptor set 1
+                                      0x00, /* char set 0 */
+                                      0x10, /* flags: no LCID compare */
+                                      0x00, /* local character set id */
+                                      0x02, 0xB9, /* character set number */
+                                      0x00, 0x25,  /* 18 & 19 - code page, 037 by default */
+
+                                      // Descriptor set 2
+                                      0x01, /* char set 1 */
+                                      0x10, /* flags: no LCID compare */
+                                      0xF1, /* local character set id */
+                                      0x03, 0xC3, /* character set number */
+                                      0x01, 0x36  /* code page 310 */
+    };
+
+    auto put16 = [](unsigned char *p, int v)
+    {
+        p[0] = (v >> 8) & 0xFF;
+        p[1] = v & 0xFF;
+    };
+
+    put16(&qpart[9], primarySize.width());
+    put16(&qpart[11], primarySize.height());
+    put16(&qpart[13], alternateSize.width());
+    put16(&qpart[15], alternateSize.height());
+
+    // The usable area is the largest screen; the distance between points is in mm per pixel
+    put16(&qusablearea[6], alternateSize.width());
+    put16(&qusablearea[8], alternateSize.height());
+
+    put16(&qusablearea[11], displayWidthMM);
+    put16(&qusablearea[13], displayWidthPixels);
+    put16(&qusablearea[15], displayHeightMM);
+    put16(&qusablearea[17], displayHeightPixels);
+
+    put16(&qusablearea[21], alternateSize.width() * alternateSize.height());
+
+    put16(&qcharsets[18], codePage);
+
+    reply.clear();
+    reply.reserve(sizeof(qrt) + sizeof(qrcolour) + sizeof(qpart) + sizeof(qhighlight) + sizeof(qusablearea) + sizeof(qcharsets));
+
+    reply.append((const char *) qrt, sizeof(qrt));
+    reply.append((const char *) qrcolour, sizeof(qrcolour));
+    reply.append((const char *) qpart, sizeof(qpart));
+    reply.append((const char *) qhighlight, sizeof(qhighlight));
+    reply.append((const char *) qusablearea, sizeof(qusablearea));
+    reply.append((const char *) qcharsets, sizeof(qcharsets));
+}
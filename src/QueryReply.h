@@ -0,0 +1,63 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef QUERYREPLY_H
+#define QUERYREPLY_H
+
+#include <QByteArray>
+#include <QSize>
+
+/**
+ * @brief   The QueryReply class
+ *
+ * @details QueryReply builds the Query Reply structured fields sent in answer to a Read Partition Query:
+ *          the summary followed by the usable area, implicit partition, colour, highlighting and character
+ *          set replies.
+ *
+ *          The reply depends only on the screen sizes, the code page and the size of the display, so it is
+ *          serialised once and kept. Changing the sizes or the code page discards it, and the next query
+ *          builds it again.
+ *
+ *          The display size is read from the primary screen when the QueryReply is created, which must be
+ *          on the GUI thread.
+ */
+class QueryReply
+{
+    public:
+
+        QueryReply();
+
+        void setScreenSizes(const QSize &primary, const QSize &alternate);
+        void setCodePage(int cpgid);
+
+        const QByteArray &data();
+
+    private:
+
+        // Primary and alternate screen sizes, in cells
+        QSize primarySize;
+        QSize alternateSize;
+
+        // Code page reported for the base character set
+        int codePage;
+
+        // Size of the display, for the usable area
+        int displayWidthMM;
+        int displayHeightMM;
+        int displayWidthPixels;
+        int displayHeightPixels;
+
+        // The serialised reply; empty until it is needed
+        QByteArray reply;
+
+        void build();
+};
+
+#endif // QUERYREPLY_H
@@ -0,0 +1,70 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "RecordArena.h"
+
+/**
+ * @brief   RecordArena::RecordArena - reusable storage for incoming 3270 records
+ * @param   initialCapacity - the number of bytes to allocate up front
+ *
+ * @details The initial capacity is enough for a full 27x132 screen with a field on every row, so most
+ *          sessions never need to grow it.
+ */
+RecordArena::RecordArena(qsizetype initialCapacity)
+{
+    storage = nullptr;
+    used = 0;
+    allocated = 0;
+
+#ifndef QT_NO_DEBUG
+    allocationCount = 0;
+#endif
+
+    grow(initialCapacity);
+}
+
+/**
+ * @brief   RecordArena::~RecordArena - destructor
+ *
+ * @details Free the storage.
+ */
+RecordArena::~RecordArena()
+{
+    free(storage);
+}
+
+/**
+ * @brief   RecordArena::grow - make room for a larger record
+ * @param   needed - the number of bytes that must fit
+ *
+ * @details The storage is at least doubled so that a slowly growing record causes only a handful of
+ *          allocations.
+ */
+void RecordArena::grow(qsizetype needed)
+{
+    qsizetype newSize = qMax(needed, allocated * 2);
+
+    char *newStorage = static_cast<char *>(realloc(storage, newSize));
+
+    if (!newStorage)
+    {
+        throw std::bad_alloc();
+    }
+
+    storage = newStorage;
+    allocated = newSize;
+
+#ifndef QT_NO_DEBUG
+    allocationCount++;
+#endif
+}
@@ -0,0 +1,95 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef RECORDARENA_H
+#define RECORDARENA_H
+
+#include <cstring>
+
+#include <QByteArrayView>
+
+/**
+ * @brief   The RecordArena class
+ *
+ * @details RecordArena holds the 3270 record currently being assembled by the TelnetDecoder. The storage
+ *          is kept from one record to the next, so once it has grown to the size of the largest record
+ *          seen, no further allocations are made.
+ *
+ *          A completed record is handed out as a read-only QByteArrayView, which is valid until release()
+ *          is called. In debug builds, every allocation is counted so that the steady state can be shown
+ *          to be allocation free.
+ */
+class RecordArena
+{
+    public:
+
+        explicit RecordArena(qsizetype initialCapacity = 16384);
+        ~RecordArena();
+
+        RecordArena(const RecordArena &) = delete;
+        RecordArena &operator=(const RecordArena &) = delete;
+
+        inline void append(const char *data, qsizetype len);
+        inline void append(char c);
+
+        QByteArrayView view() const                 { return QByteArrayView(storage, used); }
+        qsizetype size() const                      { return used; }
+        qsizetype capacity() const                  { return allocated; }
+
+        void release()                              { used = 0; }
+
+#ifndef QT_NO_DEBUG
+        quint64 allocations() const                 { return allocationCount; }
+#endif
+
+    private:
+
+        char *storage;
+        qsizetype used;
+        qsizetype allocated;
+
+#ifndef QT_NO_DEBUG
+        quint64 allocationCount;
+#endif
+
+        void grow(qsizetype needed);
+};
+
+/**
+ * @brief   RecordArena::append - add a run of bytes to the record
+ * @param   data - the bytes
+ * @param   len  - the number of bytes
+ */
+inline void RecordArena::append(const char *data, qsizetype len)
+{
+    if (used + len > allocated)
+    {
+        grow(used + len);
+    }
+
+    memcpy(storage + used, data, len);
+    used += len;
+}
+
+/**
+ * @brief   RecordArena::append - add a single byte to the record
+ * @param   c - the byte
+ */
+inline void RecordArena::append(char c)
+{
+    if (used == allocated)
+    {
+        grow(used + 1);
+    }
+
+    storage[used++] = c;
+}
+
+#endif // RECORDARENA_H
@@ -0,0 +1,43 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef SCREENSNAPSHOT_H
+#define SCREENSNAPSHOT_H
+
+#include <QSharedPointer>
+
+#include "PresentationSpace.h"
+
+/**
+ * @brief   The ScreenSnapshot struct
+ *
+ * @details The changes a SessionWorker made to the 3270 display matrix after the host or the keyboard changed
+ *          it. Once published, a snapshot is never modified.
+ *
+ *          A snapshot holds only the blocks of the presentation space published since the previous one, so
+ *          taking and applying it cost in proportion to what changed. One that replaces a snapshot that was
+ *          never applied carries that one's blocks too. The receiving DisplayScreen rebuilds its field
+ *          directory from the field starts.
+ */
+struct ScreenSnapshot
+{
+    int width;
+    int height;
+    int cursorPos;
+
+    // When it was taken, by LatencyStats::now()
+    qint64 taken;
+
+    PresentationSpace::Blocks changes;
+};
+
+typedef QSharedPointer<const ScreenSnapshot> ScreenSnapshotPtr;
+
+#endif // SCREENSNAPSHOT_H
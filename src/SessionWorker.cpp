@@ -0,0 +1,248 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include "SessionWorker.h"
+#include "Terminal.h"
+
+/**
+ * @brief   SessionWorker::SessionWorker - a session that runs on its own thread
+ * @param   t         - the Terminal
+ * @param   codePage  - the name of the codepage being used
+ * @param   colours   - the colour theme being used
+ * @param   modelType - the terminal model type
+ *
+ * @details The SocketConnection, ProcessDataStream and model DisplayScreen are built here, on the GUI
+ *          thread, so that Terminal can wire them up before start() moves them to the worker thread.
+ *
+ *          The screen sizes are taken from the Terminal here. The model is given the worker's own codepage
+ *          and colour theme, which are only changed on the worker thread. It is never shown, so its cursor
+ *          is given a fixed colour rather than the colour of the cell under it.
+ */
+SessionWorker::SessionWorker(Terminal *t, const QString &codePage, const Colours &colours, int modelType)
+    : palette(colours)
+{
+    thread.setObjectName("Q3270 session");
+
+    cp.setCodePage(codePage);
+
+    model = new DisplayScreen(80, 24, cp, &palette);
+    model->setCursorColour(false);
+
+    datastream = new ProcessDataStream(model, QSize(t->terminalWidth(false), t->terminalHeight(false)),
+                                       QSize(t->terminalWidth(true), t->terminalHeight(true)));
+    socket = new SocketConnection(modelType);
+
+    // AIDs from the keyboard are built from the model
+    connect(model, &DisplayScreen::bufferReady, socket, &SocketConnection::sendResponse);
+    connect(model, &DisplayScreen::telnetCommand, socket, &SocketConnection::sendCommand);
+}
+
+/**
+ * @brief   SessionWorker::~SessionWorker - destructor
+ *
+ * @details Stop the thread if it's still running, and delete the objects. Once the thread has finished,
+ *          it is safe to delete them from the GUI thread.
+ */
+SessionWorker::~SessionWorker()
+{
+    if (thread.isRunning())
+    {
+        stop();
+    }
+
+    delete datastream;
+    delete socket;
+    delete model;
+}
+
+/**
+ * @brief   SessionWorker::start - start the worker thread
+ *
+ * @details Move the session objects to the worker thread and start its event loop. From here on, the
+ *          objects must only be used through signals or QMetaObject::invokeMethod().
+ */
+void SessionWorker::start()
+{
+    // Publish the screen once each record has been processed; Terminal connects processStream first
+    connect(socket, &SocketConnection::dataStreamComplete, this, &SessionWorker::publish, Qt::DirectConnection);
+
+    model->moveToThread(&thread);
+    datastream->moveToThread(&thread);
+    socket->moveToThread(&thread);
+    moveToThread(&thread);
+
+    thread.start();
+}
+
+/**
+ * @brief   SessionWorker::stop - disconnect from the host and stop the thread
+ *
+ * @details The socket is closed on the worker thread, and the GUI thread waits for that to finish before
+ *          stopping the thread.
+ */
+void SessionWorker::stop()
+{
+    QMetaObject::invokeMethod(socket, &SocketConnection::disconnectMainframe, Qt::BlockingQueuedConnection);
+
+    thread.quit();
+    thread.wait();
+}
+
+/**
+ * @brief   SessionWorker::connectMainframe - connect to the host
+ * @param   address - the target address
+ * @param   port    - the target port
+ * @param   luName  - the target LU name (may be empty)
+ *
+ * @details The connection is started on the worker thread so that the socket's notifiers belong to it.
+ */
+void SessionWorker::connectMainframe(const QString &address, quint16 port, const QString &luName)
+{
+    QMetaObject::invokeMethod(socket, [this, address, port, luName]() {
+        socket->connectMainframe(address, port, luName, datastream);
+    });
+}
+
+/**
+ * @brief   SessionWorker::setCodePage - change the model's codepage
+ * @param   codePage - the name of the codepage
+ *
+ * @details Once the worker thread has started, the change is queued to it.
+ */
+void SessionWorker::setCodePage(const QString &codePage)
+{
+    QMetaObject::invokeMethod(this, [this, codePage]() { cp.setCodePage(codePage); });
+}
+
+/**
+ * @brief   SessionWorker::setColourTheme - change the model's colour theme
+ * @param   colours - the colour theme
+ *
+ * @details Once the worker thread has started, the change is queued to it.
+ */
+void SessionWorker::setColourTheme(const Colours &colours)
+{
+    QMetaObject::invokeMethod(this, [this, colours]() { palette = colours; });
+}
+
+/**
+ * @brief   SessionWorker::connectKeyboard - send keyboard edits to the model
+ * @param   kbd  - the Keyboard
+ * @param   view - the DisplayScreen shown on the GUI thread
+ *
+ * @details Each keyboard function is queued to the worker thread, applied to the model and followed by a
+ *          new snapshot. A cursor placed with the mouse on the view is passed on in the same way.
+ */
+void SessionWorker::connectKeyboard(Keyboard &kbd, DisplayScreen *view)
+{
+    connect(&kbd, &Keyboard::key_Character, this, [this](unsigned char c, bool insMode) { model->insertChar(c, insMode); publish(); });
+
+    connect(&kbd, &Keyboard::key_Home, this, [this]() { model->home(); publish(); });
+    connect(&kbd, &Keyboard::key_Backspace, this, [this]() { model->backspace(); publish(); });
+    connect(&kbd, &Keyboard::key_Delete, this, [this]() { model->deleteChar(); publish(); });
+    connect(&kbd, &Keyboard::key_EraseEOF, this, [this]() { model->eraseEOF(); publish(); });
+    connect(&kbd, &Keyboard::key_Newline, this, [this]() { model->newline(); publish(); });
+    connect(&kbd, &Keyboard::key_Tab, this, [this](int offset) { model->tab(offset); publish(); });
+    connect(&kbd, &Keyboard::key_End, this, [this]() { model->endline(); publish(); });
+    connect(&kbd, &Keyboard::key_Backtab, this, [this]() { model->backtab(); publish(); });
+    connect(&kbd, &Keyboard::key_moveCursor, this, [this](int x, int y) { model->moveCursor(x, y); publish(); });
+    connect(&kbd, &Keyboard::key_showInfo, model, &DisplayScreen::dumpInfo);
+    connect(&kbd, &Keyboard::key_showFields, model, &DisplayScreen::dumpFields);
+    connect(&kbd, &Keyboard::key_dumpScreen, model, &DisplayScreen::dumpDisplay);
+    connect(&kbd, &Keyboard::key_Attn, model, &DisplayScreen::interruptProcess);
+    connect(&kbd, &Keyboard::key_AID, this, [this](int aid, bool shortRead) { model->processAID(aid, shortRead); publish(); });
+
+    connect(view, &DisplayScreen::cursorClicked, this, [this](int x, int y) { model->setCursor(x, y); publish(); });
+}
+
+/**
+ * @brief   SessionWorker::disconnectKeyboard - stop sending keyboard edits to the model
+ * @param   kbd  - the Keyboard
+ * @param   view - the DisplayScreen shown on the GUI thread
+ */
+void SessionWorker::disconnectKeyboard(Keyboard &kbd, DisplayScreen *view)
+{
+    disconnect(&kbd, nullptr, this, nullptr);
+    disconnect(&kbd, nullptr, model, nullptr);
+
+    disconnect(view, &DisplayScreen::cursorClicked, this, nullptr);
+}
+
+/**
+ * @brief   SessionWorker::publish - publish the state of the model
+ *
+ * @details Called on the worker thread. Only one screenUpdated signal is outstanding at a time; if the
+ *          GUI thread hasn't collected the previous snapshot yet, it is replaced, so a burst of records
+ *          costs one repaint rather than one for each record. The replacement carries the changes in the
+ *          snapshot it replaces.
+ */
+void SessionWorker::publish()
+{
+    ScreenSnapshotPtr pending;
+
+    {
+        QMutexLocker lock(&snapshotLock);
+
+        pending = latest;
+    }
+
+    // If the GUI thread collects the pending snapshot meanwhile, its changes are simply sent again
+    ScreenSnapshotPtr snapshot = model->takeSnapshot(pending.data());
+
+    bool notify;
+
+    {
+        QMutexLocker lock(&snapshotLock);
+
+        notify = latest.isNull();
+        latest = snapshot;
+    }
+
+    if (notify)
+    {
+        emit screenUpdated();
+    }
+}
+
+/**
+ * @brief   SessionWorker::latestSnapshot - collect the most recent snapshot
+ * @return  the snapshot, or a null pointer if there is nothing new
+ *
+ * @details Called on the GUI thread in response to screenUpdated.
+ */
+ScreenSnapshotPtr SessionWorker::latestSnapshot()
+{
+    QMutexLocker lock(&snapshotLock);
+
+    ScreenSnapshotPtr snapshot = latest;
+    latest.reset();
+
+    return snapshot;
+}
+
+/**
+ * @brief   SessionWorker::getCertDetails - fetch the certificate chain
+ * @return  the certificate chain
+ *
+ * @details The socket belongs to the worker thread, so it is asked for the certificates there.
+ */
+QList<QSslCertificate> SessionWorker::getCertDetails()
+{
+    if (!thread.isRunning())
+    {
+        return socket->getCertDetails();
+    }
+
+    QList<QSslCertificate> certs;
+
+    QMetaObject::invokeMethod(socket, [this, &certs]() { certs = socket->getCertDetails(); }, Qt::BlockingQueuedConnection);
+
+    return certs;
+}
@@ -0,0 +1,99 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef SESSIONWORKER_H
+#define SESSIONWORKER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+
+#include "DisplayScreen.h"
+#include "ProcessDataStream.h"
+#include "SocketConnection.h"
+#include "ScreenSnapshot.h"
+#include "Keyboard.h"
+
+class Terminal;
+
+/**
+ * @brief   The SessionWorker class
+ *
+ * @details SessionWorker runs the network side of a session on its own thread, so that a large burst of
+ *          data from the host does not hold up keyboard handling or painting in any window.
+ *
+ *          The worker owns the SocketConnection, the ProcessDataStream and a DisplayScreen that is never
+ *          shown (the model). Once start() has been called, all three, and the worker itself, belong to the
+ *          worker thread. The model is the master copy of the display matrix; after each record from the
+ *          host and after each keyboard edit, the worker publishes an immutable ScreenSnapshot, which
+ *          Terminal applies to the DisplayScreen in the scene on the GUI thread.
+ *
+ *          The model has its own copies of the codepage and colour theme, so that nothing it reads is written
+ *          by the GUI thread; Terminal passes changes on through setCodePage() and setColourTheme().
+ *
+ *          Keyboard signals are connected to the worker with queued connections; the edits are applied to
+ *          the model in the order they were typed. The Terminal wiring in connectSession() is unchanged:
+ *          signals between the three objects are direct, because they share a thread, and signals to the
+ *          Terminal and the StatusBar are queued by Qt.
+ */
+class SessionWorker : public QObject
+{
+    Q_OBJECT
+
+    public:
+
+        SessionWorker(Terminal *t, const QString &codePage, const Colours &colours, int modelType);
+        ~SessionWorker();
+
+        DisplayScreen *screen() const                   { return model; }
+        ProcessDataStream *dataStream() const           { return datastream; }
+        SocketConnection *connection() const            { return socket; }
+
+        void start();
+        void stop();
+
+        void connectMainframe(const QString &address, quint16 port, const QString &luName);
+
+        void setCodePage(const QString &codePage);
+        void setColourTheme(const Colours &colours);
+
+        void connectKeyboard(Keyboard &kbd, DisplayScreen *view);
+        void disconnectKeyboard(Keyboard &kbd, DisplayScreen *view);
+
+        ScreenSnapshotPtr latestSnapshot();
+
+        QList<QSslCertificate> getCertDetails();
+
+    signals:
+
+        void screenUpdated();
+
+    public slots:
+
+        void publish();
+
+    private:
+
+        QThread thread;
+
+        // The model's codepage and colour theme, only used on the worker thread once it has started
+        CodePage cp;
+        Colours palette;
+
+        DisplayScreen *model;
+        ProcessDataStream *datastream;
+        SocketConnection *socket;
+
+        // The most recent snapshot not yet collected by the GUI thread
+        QMutex snapshotLock;
+        ScreenSnapshotPtr latest;
+};
+
+#endif // SESSIONWORKER_H
@@ -8,8 +8,14 @@
  * See the LICENSE file in the project root for full license information.
  */
 
+#include <QDateTime>
+#include <QDir>
+#include <QRegularExpression>
+#include <QSettings>
+
 #include "SocketConnection.h"
 #include "Q3270.h"
+#include "Trace.h"
 
 /**
  * @brief   SocketConnection::SocketConnection - handle incoming TCPIP data
@@ -24,7 +30,6 @@
 SocketConnection::SocketConnection(int modelType)
 {
     dataSocket = new QSslSocket(this);
-    telnetState = Q3270::TELNET_STATE_DATA;
 
     this->termName = tn3270e_terminal_types[modelType];
 	
@@ -38,6 +43,19 @@ SocketConnection::SocketConnection(int modelType)
     tn3270e_Mode = false;
     secureMode = false;
     verifyCerts = false;
+    noDelay = true;
+
+    hostPort = 0;
+
+    wireTrace = nullptr;
+
+    latency = nullptr;
+    recordReadTime = 0;
+
+#ifndef QT_NO_DEBUG
+    recordAllocations = decoder.recordAllocations();
+    recordCount = 0;
+#endif
 }
 
 /**
@@ -83,6 +101,8 @@ SocketConnection::~SocketConnection()
     disconnect(dataSocket, &QSslSocket::disconnected, this, &SocketConnection::closed);
 
     dataSocket->deleteLater();
+
+    delete wireTrace;
 }
 
 /**
@@ -92,6 +112,8 @@ SocketConnection::~SocketConnection()
  */
 void SocketConnection::opened()
 {
+    dataSocket->setSocketOption(QAbstractSocket::LowDelayOption, noDelay ? 1 : 0);
+
     emit encryptedConnection(Q3270::Unencrypted);
     emit connectionStarted();
 }
@@ -119,6 +141,8 @@ void SocketConnection::disconnectMainframe()
     dataSocket->disconnectFromHost();
 
     dataSocket->close();
+
+    stopRecording();
 }
 
 /**
@@ -136,10 +160,13 @@ void SocketConnection::connectMainframe(const QString &address, quint16 port, co
 {
     certErrors = false;
 
-    QList<QSslCipher> c = dataSocket->sslConfiguration().supportedCiphers();
-    for(int i=0; i<c.size();i++)
+    if (TRACE_ENABLED(telnet))
     {
-        qDebug() << c.at(i);
+        QList<QSslCipher> c = dataSocket->sslConfiguration().supportedCiphers();
+        for(int i=0; i<c.size();i++)
+        {
+            TRACE(telnet) << c.at(i);
+        }
     }
 
     connect(dataSocket, &QSslSocket::stateChanged, this, &SocketConnection::socketStateChanged);
@@ -155,10 +182,82 @@ void SocketConnection::connectMainframe(const QString &address, quint16 port, co
         dataSocket->connectToHost(address, port);
     }
 
-    qDebug() << "Encrypted:" << dataSocket->isEncrypted();
+    TRACE(telnet) << "Encrypted:" << dataSocket->isEncrypted();
 
     displayDataStream = d;
     this->luName = luName;
+
+    decoder.reset();
+
+    hostAddress = address;
+    hostPort = port;
+
+    // Record the whole session if WireTraceDir names a directory
+    QString dir = QSettings(Q3270_ORG, Q3270_APP).value("WireTraceDir").toString();
+
+    if (!dir.isEmpty())
+    {
+        QString host = address;
+        host.replace(QRegularExpression("[^A-Za-z0-9.-]"), "_");
+
+        startRecording(QDir(dir).filePath(QString("q3270-%1-%2.q3270wt")
+                                            .arg(host, QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"))));
+    }
+}
+
+/**
+ * @brief   SocketConnection::startRecording - record the session to a file
+ * @param   fileName - the recording
+ * @return  true if the recording was started
+ *
+ * @details Every record and all telnet negotiation from here on is saved, in both directions, with
+ *          nanosecond timestamps, in the WireTrace format. The file header holds the host, the terminal type
+ *          and the TN3270E state at the time recording started; negotiation that happens later is in the
+ *          recording itself. Recordings are displayed with the q3270-wiretrace tool and played back with
+ *          WireTraceReplay.
+ *
+ *          Must be called on the thread the SocketConnection belongs to.
+ */
+bool SocketConnection::startRecording(const QString &fileName)
+{
+    if (!wireTrace)
+    {
+        wireTrace = new WireTrace();
+    }
+
+    QMap<QString, QString> session;
+
+    session.insert("host", hostAddress);
+    session.insert("port", QString::number(hostPort));
+    session.insert("lu", luName);
+    session.insert("terminal", termName);
+    session.insert("secure", secureMode ? "yes" : "no");
+    session.insert("tn3270e", tn3270e_Mode ? "yes" : "no");
+
+    // A trace that is not open is not kept, as every send and receive is recorded while there is one
+    if (!wireTrace->open(fileName, session))
+    {
+        delete wireTrace;
+        wireTrace = nullptr;
+
+        return false;
+    }
+
+    TRACE_INFO(telnet) << "Recording started:" << fileName;
+
+    return true;
+}
+
+/**
+ * @brief   SocketConnection::stopRecording - finish the recording
+ *
+ * @details Anything still buffered is written before the file is closed. The trace is then deleted, so that
+ *          nothing more is recorded.
+ */
+void SocketConnection::stopRecording()
+{
+    delete wireTrace;
+    wireTrace = nullptr;
 }
 
 /**
@@ -183,7 +282,7 @@ void SocketConnection::sslErrors(const QList<QSslError> &errors)
         for(int i = 0; i < errors.size(); i++)
         {
             errs.append(errors.at(i).errorString());
-            qDebug() << "sslErrors:" << errors.at(i);
+            TRACE_WARN(telnet) << "sslErrors:" << errors.at(i);
         }
         emit connectionEnded(errs);
     }
@@ -197,7 +296,7 @@ void SocketConnection::sslErrors(const QList<QSslError> &errors)
  */
 void SocketConnection::socketEncrypted()
 {
-    qDebug() << "Encypted!";
+    TRACE(telnet) << "Encrypted";
     if (certErrors)
     {
         emit encryptedConnection(Q3270::SemiEncrypted);
@@ -207,7 +306,7 @@ void SocketConnection::socketEncrypted()
         emit encryptedConnection(Q3270::Encrypted);
     }
 
-    qDebug() << "Certificate:" << dataSocket->peerCertificate();
+    TRACE(telnet) << "Certificate:" << dataSocket->peerCertificate();
 }
 
 /**
@@ -229,13 +328,13 @@ QList<QSslCertificate> SocketConnection::getCertDetails()
  */
 void SocketConnection::socketStateChanged(QAbstractSocket::SocketState state)
 {
-    qDebug() << "SocketStateChanged: " << state;
+    TRACE(telnet) << "SocketStateChanged:" << state;
 
     QList<QSslError> e = dataSocket->sslHandshakeErrors();
 
     for(int i = 0; i < e.size(); i++)
     {
-        qDebug() << "SocketStateChanged Handshake Errors:" << e.at(i);
+        TRACE_WARN(telnet) << "SocketStateChanged Handshake Errors:" << e.at(i);
     }
     switch(state)
     {
@@ -252,220 +351,170 @@ void SocketConnection::socketStateChanged(QAbstractSocket::SocketState state)
 /**
  * @brief   SocketConnection::onReadyRead - process incoming TCPIP data
  *
- * @details This is the main driving routine for incoming TCPIP data. This routine handles all incoming
- *          traffic, and caters for the TN3270 negotiation.
+ * @details This is the main driving routine for incoming TCPIP data. Everything that is available on the
+ *          socket is read into a reusable buffer in one go, and handed to the TelnetDecoder, which splits it
+ *          into 3270 records, telnet commands and sub-negotiation requests.
+ *
+ *          Records are passed to ProcessDataStream as a read-only view of the decoder's record arena. The
+ *          connection to ProcessDataStream::processStream must be direct; the view is released when the
+ *          decoder is next called, after processStream has returned.
+ *
+ *          If a LatencyStats is set, each record is stamped as it is read, decoded and processed.
  */
 void SocketConnection::onReadyRead()
 {
+    qint64 available;
 
-    qDebug() << "Encrypted: " << dataSocket->isEncrypted();
+    while ((available = dataSocket->bytesAvailable()) > 0)
+    {
+        // readBuffer keeps its capacity between reads
+        readBuffer.resize(available);
 
-    // create a QDataStream operating on the socket
-    QDataStream dataStream(dataSocket);
+        qint64 bytesRead = dataSocket->read(readBuffer.data(), available);
 
-    // set the version so that programs compiled with different versions of Qt can agree on how to serialise
-    dataStream.setVersion(QDataStream::Qt_5_12);
+        if (bytesRead <= 0)
+        {
+            break;
+        }
 
-    // Incoming byte - unsigned
-    uchar unsignedSocketByte;
+        qint64 readTime = latency ? LatencyStats::now() : 0;
 
-    char socketByte;
-    bool subNegotiationProcessing = false;
+        // Unless a record was left part way through the last read, the next one starts in this read
+        if (decoder.record().isEmpty())
+        {
+            recordReadTime = readTime;
+        }
 
-    QByteArray response;
-    QString byteNotes;
+        decoder.feed(readBuffer.constData(), bytesRead);
 
+        for (;;)
+        {
+            TelnetDecoder::Event event = decoder.next();
 
-    // start an infinite loop
-    for (;;)
-    {
-        // Start a transaction so we can revert to the previous state in case we try to read more data than is available on the socket
-        dataStream.startTransaction();
+            if (event == TelnetDecoder::NeedData)
+            {
+                break;
+            }
 
-        response.clear();
+            switch (event)
+            {
+                case TelnetDecoder::Record:
+                    if (wireTrace)
+                    {
+                        wireTrace->record(WireTrace::Inbound, WireTrace::Data, tn3270e_Mode ? WireTrace::TN3270E : 0,
+                                          decoder.record());
+                    }
 
-        // Read incoming data, and convert to unsigned
-        dataStream.readRawData(&socketByte, 1);
-        unsignedSocketByte = (uchar) socketByte;
+                    if (latency)
+                    {
+                        // The connection to processStream is direct, so the emit spans the processing
+                        LatencyStats::Stamps stamps;
 
-        if (dataStream.commitTransaction())
-        {
+                        stamps.read = recordReadTime;
+                        stamps.eor = LatencyStats::now();
+                        stamps.processStart = stamps.eor;
 
-            qDebug();
-
-            switch (telnetState)
-			{
-
-                case Q3270::TELNET_STATE_DATA:
-                    if (unsignedSocketByte == IAC)
-					{
-                        byteNotes.append("IAC ");
-                        telnetState = Q3270::TELNET_STATE_IAC;
-					} else 
-					{
-                        incomingData.append(unsignedSocketByte);
-					}
-					break;
-
-                case Q3270::TELNET_STATE_IAC:
-                    switch (unsignedSocketByte)
-					{
-                        case IAC: // double IAC (0xFF) means a single data byte 0xFF
-                            if (subNegotiationProcessing)
-                            {
-                                // socketByte is 0xFF here, so we don't double up the incoming buffer
-                                subNegotiationBuffer.append(unsignedSocketByte);
-                                telnetState = Q3270::TELNET_STATE_SB;
-                            }
-                            else
-                            {
-                                // socketByte is 0xFF here, so we don't double up the incoming buffer
-                                incomingData.append(unsignedSocketByte);
-                                telnetState = Q3270::TELNET_STATE_DATA;
-                            }
-                            byteNotes.append("Double 0xFF ");;
-							break;
-						case DO:		// Request something, or confirm WILL request
-                            byteNotes.append("DO ");
-                            telnetState = Q3270::TELNET_STATE_IAC_DO;
-							break;
-						case DONT: 		// Request to not do something, or reject WILL request
-                            byteNotes.append("DONT ");
-                            telnetState = Q3270::TELNET_STATE_IAC_DONT;
-							break;
-						case WILL:  	// Offer to do something, or confirm DO request
-                            byteNotes.append("WILL ");
-                            telnetState = Q3270::TELNET_STATE_IAC_WILL;
-							break;
-						case WONT: 		// Reject DO request
-                            byteNotes.append("WONT ");
-                            telnetState = Q3270::TELNET_STATE_IAC_WONT;
-							break;
-						case SB:
-                            byteNotes.append("SB ");
-                            telnetState = Q3270::TELNET_STATE_SB;
-                            subNegotiationProcessing = true;
-							break;
-                        case SE:
-                            byteNotes.append("SE ");
-                            if (subNegotiationProcessing)
-                            {
-                                qDebug() << byteNotes;
-                                byteNotes = "";
-                                processSubNegotiation();
-                            }
-                            else
-                            {
-                                byteNotes.append("- IAC SE, no SB? ");
-                            }
-                            subNegotiationProcessing = false;
-                            telnetState = Q3270::TELNET_STATE_DATA;
-                            break;
-                        case EOR:
-                            byteNotes.append("EOR ");
-                            telnetState = Q3270::TELNET_STATE_DATA;
-                            qDebug() << byteNotes;
-                            byteNotes = "";
-                            dump(incomingData,"Incoming Data");
-                            qDebug() << QDateTime::currentMSecsSinceEpoch() << "SocketConnection: dataStreamComplete";
-                            emit dataStreamComplete(incomingData, tn3270e_Mode);
-                            incomingData.clear();
-							break;
-						default:
-                            byteNotes.append(QString("Not sure: %1 ").arg(unsignedSocketByte, 2, 16));
-							break;
-					}
-                    break;
+                        emit dataStreamComplete(decoder.record(), tn3270e_Mode);
 
-                case Q3270::TELNET_STATE_IAC_DO:
-                    switch (unsignedSocketByte)
-					{
-                        // Note fall-through
-                        case TELOPT_TN3270E:
-                            tn3270e_Mode = true;
-                            byteNotes.append("TN3270E on ");
-                        case TELOPT_TTYPE:
-						case TELOPT_BINARY:
-						case TELOPT_EOR:
-                            byteNotes.append(QString("TTYPE, BINARY or EOR (%1) ").arg(unsignedSocketByte, 2, 16));
-                            response.append((uchar) IAC);
-                            response.append((uchar) WILL);
-                            response.append(unsignedSocketByte);
-                            dataStream.writeRawData(response, 3);
-                            telnetState = Q3270::TELNET_STATE_DATA;
-							break;
-						default:
-                            response.append((uchar) IAC);
-                            response.append((uchar) WONT);
-                            response.append(unsignedSocketByte);
-                            dataStream.writeRawData(response, 3);
-                            telnetState = Q3270::TELNET_STATE_DATA;
-                            byteNotes.append(QString("Not sure: %1 ").arg(unsignedSocketByte, 2, 16));
-                            break;
-					}
-					break;		
-
-                case Q3270::TELNET_STATE_IAC_DONT:
-                    switch(unsignedSocketByte)
+                        stamps.processEnd = LatencyStats::now();
+
+                        latency->recordProcessed(stamps);
+
+                        // Anything after this record in the buffer was read at the same time
+                        recordReadTime = readTime;
+                    }
+                    else
                     {
-                        case TELOPT_TN3270E:
-                            tn3270e_Mode = false;
-                            byteNotes.append("TN3270E off ");
-                            break;
-                        default:
-                            byteNotes.append(QString("Not sure: %1 ").arg(unsignedSocketByte, 2, 16));
-                            telnetState = Q3270::TELNET_STATE_DATA;
-                            break;
+                        emit dataStreamComplete(decoder.record(), tn3270e_Mode);
                     }
-                    break;
-                case Q3270::TELNET_STATE_IAC_WILL:
-                    switch (unsignedSocketByte)
-					{
-						case TELOPT_BINARY:
-						case TELOPT_EOR:
-                            byteNotes.append("BINARY/EOR ");
-                            response.append((uchar) IAC);
-                            response.append((uchar) DO);
-                            response.append(unsignedSocketByte);
-                            dataStream.writeRawData(response, 3);
-                            telnetState = Q3270::TELNET_STATE_DATA;
-							break;
-						default:
-                            response.append((uchar) IAC);
-                            response.append((uchar) DONT);
-                            response.append(unsignedSocketByte);
-                            dataStream.writeRawData(response, 3);
-                            telnetState = Q3270::TELNET_STATE_DATA;
-                            byteNotes.append(QString("Not sure: %1 ").arg(unsignedSocketByte, 2, 16));
-							break;
-					}
-					break;
-
-                case Q3270::TELNET_STATE_IAC_WONT:
-                    byteNotes.append(QString("Not sure: %1 ").arg(unsignedSocketByte, 2, 16));
-                    telnetState = Q3270::TELNET_STATE_DATA;
-					break;
-
-                case Q3270::TELNET_STATE_SB:
-                    switch(unsignedSocketByte)
+
+#ifndef QT_NO_DEBUG
+                    recordCount++;
+
+                    if (decoder.recordAllocations() != recordAllocations)
                     {
-                        case IAC:
-                            telnetState = Q3270::TELNET_STATE_IAC;
-                            byteNotes.append("IAC ");
-                            break;
-                        default:
-                            subNegotiationBuffer.append(unsignedSocketByte);
-                            break;
+                        recordAllocations = decoder.recordAllocations();
+                        TRACE_INFO(telnet) << "record arena allocation" << recordAllocations
+                                           << "at record" << recordCount << "(" << decoder.record().size() << "bytes )";
                     }
+#endif
+                    break;
+                case TelnetDecoder::Command:
+                    processCommand(decoder.command(), decoder.option());
+                    break;
+                case TelnetDecoder::SubNegotiation:
+                    processSubNegotiation();
                     break;
-				default:
-                    byteNotes.append(QString("telnetState Not sure! : %1\n").arg(unsignedSocketByte, 2, 16));
-			}
+                default:
+                    break;
+            }
         }
-        else
-        {
+    }
+}
+
+/**
+ * @brief   SocketConnection::processCommand - respond to a telnet option negotiation
+ * @param   command - DO, DONT, WILL or WONT
+ * @param   option  - the telnet option being negotiated
+ *
+ * @details Q3270 agrees to TTYPE, BINARY, EOR and TN3270E, and refuses anything else.
+ */
+void SocketConnection::processCommand(uchar command, uchar option)
+{
+    char response[3] = { (char) IAC, 0, (char) option };
+
+    if (wireTrace)
+    {
+        const char received[3] = { (char) IAC, (char) command, (char) option };
+        wireTrace->record(WireTrace::Inbound, WireTrace::Telnet, 0, QByteArrayView(received, 3));
+    }
+
+    switch (command)
+    {
+        case DO:        // Request something, or confirm WILL request
+            switch (option)
+            {
+                // Note fall-through
+                case TELOPT_TN3270E:
+                    tn3270e_Mode = true;
+                    [[fallthrough]];
+                case TELOPT_TTYPE:
+                case TELOPT_BINARY:
+                case TELOPT_EOR:
+                    response[1] = (char) WILL;
+                    break;
+                default:
+                    response[1] = (char) WONT;
+                    break;
+            }
+            dataSocket->write(response, 3);
+            traceTelnet(QByteArrayView(response, 3));
+            break;
+
+        case DONT:      // Request to not do something, or reject WILL request
+            if (option == TELOPT_TN3270E)
+            {
+                tn3270e_Mode = false;
+            }
+            break;
+
+        case WILL:      // Offer to do something, or confirm DO request
+            switch (option)
+            {
+                case TELOPT_BINARY:
+                case TELOPT_EOR:
+                    response[1] = (char) DO;
+                    break;
+                default:
+                    response[1] = (char) DONT;
+                    break;
+            }
+            dataSocket->write(response, 3);
+            traceTelnet(QByteArrayView(response, 3));
+            break;
+
+        default:        // WONT - reject DO request
             break;
-        }
     }
 }
 
@@ -473,36 +522,91 @@ void SocketConnection::onReadyRead()
  * @brief   SocketConnection::sendResponse - send data back to the host
  * @param   b - the byte array containing the data
  *
- * @details Send data back to the host. This may be prefixed with a TN3270E header if TN3270E negotiation
- *          happened earlier.
+ * @details Send a 3270 record back to the host. The record is framed in a buffer that is kept from one
+ *          response to the next: the TN3270E header if TN3270E negotiation happened earlier, the data with
+ *          any 0xFF bytes doubled, and IAC EOR. The frame is passed to the socket in a single write.
+ *
+ *          This is the only place that 0xFF is doubled; the callers build the record unescaped.
  */
 void SocketConnection::sendResponse(QByteArray &b)
 {
-    QByteArray response;
-
-    // create a QDataStream operating on the socket
-    QDataStream dataStream(dataSocket);
+    // Keeps its capacity
+    frame.resize(0);
 
     if (tn3270e_Mode)
     {
-        response.append((uchar) TN3270E_DATATYPE_3270_DATA);
-        response.append((uchar) 0x00);
-        response.append((uchar) 0x00);
-        response.append((uchar) 0x00);
-        response.append((uchar) 0x00);
-        dump(response, "Send TN3270E Response");
-        dataStream.writeRawData(response, 5);
+        frame.append((char) TN3270E_DATATYPE_3270_DATA);
+        frame.append(4, 0x00);
     }
 
-    dump(b, "Sending data");
-    dataStream.writeRawData(b.constData(), b.size());
+    qsizetype headerLength = frame.size();
+
+    const char *data = b.constData();
+    const char *end = data + b.size();
+
+    while (data < end)
+    {
+        const char *iac = (const char *) memchr(data, IAC, end - data);
+
+        if (!iac)
+        {
+            frame.append(data, end - data);
+            break;
+        }
+
+        frame.append(data, iac - data + 1);
+        frame.append((char) IAC);
+
+        data = iac + 1;
+    }
+
+    frame.append((char) IAC);
+    frame.append((char) EOR);
+
+    dataSocket->write(frame);
+
+    if (latency)
+    {
+        latency->responseSent(LatencyStats::now());
+    }
+
+    if (wireTrace)
+    {
+        wireTrace->record(WireTrace::Outbound, WireTrace::Data, tn3270e_Mode ? WireTrace::TN3270E : 0,
+                          QByteArrayView(frame.constData(), headerLength), b);
+    }
+}
+
+/**
+ * @brief   SocketConnection::sendCommand - send a telnet command to the host
+ * @param   command - the command, such as IP
+ *
+ * @details The command is sent as IAC followed by the command, outside any 3270 record.
+ */
+void SocketConnection::sendCommand(uchar command)
+{
+    const char cmd[2] = { (char) IAC, (char) command };
+
+    dataSocket->write(cmd, 2);
 
-    response.clear();
-    response.append((uchar) IAC);
-    response.append((uchar) EOR);
-    dump(response, "Sending EOR Response");
+    traceTelnet(QByteArrayView(cmd, 2));
+}
+
+/**
+ * @brief   SocketConnection::setNoDelay - control the TCP_NODELAY socket option
+ * @param   n - true to send each response as soon as it is written
+ *
+ * @details With the option set, which is the default, an AID is not held back waiting for the host to
+ *          acknowledge earlier data. Applied when the connection opens.
+ */
+void SocketConnection::setNoDelay(bool n)
+{
+    noDelay = n;
 
-    dataStream.writeRawData(response, 2);
+    if (dataSocket->state() == QAbstractSocket::ConnectedState)
+    {
+        dataSocket->setSocketOption(QAbstractSocket::LowDelayOption, noDelay ? 1 : 0);
+    }
 }
 
 /**
@@ -516,12 +620,33 @@ void SocketConnection::processSubNegotiation()
     QDataStream dataStream(dataSocket);
     QByteArray response;
 
+    const QByteArray &subNegotiationBuffer = decoder.subNegotiation();
+
+    if (wireTrace)
+    {
+        QByteArray received;
+
+        received.append((uchar) IAC);
+        received.append((uchar) SB);
+        received.append(subNegotiationBuffer);
+        received.append((uchar) IAC);
+        received.append((uchar) SE);
+
+        wireTrace->record(WireTrace::Inbound, WireTrace::Telnet, 0, received);
+    }
+
+    if (subNegotiationBuffer.size() < 2)
+    {
+        TRACE_WARN(telnet) << "SubNegotiation - too short";
+        return;
+    }
+
     switch(subNegotiationBuffer.at(0))
     {
         case TELOPT_TTYPE:
             if (subNegotiationBuffer.at(1) == TELQUAL_SEND)
             {
-                dump(subNegotiationBuffer, "SubNegotitation - TTYPE SEND");
+                TRACE(telnet) << "SubNegotiation - TTYPE SEND";
 
                 response.append((uchar) IAC);
                 response.append((uchar) SB);
@@ -539,19 +664,24 @@ void SocketConnection::processSubNegotiation()
                 response.append((uchar) IAC);
                 response.append((uchar) SE);
 
-                dump(response, "SubNegotiation - TTYPE SEND Response");
-
                 dataStream.writeRawData(response.constData(), response.size());
+
+                traceTelnet(response);
             }
             else
             {
-                dump(subNegotiationBuffer, "SubNegotiation - TTYPE unknown");
+                TRACE(telnet) << "SubNegotiation - TTYPE unknown";
             }
             break;
         case TELOPT_TN3270E:
+            if (subNegotiationBuffer.size() < 3)
+            {
+                TRACE(telnet) << "SubNegotiation - TN3270E too short";
+                break;
+            }
             if (subNegotiationBuffer.at(1)  ==  TN3270E_SEND && subNegotiationBuffer.at(2) ==  TN3270E_DEVICE_TYPE)
             {
-                dump(subNegotiationBuffer, "SubNegotitation - TN3270E SEND TTYPE");
+                TRACE(telnet) << "SubNegotiation - TN3270E SEND TTYPE";
 
                 response.append((uchar) IAC);
                 response.append((uchar) SB);
@@ -570,15 +700,15 @@ void SocketConnection::processSubNegotiation()
                 response.append((uchar) IAC);
                 response.append((uchar) SE);
 
-                dump(response, "SubNegotiation - TN3270E SEND TTYPE Response");
-
                 dataStream.writeRawData(response, response.size());
 
+                traceTelnet(response);
+
                 break;
             }
             if (subNegotiationBuffer.at(1) == TN3270E_DEVICE_TYPE && subNegotiationBuffer.at(2) == TN3270E_IS)
             {
-                dump(subNegotiationBuffer, "SubNegotitation - TTYPE IS");
+                TRACE(telnet) << "SubNegotiation - TTYPE IS";
 
 /*                if (subNeg.mid(3).compare(termName.toLatin1().data()) && subNeg.at(3 + termName.length()) == TN3270E_CONNECT)
                 {
@@ -595,7 +725,7 @@ void SocketConnection::processSubNegotiation()
             }
             if (subNegotiationBuffer.at(1) == TN3270E_FUNCTIONS && subNegotiationBuffer.at(2) == TN3270E_IS)
             {
-                dump(subNegotiationBuffer, "SubNegotitation - TN3270E FNCTIONS IS");
+                TRACE(telnet) << "SubNegotiation - TN3270E FUNCTIONS IS";
 /*                qDebug() << "SocketConnection : Supported functions: ";
                 for(int i = 3; i < subNeg.size(); i++)
                 {
@@ -606,7 +736,7 @@ void SocketConnection::processSubNegotiation()
             }
             if (subNegotiationBuffer.at(1) == TN3270E_FUNCTIONS && subNegotiationBuffer.at(2) == TN3270E_REQUEST)
             {
-                dump(subNegotiationBuffer, "SubNegotitation - TN3270E FUNCTIONS REQUEST");
+                TRACE(telnet) << "SubNegotiation - TN3270E FUNCTIONS REQUEST";
 
                 response.append((uchar) IAC);
                 response.append((uchar) SB);
@@ -624,89 +754,27 @@ void SocketConnection::processSubNegotiation()
                 response.append((uchar) IAC);
                 response.append((uchar) SE);
 
-                dump(response, "SubNegotitation - TN3270E FUNCTIONS IS Response");
-
                 dataStream.writeRawData(response, response.size());
+
+                traceTelnet(response);
                 break;
             }
-            dump(subNegotiationBuffer, "SubNegotitation - Unknown TN3270E request");
+            TRACE(telnet) << "SubNegotiation - Unknown TN3270E request";
             break;
         default:
-            dump(subNegotiationBuffer, "SubNegotitation - Unknown request");
+            TRACE(telnet) << "SubNegotiation - Unknown request";
             break;
     }
-    telnetState = Q3270::TELNET_STATE_DATA;
-
-    // Finished processing this buffer, so clear it.
-    subNegotiationBuffer.clear();
 }
 
-
 /**
- * @brief   SocketConnection::dump - print out a buffer
- * @param   a     - QByteArray to be dumped
- * @param   title - A title to distinguish this from other hexdumps
- *
- * @details Debugging utility method to hexdump a buffer, formatted at 32 bytes, with EBCDIC/ASCII character
- *          representation.
+ * @brief   SocketConnection::traceTelnet - record telnet negotiation sent to the host
+ * @param   sent - the bytes written to the socket
  */
-void SocketConnection::dump(QByteArray &a, QString title)
+void SocketConnection::traceTelnet(QByteArrayView sent)
 {
-    
-    CodePage ibm037 = CodePage();
-    
-    int w = 0;
-    QString bytes;
-    QString bytesASCII;
-    QString bytesEBCDIC;
-
-    qDebug() << "";
-    qDebug().noquote() << "                         |---------------------------------------------------------------------------------------------|";
-    qDebug().noquote() << QString(QString("                         | %1 Start ( %2 bytes)").arg(title).arg(a.length())).left(96);
-    qDebug().noquote() << "                         |------------------------------------------------- Hex ---------------------------------------|  | ASCII                            | EBCDIC                           |";
-
-    for (int i = 0; i < a.size(); i++)
+    if (wireTrace)
     {
-        if (w > 31)
-        {
-            qDebug().noquote() << QString("SocketConnection: %1 - %2 | %3 | %4 |").arg(i - 31, 4, 16).arg(bytes.toUpper().leftJustified(96)).arg(bytesASCII.leftJustified(32)).arg(bytesEBCDIC.leftJustified(32));
-
-            bytesASCII = "";
-            bytesEBCDIC = "";
-            bytes = "";
-            w = 0;
-        }
-        
-        bytes.append(QString("%1 ").arg((uchar)a.at(i), 2, 16, QLatin1Char('0')));
-        
-        uchar ebcdicchar = a.at(i);
-
-        QString unicode = ibm037.getUnicodeChar(ebcdicchar);
-
-        uchar latin1 = unicode.toLatin1().data()[0];
-
-        if (isalnum(latin1))
-            bytesEBCDIC.append(QChar(latin1));
-        else
-            bytesEBCDIC.append(".");
-
-        if (isalnum(ebcdicchar))
-            bytesASCII.append(QChar(ebcdicchar));
-        else
-            bytesASCII.append(".");
-
-        w++;
-
+        wireTrace->record(WireTrace::Outbound, WireTrace::Telnet, 0, sent);
     }
-
-    if (w != 0)
-    {
-        qDebug().noquote() << QString("SocketConnection: %1 - %2 | %3 | %4 |").arg(a.size() > 31 ? a.size() - 31 : 0, 4, 16).arg(bytes.toUpper().leftJustified(96)).arg(bytesASCII.leftJustified(32)).arg(bytesEBCDIC.leftJustified(32));
-    }
-
-    qDebug().noquote() << "                         |---------------------------------------------------------------------------------------------|";
-    qDebug().noquote() << QString(QString("                         | %1 End ( %2 bytes)").arg(title).arg(a.length())).left(98);
-    qDebug().noquote() << "                         |------------------------------------------------- Hex ---------------------------------------|  | ASCII                            | EBCDIC                           |";
-    qDebug() << "";
-
 }
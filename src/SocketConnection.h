@@ -28,6 +28,9 @@
 #include <arpa/telnet.h>
 
 #include "ProcessDataStream.h"
+#include "TelnetDecoder.h"
+#include "WireTrace.h"
+#include "LatencyStats.h"
 
 class QHostAddress;
 
@@ -43,7 +46,14 @@ class SocketConnection : public QObject
 
         void setSecure(bool s);
         void setVerify(bool v);
+        void setNoDelay(bool n);
+        void setLatencyStats(LatencyStats *stats)   { latency = stats; }
         void sendResponse(QByteArray &b);
+        void sendCommand(uchar command);
+
+        bool startRecording(const QString &fileName);
+        void stopRecording();
+        bool isRecording() const                    { return wireTrace && wireTrace->isOpen(); }
 
         QList<QSslCertificate> getCertDetails();
 
@@ -56,7 +66,7 @@ class SocketConnection : public QObject
     signals:
         void connectionStarted();
         void connectionEnded(QString message = "");
-        void dataStreamComplete(QByteArray &b, bool tn3270e);
+        void dataStreamComplete(QByteArrayView record, bool tn3270e);
         void encryptedConnection(Q3270::Encryption e);
 
     private slots:
@@ -73,28 +83,51 @@ class SocketConnection : public QObject
         bool secureMode;
         bool verifyCerts;
         bool certErrors;
+        bool noDelay;
 
-        Q3270::TelnetState telnetState;
         QSslSocket *dataSocket;
 //        QTcpSocket *dataSocket;
-        QDataStream dataStream;
         ProcessDataStream *displayDataStream;
 
+        TelnetDecoder decoder;
+
+        // Reused for each read from the socket
+        QByteArray readBuffer;
+
+        // Reused for each response to the host
+        QByteArray frame;
+
+        // Binary recording of the session; only created once a recording is started
+        WireTrace *wireTrace;
+
+        // Per-record timings; not owned, and null when nothing is being measured
+        LatencyStats *latency;
+
+        // When the read holding the first bytes of the record being decoded completed
+        qint64 recordReadTime;
+
+#ifndef QT_NO_DEBUG
+        // Record arena allocations seen so far; growth is reported once the session is under way
+        quint64 recordAllocations;
+        quint64 recordCount;
+#endif
+
         QString termName;
         QString luName;
 
-        QByteArray incomingData;
-        QByteArray subNegotiationBuffer;
+        QString hostAddress;
+        quint16 hostPort;
 
+        void processCommand(uchar command, uchar option);
         void processSubNegotiation();
 
+        void traceTelnet(QByteArrayView sent);
+
         const char *tn3270e_functions_strings[5] = { "BIND_IMAGE", "DATA_STREAM_CTL", "RESPONSES", "SCS_CTL_CODES", "SYSREQ" };
 
         QString tn3270e_terminal_types[5] = { "IBM-3279-2-E", "IBM-3279-3-E", "IBM-3279-4-E", "IBM-3279-5-E", "IBM-DYNAMIC" };
 
         char tn32703_functions_flags[5];
-
-        void dump(QByteArray &a, QString title);
 };
 
 #endif // SOCKETCONNECTION_H
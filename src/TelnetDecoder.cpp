@@ -0,0 +1,211 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <cstring>
+
+#include <arpa/telnet.h>
+
+#include "TelnetDecoder.h"
+
+/**
+ * @brief   TelnetDecoder::TelnetDecoder - telnet framing for incoming socket data
+ *
+ * @details Initialise the decoder in the data state with empty buffers.
+ */
+TelnetDecoder::TelnetDecoder()
+{
+    input = nullptr;
+    inputEnd = nullptr;
+
+    reset();
+}
+
+/**
+ * @brief   TelnetDecoder::reset - return to the initial state
+ *
+ * @details Any partial record or sub-negotiation is discarded. Called when a new connection is made.
+ */
+void TelnetDecoder::reset()
+{
+    telnetState = Q3270::TELNET_STATE_DATA;
+
+    subNegotiationProcessing = false;
+    recordPending = false;
+    subNegotiationPending = false;
+
+    incomingData.release();
+    subNegotiationBuffer.resize(0);
+
+    lastCommand = 0;
+    lastOption = 0;
+}
+
+/**
+ * @brief   TelnetDecoder::feed - supply the next block of input
+ * @param   data - the bytes read from the socket
+ * @param   len  - the number of bytes
+ *
+ * @details The data is not copied; it must remain valid until next() returns NeedData.
+ */
+void TelnetDecoder::feed(const char *data, qsizetype len)
+{
+    input = data;
+    inputEnd = data + len;
+}
+
+/**
+ * @brief   TelnetDecoder::next - decode until something of interest is found
+ * @return  the event found, or NeedData when the input has been consumed
+ *
+ * @details In the data and sub-negotiation states, the input is searched for the next IAC and everything
+ *          before it is appended to the record (or sub-negotiation buffer) in a single operation. The
+ *          bytes following an IAC are processed individually by the telnet state machine.
+ *
+ *          The view returned by record() and the buffer returned by subNegotiation() are valid until the
+ *          next call to next(); that is when the record is released. The storage is kept between records
+ *          so that, once warmed up, decoding does not allocate.
+ */
+TelnetDecoder::Event TelnetDecoder::next()
+{
+    // The caller has finished with the previous record, so its storage can be reused
+    if (recordPending)
+    {
+        incomingData.release();
+        recordPending = false;
+    }
+
+    if (subNegotiationPending)
+    {
+        subNegotiationBuffer.resize(0);
+        subNegotiationPending = false;
+    }
+
+    while (input < inputEnd)
+    {
+        switch (telnetState)
+        {
+            case Q3270::TELNET_STATE_DATA:
+            case Q3270::TELNET_STATE_SB:
+            {
+                const char *iac = static_cast<const char *>(memchr(input, IAC, inputEnd - input));
+                const char *runEnd = iac ? iac : inputEnd;
+
+                if (runEnd > input)
+                {
+                    if (telnetState == Q3270::TELNET_STATE_DATA)
+                    {
+                        incomingData.append(input, runEnd - input);
+                    }
+                    else
+                    {
+                        subNegotiationBuffer.append(input, runEnd - input);
+                    }
+                }
+
+                input = runEnd;
+
+                if (iac)
+                {
+                    input++;
+                    telnetState = Q3270::TELNET_STATE_IAC;
+                }
+                break;
+            }
+
+            case Q3270::TELNET_STATE_IAC:
+            {
+                uchar b = (uchar) *input++;
+
+                switch (b)
+                {
+                    case IAC:
+                        // Double IAC (0xFF) means a single data byte 0xFF
+                        if (subNegotiationProcessing)
+                        {
+                            subNegotiationBuffer.append((char) IAC);
+                            telnetState = Q3270::TELNET_STATE_SB;
+                        }
+                        else
+                        {
+                            incomingData.append((char) IAC);
+                            telnetState = Q3270::TELNET_STATE_DATA;
+                        }
+                        break;
+                    case DO:
+                        telnetState = Q3270::TELNET_STATE_IAC_DO;
+                        break;
+                    case DONT:
+                        telnetState = Q3270::TELNET_STATE_IAC_DONT;
+                        break;
+                    case WILL:
+                        telnetState = Q3270::TELNET_STATE_IAC_WILL;
+                        break;
+                    case WONT:
+                        telnetState = Q3270::TELNET_STATE_IAC_WONT;
+                        break;
+                    case SB:
+                        subNegotiationProcessing = true;
+                        subNegotiationBuffer.resize(0);
+                        telnetState = Q3270::TELNET_STATE_SB;
+                        break;
+                    case SE:
+                        telnetState = Q3270::TELNET_STATE_DATA;
+                        if (subNegotiationProcessing)
+                        {
+                            subNegotiationProcessing = false;
+                            subNegotiationPending = true;
+                            return SubNegotiation;
+                        }
+                        break;
+                    case EOR:
+                        telnetState = Q3270::TELNET_STATE_DATA;
+                        recordPending = true;
+                        return Record;
+                    default:
+                        // Two byte commands (NOP, GA and so on) are ignored
+                        telnetState = subNegotiationProcessing ? Q3270::TELNET_STATE_SB : Q3270::TELNET_STATE_DATA;
+                        break;
+                }
+                break;
+            }
+
+            case Q3270::TELNET_STATE_IAC_DO:
+            case Q3270::TELNET_STATE_IAC_DONT:
+            case Q3270::TELNET_STATE_IAC_WILL:
+            case Q3270::TELNET_STATE_IAC_WONT:
+                switch (telnetState)
+                {
+                    case Q3270::TELNET_STATE_IAC_DO:
+                        lastCommand = DO;
+                        break;
+                    case Q3270::TELNET_STATE_IAC_DONT:
+                        lastCommand = DONT;
+                        break;
+                    case Q3270::TELNET_STATE_IAC_WILL:
+                        lastCommand = WILL;
+                        break;
+                    default:
+                        lastCommand = WONT;
+                        break;
+                }
+
+                lastOption = (uchar) *input++;
+                telnetState = Q3270::TELNET_STATE_DATA;
+                return Command;
+
+            default:
+                // Not a state the decoder enters; recover by treating what follows as data
+                telnetState = Q3270::TELNET_STATE_DATA;
+                break;
+        }
+    }
+
+    return NeedData;
+}
@@ -0,0 +1,80 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef TELNETDECODER_H
+#define TELNETDECODER_H
+
+#include <QByteArray>
+
+#include "Q3270.h"
+#include "RecordArena.h"
+
+/**
+ * @brief   The TelnetDecoder class
+ *
+ * @details TelnetDecoder splits the raw bytes read from the socket into 3270 records, telnet commands
+ *          and sub-negotiation buffers. Runs of data bytes are located with memchr() and copied in bulk;
+ *          the Q3270::TelnetState machine is only entered when an IAC is found.
+ *
+ *          The decoder is pull based: feed() supplies a block of input and next() is called repeatedly
+ *          until it returns NeedData. It has no dependency on the socket so that it can be driven by
+ *          the benchmarks.
+ *
+ *          Records are assembled in a RecordArena and handed out as read-only views, so a record reaches
+ *          ProcessDataStream without being copied.
+ */
+class TelnetDecoder
+{
+    public:
+
+        enum Event {
+            NeedData,           // Input exhausted
+            Record,             // IAC EOR seen; record() holds the 3270 data
+            Command,            // IAC DO/DONT/WILL/WONT <option>; see command() and option()
+            SubNegotiation      // IAC SB ... IAC SE seen; subNegotiation() holds the content
+        };
+
+        TelnetDecoder();
+
+        void feed(const char *data, qsizetype len);
+        Event next();
+        void reset();
+
+        QByteArrayView record() const               { return incomingData.view(); }
+        const QByteArray &subNegotiation() const    { return subNegotiationBuffer; }
+
+        uchar command() const                       { return lastCommand; }
+        uchar option() const                        { return lastOption; }
+
+#ifndef QT_NO_DEBUG
+        quint64 recordAllocations() const           { return incomingData.allocations(); }
+#endif
+
+    private:
+
+        Q3270::TelnetState telnetState;
+
+        bool subNegotiationProcessing;
+
+        // Set when the previous call to next() handed out a record or sub-negotiation buffer
+        bool recordPending;
+        bool subNegotiationPending;
+
+        const char *input;
+        const char *inputEnd;
+
+        RecordArena incomingData;
+        QByteArray subNegotiationBuffer;
+
+        uchar lastCommand;
+        uchar lastOption;
+};
+
+#endif // TELNETDECODER_H
@@ -39,6 +39,13 @@ Terminal::Terminal(QGraphicsView *screen, ActiveSettings &activeSettings, CodePa
     , screen(screen)
 {   
 
+    // The screen is fitted to the window once a resize has finished; see eventFilter()
+    resizeTimer = new QTimer(this);
+    resizeTimer->setSingleShot(true);
+    resizeTimer->setInterval(ResizeDelay);
+
+    connect(resizeTimer, &QTimer::timeout, this, &Terminal::fit);
+
     screen->viewport()->installEventFilter(this);
 
     QGraphicsScene *screenScene = new QGraphicsScene(this);
@@ -112,6 +119,14 @@ Terminal::Terminal(QGraphicsView *screen, ActiveSettings &activeSettings, CodePa
     blinkSpeed = activeSettings.getCursorBlinkSpeed();
 
     current = new DisplayScreen(80, 24, cp, &palette);
+    current->setLatencyStats(&latency);
+    current->setBackingImage(true);
+
+    // The character blink timer only runs while something on the screen blinks
+    connect(current, &DisplayScreen::blinkingChanged, this, &Terminal::textBlinkChanged);
+
+    worker = nullptr;
+    hostScreen = current;
 }
 
 /**
@@ -185,8 +200,16 @@ void Terminal::setScreenStretch(bool stretch)
 void Terminal::setColourTheme(const Colours &colours)
 {
     palette = colours;
+
+    // The SessionWorker's model has its own copy
+    if (worker)
+    {
+        worker->setColourTheme(colours);
+    }
+
     if (sessionConnected)
     {
+        current->resetColours();
         screen->scene()->update();
     }
 }
@@ -242,6 +265,15 @@ void Terminal::rulerStyle(Q3270::RulerStyle rulerStyle)
  * @details Connect to a host. Build the ProcessDataStream, the SocketConnection, the display matrix
  *          and connect the Keyboard. Set the fonts and colours of the screens.
  *
+ *          If the application setting "SessionThread" is true, the ProcessDataStream and SocketConnection
+ *          are built by a SessionWorker and run on its thread, against the worker's own DisplayScreen.
+ *          The wiring below is the same in both cases; Qt queues the signals that cross threads. Only
+ *          the DisplayScreen in the scene (current) is touched from this thread.
+ *
+ *          The application setting "TcpNoDelay" (default true) controls TCP_NODELAY on the socket.
+ *
+ *          The latency measurements start afresh with each session.
+ *
  *          Start timers to blink the cursor and any blinking characters on screen.
  */
 void Terminal::connectSession()
@@ -254,18 +286,44 @@ void Terminal::connectSession()
 
     statusBar->setPos(0, current->boundingRect().height() + 1);
 
-    datastream = new ProcessDataStream(this, current);
-    socket = new SocketConnection(activeSettings.getTerminalModel());
+    QSettings applicationSettings(Q3270_ORG, Q3270_APP);
+
+    if (applicationSettings.value("SessionThread", false).toBool())
+    {
+        worker = new SessionWorker(this, activeSettings.getCodePage(), palette, activeSettings.getTerminalModel());
+
+        datastream = worker->dataStream();
+        socket = worker->connection();
+        hostScreen = worker->screen();
+
+        connect(worker, &SessionWorker::screenUpdated, this, &Terminal::updateScreen);
+    }
+    else
+    {
+        datastream = new ProcessDataStream(current, QSize(terminalWidth(false), terminalHeight(false)),
+                                           QSize(terminalWidth(true), terminalHeight(true)));
+        socket = new SocketConnection(activeSettings.getTerminalModel());
+        hostScreen = current;
+
+        connect(current, &DisplayScreen::bufferReady, socket, &SocketConnection::sendResponse);
+        connect(current, &DisplayScreen::telnetCommand, socket, &SocketConnection::sendCommand);
+    }
 
     socket->setSecure(activeSettings.getSecureMode());
     socket->setVerify(activeSettings.getVerifyCerts());
+    socket->setNoDelay(applicationSettings.value("TcpNoDelay", true).toBool());
+
+    latency.reset();
+    socket->setLatencyStats(&latency);
 
     connect(datastream, &ProcessDataStream::bufferReady, socket, &SocketConnection::sendResponse);
     connect(datastream, &ProcessDataStream::setAlternateScreen, this, &Terminal::setAlternateScreen);
 
-    connect(current, &DisplayScreen::bufferReady, socket, &SocketConnection::sendResponse);
+    // Queued to the worker thread when there is one
+    connect(&activeSettings, &ActiveSettings::terminalModelChanged, datastream, &ProcessDataStream::setTerminalSize);
 
-    connect(socket, &SocketConnection::dataStreamComplete, datastream, &ProcessDataStream::processStream);
+    // The record is a view of the socket's record arena, so it must be processed before the signal returns
+    connect(socket, &SocketConnection::dataStreamComplete, datastream, &ProcessDataStream::processStream, Qt::DirectConnection);
     connect(socket, &SocketConnection::encryptedConnection, statusBar, &StatusBar::setEncrypted);
     connect(socket, &SocketConnection::connectionEnded, this, &Terminal::closeConnection);
 
@@ -287,7 +345,15 @@ void Terminal::connectSession()
 
     connectKeyboard();
 
-    socket->connectMainframe(activeSettings.getHostName(), activeSettings.getHostPort(), activeSettings.getHostLU(), datastream);
+    if (worker)
+    {
+        worker->start();
+        worker->connectMainframe(activeSettings.getHostName(), activeSettings.getHostPort(), activeSettings.getHostLU());
+    }
+    else
+    {
+        socket->connectMainframe(activeSettings.getHostName(), activeSettings.getHostPort(), activeSettings.getHostLU(), datastream);
+    }
 
     startTimers();
 
@@ -312,6 +378,12 @@ void Terminal::connectSession()
  */
 void Terminal::closeConnection(QString message)
 {
+    // With a SessionWorker, the end of the connection may have been queued more than once
+    if (!sessionConnected)
+    {
+        return;
+    }
+
     sessionConnected = false;
 
     disconnect(socket, &SocketConnection::dataStreamComplete, datastream, &ProcessDataStream::processStream);
@@ -320,8 +392,10 @@ void Terminal::closeConnection(QString message)
 
     disconnect(datastream, &ProcessDataStream::bufferReady, socket, &SocketConnection::sendResponse);
     disconnect(datastream, &ProcessDataStream::setAlternateScreen, this, &Terminal::setAlternateScreen);
+    disconnect(&activeSettings, &ActiveSettings::terminalModelChanged, datastream, &ProcessDataStream::setTerminalSize);
 
-    disconnect(current, &DisplayScreen::bufferReady, socket, &SocketConnection::sendResponse);
+    disconnect(hostScreen, &DisplayScreen::bufferReady, socket, &SocketConnection::sendResponse);
+    disconnect(hostScreen, &DisplayScreen::telnetCommand, socket, &SocketConnection::sendCommand);
 
     disconnectKeyboard();
 
@@ -332,7 +406,14 @@ void Terminal::closeConnection(QString message)
     disconnect(&kbd, &Keyboard::setEnterInhibit, this, &Terminal::setTWait);
     disconnect(&kbd, &Keyboard::setInsert, this, &Terminal::setStatusInsert);
 
-    socket->disconnectMainframe();
+    if (worker)
+    {
+        worker->stop();
+    }
+    else
+    {
+        socket->disconnectMainframe();
+    }
 
     stopTimers();
 
@@ -360,8 +441,20 @@ void Terminal::closeConnection(QString message)
 
     disconnect(socket, &SocketConnection::encryptedConnection, statusBar, &StatusBar::setEncrypted);
 
-    delete datastream;
-    socket->deleteLater();
+    if (worker)
+    {
+        disconnect(worker, &SessionWorker::screenUpdated, this, &Terminal::updateScreen);
+
+        delete worker;
+        worker = nullptr;
+    }
+    else
+    {
+        delete datastream;
+        socket->deleteLater();
+    }
+
+    hostScreen = current;
 
     // Menu "Connect" entry disable
     emit disconnected();
@@ -377,9 +470,21 @@ void Terminal::closeConnection(QString message)
  *
  * @details Connect the keyboard to the specified screen. Used to ensure the keyboard is connected to either the
  *          primary or alternate.
+ *
+ *          With a SessionWorker, the keyboard edits are queued to the worker's screen instead.
  */
 void Terminal::connectKeyboard()
 {
+    connect(current, &DisplayScreen::cursorMoved, statusBar, &StatusBar::cursorMoved);
+
+    connect(&kbd, &Keyboard::key_toggleRuler, this, &Terminal::toggleRuler);
+
+    if (worker)
+    {
+        worker->connectKeyboard(kbd, current);
+        return;
+    }
+
     connect(&kbd, &Keyboard::key_Character, current, &DisplayScreen::insertChar);
 
     connect(&kbd, &Keyboard::key_Home, current, &DisplayScreen::home);
@@ -396,10 +501,6 @@ void Terminal::connectKeyboard()
     connect(&kbd, &Keyboard::key_dumpScreen, current, &DisplayScreen::dumpDisplay);
     connect(&kbd, &Keyboard::key_Attn, current, &DisplayScreen::interruptProcess);
     connect(&kbd, &Keyboard::key_AID, current, &DisplayScreen::processAID);
-    
-    connect(current, &DisplayScreen::cursorMoved, statusBar, &StatusBar::cursorMoved);
-
-    connect(&kbd, &Keyboard::key_toggleRuler, this, &Terminal::toggleRuler);
 }
 
 /**
@@ -410,6 +511,16 @@ void Terminal::connectKeyboard()
  */
 void Terminal::disconnectKeyboard()
 {
+    disconnect(current, &DisplayScreen::cursorMoved, statusBar, &StatusBar::cursorMoved);
+
+    disconnect(&kbd, &Keyboard::key_toggleRuler, this, &Terminal::toggleRuler);
+
+    if (worker)
+    {
+        worker->disconnectKeyboard(kbd, current);
+        return;
+    }
+
     disconnect(&kbd, &Keyboard::key_Character, current, &DisplayScreen::insertChar);
 
     disconnect(&kbd, &Keyboard::key_Home, current, &DisplayScreen::home);
@@ -427,10 +538,6 @@ void Terminal::disconnectKeyboard()
     disconnect(&kbd, &Keyboard::key_dumpScreen, current, &DisplayScreen::dumpDisplay);
     disconnect(&kbd, &Keyboard::key_Attn, current, &DisplayScreen::interruptProcess);
     disconnect(&kbd, &Keyboard::key_AID, current, &DisplayScreen::processAID);
-    
-    disconnect(current, &DisplayScreen::cursorMoved, statusBar, &StatusBar::cursorMoved);
-
-    disconnect(&kbd, &Keyboard::key_toggleRuler, this, &Terminal::toggleRuler);
 }
 
 /**
@@ -497,6 +604,16 @@ void Terminal::setBlinkSpeed(int speed)
 void Terminal::changeCodePage(QString codepage)
 {
     cp.setCodePage(codepage);
+
+    if (worker)
+    {
+        worker->setCodePage(codepage);
+    }
+
+    if (sessionConnected)
+    {
+        current->codePageChanged();
+    }
 }
 
 /**
@@ -518,17 +635,46 @@ void Terminal::stopTimers()
 /**
  * @brief   Terminal::startTimers - start the blinking timers
  *
- * @details Start the cursor and character blinking timers.
+ * @details Start the cursor blinking timer, and the character blinking timer if anything on the screen
+ *          blinks; otherwise that is started by textBlinkChanged() when something does.
  */
 void Terminal::startTimers()
 {
     connect(blinker, &QTimer::timeout, this, &Terminal::blinkText);
     connect(cursorBlinker, &QTimer::timeout, this, &Terminal::blinkCursor);
 
-    blinker->start(1000);
+    if (current->isBlinking())
+    {
+        blinker->start(1000);
+    }
+
     setBlinkSpeed(blinkSpeed);
 }
 
+/**
+ * @brief   Terminal::textBlinkChanged - start or stop the character blinking timer
+ * @param   blinking - true if something on the screen now blinks, false if nothing does
+ *
+ * @details Called when the first character on the screen starts blinking, or the last one stops.
+ */
+void Terminal::textBlinkChanged(bool blinking)
+{
+    if (!sessionConnected)
+    {
+        return;
+    }
+
+    if (blinking)
+    {
+        shortCharacterBlink = false;
+        blinker->start(1000);
+    }
+    else
+    {
+        blinker->stop();
+    }
+}
+
 /**
  * @brief   Terminal::blinkText - blink any text
  *
@@ -577,6 +723,26 @@ void Terminal::blinkCursor()
     }
 }
 
+/**
+ * @brief   Terminal::updateScreen - show the latest screen from the SessionWorker
+ *
+ * @details Called on the GUI thread when the SessionWorker has published a new snapshot.
+ */
+void Terminal::updateScreen()
+{
+    if (!worker)
+    {
+        return;
+    }
+
+    ScreenSnapshotPtr snapshot = worker->latestSnapshot();
+
+    if (snapshot)
+    {
+        current->applySnapshot(*snapshot);
+    }
+}
+
 /**
  * @brief   Terminal::setAlternateScreen - switch screens
  * @param   alt - true for alternate, false for primary
@@ -588,10 +754,12 @@ DisplayScreen *Terminal::setAlternateScreen(bool alt)
 {
     stopTimers();
 
-    if (!alt)
-        current->setSize(80, 24);
-    else
-        current->setSize(activeSettings.getTerminalX(), activeSettings.getTerminalY());
+    int x = terminalWidth(alt);
+    int y = terminalHeight(alt);
+
+    // ProcessDataStream has normally resized the screen already
+    if (current->width() != x || current->height() != y)
+        current->setSize(x, y);
 
     statusBar->setPos(0, current->boundingRect().height() + 1);
     statusBar->setSize(current->boundingRect().width(), CELL_HEIGHT * 0.90);
@@ -654,8 +822,6 @@ void Terminal::clearTWait()
     xClock = false;
 
     updateLockState();
-
-    current->update();
 }
 
 /**
@@ -704,12 +870,20 @@ void Terminal::updateLockState()
  *
  * @details Fit the terminal display into the window, either fixed at 4:3 ratio or stretched to fill
  *          the window. If the 'Not Connected' display is shown, it's always stretched to fill the window.
+ *
+ *          The terminal display is scaled so that a cell is a whole number of device pixels, as worked out by
+ *          DisplayScreen::fitScale(), which can leave a few pixels of the window unused.
  */
 void Terminal::fit()
 {
     if (sessionConnected)
     {
-        screen->fitInView(screen->scene()->itemsBoundingRect(), stretchScreen);
+        QRectF area = screen->scene()->itemsBoundingRect();
+        QSizeF scale = current->fitScale(area.size(), screen->viewport()->size(),
+                                         screen->viewport()->devicePixelRatio(), stretchScreen);
+
+        screen->setTransform(QTransform::fromScale(scale.width(), scale.height()));
+        screen->centerOn(area.center());
     }
     else
     {
@@ -725,12 +899,15 @@ void Terminal::fit()
  *
  * @details This routine gains control when the internal size of the scene changes. This is purely to handle
  *          the toolbar being shown/hidden, so that the display matrix can be resized properly.
+ *
+ *          While the window is being resized, there is a resize event for every step; the display is fitted
+ *          only once they stop, ResizeDelay milliseconds after the last.
  */
 bool Terminal::eventFilter(QObject* obj, QEvent* event)
 {
     if (obj == screen->viewport() && event->type() == QEvent::Resize)
     {
-        fit();
+        resizeTimer->start();
         return false;
     }
     return QWidget::eventFilter(obj, event);
@@ -18,6 +18,7 @@
 
 #include "ProcessDataStream.h"
 #include "SocketConnection.h"
+#include "SessionWorker.h"
 #include "Keyboard.h"
 #include "CodePage.h"
 #include "ActiveSettings.h"
@@ -34,10 +35,10 @@ class Terminal : public QWidget
 
         void connectSession();
 
-        int terminalWidth(bool alternate)          { return(!alternate ? 80 : activeSettings.getTerminalX()); }
-        int terminalHeight(bool alternate)         { return(!alternate ? 24 : activeSettings.getTerminalY()); }
-        int gridWidth(bool alternate)              { return(!alternate ? 80 *  12 : activeSettings.getTerminalX() * 12); }
-        int gridHeight(bool alternate)             { return(!alternate ? 24 *  22 : activeSettings.getTerminalY() * 22); }
+        int terminalWidth(bool alternate)          { return(!alternate ? Q3270_PRIMARY_COLS : activeSettings.getTerminalX()); }
+        int terminalHeight(bool alternate)         { return(!alternate ? Q3270_PRIMARY_ROWS : activeSettings.getTerminalY()); }
+        int gridWidth(bool alternate)              { return terminalWidth(alternate) * CELL_WIDTH; }
+        int gridHeight(bool alternate)             { return terminalHeight(alternate) * CELL_HEIGHT; }
 
         void setBlink(bool blink);
         void setBlinkSpeed(int speed);
@@ -50,7 +51,9 @@ class Terminal : public QWidget
 
         bool isConnected() { return sessionConnected; }
 
-        QList<QSslCertificate> getCertDetails()    { return socket->getCertDetails(); }
+        QList<QSslCertificate> getCertDetails()    { return worker ? worker->getCertDetails() : socket->getCertDetails(); }
+
+        const LatencyStats &latencyStats() const    { return latency; }
 
     signals:
 
@@ -83,6 +86,9 @@ class Terminal : public QWidget
 
         void blinkText();
         void blinkCursor();
+        void textBlinkChanged(bool blinking);
+
+        void updateScreen();
 
         bool eventFilter(QObject* obj, QEvent* event);
         
@@ -114,6 +120,15 @@ class Terminal : public QWidget
         ProcessDataStream *datastream;
         SocketConnection *socket;
 
+        // Set when the session runs on its own thread; see SessionWorker
+        SessionWorker *worker;
+
+        // The screen updated by the host and the keyboard; the worker's model, or current
+        DisplayScreen *hostScreen;
+
+        // Host and local response times for the current session
+        LatencyStats latency;
+
         bool sessionConnected;
 
         Qt::AspectRatioMode stretchScreen;
@@ -132,6 +147,11 @@ class Terminal : public QWidget
 
         QTimer *blinker;
         QTimer *cursorBlinker;
+
+        // Milliseconds without a resize before the screen is fitted to the window
+        static constexpr int ResizeDelay = 100;
+
+        QTimer *resizeTimer;
 };
 
 #endif // TERMINAL_H
@@ -0,0 +1,37 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include "Trace.h"
+
+// Categories are objects rather than the functions Q_LOGGING_CATEGORY would create, so that testing
+// whether one is enabled doesn't also test a function-local static guard.
+const QLoggingCategory Trace::telnet("q3270.telnet", QtWarningMsg);
+const QLoggingCategory Trace::datastream("q3270.datastream", QtWarningMsg);
+const QLoggingCategory Trace::keyboard("q3270.keyboard", QtWarningMsg);
+const QLoggingCategory Trace::render("q3270.render", QtWarningMsg);
+
+/**
+ * @brief   Trace::setRules - enable or disable trace categories
+ * @param   rules - Qt logging rules, separated by semicolons or newlines
+ *
+ * @details Called at startup with the TraceRules application setting. An empty string leaves the defaults
+ *          (and anything set by QT_LOGGING_RULES) alone.
+ */
+void Trace::setRules(const QString &rules)
+{
+    if (rules.isEmpty())
+    {
+        return;
+    }
+
+    QString filter = rules;
+
+    QLoggingCategory::setFilterRules(filter.replace(';', '\n'));
+}
@@ -0,0 +1,68 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QLoggingCategory>
+
+/**
+ * @brief   Trace categories and macros
+ *
+ * @details Tracing is split into categories that can be switched on at runtime, each with two levels:
+ *
+ *          Category         | Covers
+ *          ---------------- | ------
+ *          q3270.telnet     | Telnet negotiation and records read from the socket
+ *          q3270.datastream | 3270 commands and orders
+ *          q3270.keyboard   | Key presses and the keyboard buffer
+ *          q3270.render     | Painting
+ *
+ *          TRACE() is the detailed level (QtDebugMsg) and TRACE_INFO() the summary level (QtInfoMsg). Both
+ *          are off by default. They are enabled with Qt logging rules, either through QT_LOGGING_RULES or
+ *          the TraceRules application setting, for example "q3270.datastream.debug=true".
+ *
+ *          The arguments are only formatted when the category is enabled; otherwise the cost is a load
+ *          and a branch. When Q3270_NO_TRACE is defined (the default for Release builds), TRACE() and
+ *          TRACE_INFO() are compiled out altogether.
+ *
+ *          TRACE_ENABLED() guards blocks of code that exist only to produce trace output, such as hex dumps.
+ *
+ *          TRACE_WARN() reports protocol errors and unsupported functions. It is enabled by default and is
+ *          never compiled out.
+ */
+
+namespace Trace
+{
+    extern const QLoggingCategory telnet;
+    extern const QLoggingCategory datastream;
+    extern const QLoggingCategory keyboard;
+    extern const QLoggingCategory render;
+
+    void setRules(const QString &rules);
+}
+
+#define Q3270_TRACE_AT(category, level) \
+    for (bool q3270TraceEnabled = Trace::category.is##level##Enabled(); q3270TraceEnabled; q3270TraceEnabled = false) \
+        QMessageLogger(QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE, QT_MESSAGELOG_FUNC, Trace::category.categoryName())
+
+#ifdef Q3270_NO_TRACE
+#define TRACE(category)         QT_NO_QDEBUG_MACRO()
+#define TRACE_INFO(category)    QT_NO_QDEBUG_MACRO()
+#define TRACE_ENABLED(category) false
+#else
+#define TRACE(category)         Q3270_TRACE_AT(category, Debug).debug()
+#define TRACE_INFO(category)    Q3270_TRACE_AT(category, Info).info()
+#define TRACE_ENABLED(category) (Trace::category.isDebugEnabled())
+#endif
+
+#define TRACE_WARN(category)    Q3270_TRACE_AT(category, Warning).warning()
+
+#endif // TRACE_H
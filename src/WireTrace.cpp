@@ -0,0 +1,169 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <QDateTime>
+
+#include "WireTrace.h"
+#include "Trace.h"
+
+/**
+ * @brief   WireTrace::WireTrace - a binary trace of the data exchanged with the host
+ * @param   ringSize - the size of the ring buffer, rounded up to a power of two
+ *
+ * @details The ring is allocated here; nothing is recorded until open() has been called.
+ */
+WireTrace::WireTrace(qsizetype ringSize) : head(0), tail(0), droppedCount(0), running(false), writer(nullptr)
+{
+    quint64 size = 4096;
+
+    while (size < (quint64) ringSize)
+    {
+        size <<= 1;
+    }
+
+    ring = new char[size];
+    ringMask = size - 1;
+}
+
+/**
+ * @brief   WireTrace::~WireTrace - destructor
+ *
+ * @details Anything still in the ring is written to the file before it is closed.
+ */
+WireTrace::~WireTrace()
+{
+    close();
+
+    delete[] ring;
+}
+
+/**
+ * @brief   WireTrace::open - start a trace
+ * @param   fileName - the trace file
+ * @param   session  - session details stored in the file header, such as host and LU name
+ * @return  true if the file was created
+ *
+ * @details Writes the file header and starts the writer thread. Record timestamps are measured from here.
+ */
+bool WireTrace::open(const QString &fileName, const QMap<QString, QString> &session)
+{
+    close();
+
+    file.setFileName(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        TRACE_WARN(telnet) << "Unable to open wire trace" << fileName << "-" << file.errorString();
+        return false;
+    }
+
+    QByteArray metadata;
+
+    for (auto it = session.cbegin(); it != session.cend(); ++it)
+    {
+        metadata.append(it.key().toUtf8()).append('=').append(it.value().toUtf8()).append('\n');
+    }
+
+    char header[FileHeaderSize];
+
+    memcpy(header, Magic, sizeof(Magic));
+    qToLittleEndian<quint16>(Version, header + 8);
+    qToLittleEndian<quint16>(0, header + 10);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 12);
+    qToLittleEndian<quint32>(metadata.size(), header + 20);
+
+    file.write(header, FileHeaderSize);
+    file.write(metadata);
+
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    droppedCount.store(0, std::memory_order_relaxed);
+
+    clock.start();
+
+    running.store(true, std::memory_order_release);
+
+    writer = QThread::create([this]() { flushLoop(); });
+    writer->setObjectName("Q3270 wire trace");
+    writer->start(QThread::LowPriority);
+
+    return true;
+}
+
+/**
+ * @brief   WireTrace::close - finish the trace
+ *
+ * @details Stops the writer thread, which empties the ring before it ends, and closes the file. Must not be
+ *          called while a record is being added.
+ */
+void WireTrace::close()
+{
+    if (!writer)
+    {
+        return;
+    }
+
+    running.store(false, std::memory_order_release);
+
+    writer->wait();
+
+    delete writer;
+    writer = nullptr;
+
+    if (droppedCount.load(std::memory_order_relaxed))
+    {
+        TRACE_WARN(telnet) << "Wire trace dropped" << droppedCount.load(std::memory_order_relaxed) << "records";
+    }
+
+    file.close();
+}
+
+/**
+ * @brief   WireTrace::flush - write the contents of the ring to the file
+ *
+ * @details Called on the writer thread. Everything up to the current head is written, in at most two
+ *          pieces, and the space is then handed back to the producer.
+ */
+void WireTrace::flush()
+{
+    quint64 end = head.load(std::memory_order_acquire);
+    quint64 start = tail.load(std::memory_order_relaxed);
+
+    if (end == start)
+    {
+        return;
+    }
+
+    qsizetype offset = start & ringMask;
+    qsizetype len = end - start;
+    qsizetype first = qMin(len, (qsizetype) (ringMask + 1) - offset);
+
+    file.write(ring + offset, first);
+    file.write(ring, len - first);
+
+    tail.store(end, std::memory_order_release);
+}
+
+/**
+ * @brief   WireTrace::flushLoop - the writer thread
+ *
+ * @details Empties the ring every few milliseconds until the trace is closed, and once more after that.
+ */
+void WireTrace::flushLoop()
+{
+    while (running.load(std::memory_order_acquire))
+    {
+        flush();
+        QThread::msleep(20);
+    }
+
+    flush();
+    file.flush();
+}
@@ -0,0 +1,186 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef WIRETRACE_H
+#define WIRETRACE_H
+
+#include <atomic>
+#include <cstring>
+
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMap>
+#include <QThread>
+#include <QtEndian>
+
+/**
+ * @brief   The WireTrace class
+ *
+ * @details WireTrace records the bytes exchanged with the host to a binary trace file, for later display
+ *          with the q3270-wiretrace tool.
+ *
+ *          The socket side only copies each record into a ring buffer; a background thread writes the ring
+ *          to the file. The ring is single producer, single consumer and lock free, so the socket thread
+ *          never waits for the disk. If the ring is full, the record is dropped and counted rather than
+ *          holding up the session.
+ *
+ *          File format (all integers little endian):
+ *
+ *          Offset | Size | Content
+ *          ------ | ---- | -------
+ *          0      | 8    | Magic, "Q3270WT" followed by a null
+ *          8      | 2    | Format version (WireTrace::Version)
+ *          10     | 2    | Reserved
+ *          12     | 8    | Start time, milliseconds since the epoch
+ *          20     | 4    | Length of the session metadata
+ *          24     | n    | Session metadata, UTF-8 "key=value" lines
+ *
+ *          followed by any number of records, each a RecordHeader and its data.
+ */
+class WireTrace
+{
+    public:
+
+        enum Direction : quint8
+        {
+            Inbound  = 0,
+            Outbound = 1
+        };
+
+        enum Type : quint8
+        {
+            Data    = 0,            // A 3270 record, without the IAC EOR
+            Telnet  = 1             // Telnet negotiation, exactly as sent or received
+        };
+
+        enum Flags : quint8
+        {
+            TN3270E = 1             // Data starts with a TN3270E header
+        };
+
+        struct RecordHeader
+        {
+            quint64 timestamp;      // Nanoseconds since the start of the trace
+            quint32 length;         // Length of the data that follows
+            quint8 direction;
+            quint8 type;
+            quint8 flags;
+            quint8 reserved;
+        };
+
+        static_assert(sizeof(RecordHeader) == 16, "RecordHeader is written to the file as is");
+
+        static constexpr char Magic[8] = { 'Q', '3', '2', '7', '0', 'W', 'T', 0 };
+        static constexpr quint16 Version = 1;
+        static constexpr int FileHeaderSize = 24;
+
+        explicit WireTrace(qsizetype ringSize = 4 * 1024 * 1024);
+        ~WireTrace();
+
+        WireTrace(const WireTrace &) = delete;
+        WireTrace &operator=(const WireTrace &) = delete;
+
+        bool open(const QString &fileName, const QMap<QString, QString> &session);
+        void close();
+
+        bool isOpen() const                         { return writer != nullptr; }
+        QString fileName() const                    { return file.fileName(); }
+        quint64 dropped() const                     { return droppedCount.load(std::memory_order_relaxed); }
+
+        inline void record(Direction direction, Type type, quint8 flags, QByteArrayView data,
+                           QByteArrayView more = QByteArrayView());
+
+    private:
+
+        // The ring; the size is a power of two so that positions can be masked
+        char *ring;
+        quint64 ringMask;
+
+        // Total bytes ever written to and read from the ring. head is only stored by the producer and tail
+        // only by the consumer.
+        alignas(64) std::atomic<quint64> head;
+        alignas(64) std::atomic<quint64> tail;
+
+        std::atomic<quint64> droppedCount;
+        std::atomic<bool> running;
+
+        QElapsedTimer clock;
+        QFile file;
+        QThread *writer;
+
+        inline void copyIn(quint64 pos, const void *data, qsizetype len);
+
+        void flush();
+        void flushLoop();
+};
+
+/**
+ * @brief   WireTrace::copyIn - copy bytes into the ring
+ * @param   pos  - the ring position
+ * @param   data - the bytes
+ * @param   len  - the number of bytes
+ *
+ * @details The copy is split in two if it runs past the end of the ring.
+ */
+void WireTrace::copyIn(quint64 pos, const void *data, qsizetype len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+
+    qsizetype offset = pos & ringMask;
+    qsizetype first = qMin(len, (qsizetype) (ringMask + 1) - offset);
+
+    memcpy(ring + offset, data, first);
+    memcpy(ring, (const char *) data + first, len - first);
+}
+
+/**
+ * @brief   WireTrace::record - add a record to the trace
+ * @param   direction - Inbound or Outbound
+ * @param   type      - the record type
+ * @param   flags     - record flags
+ * @param   data      - the bytes
+ * @param   more      - further bytes, stored in the same record
+ *
+ * @details Called on the socket thread. The record is copied into the ring and left for the writer thread.
+ */
+void WireTrace::record(Direction direction, Type type, quint8 flags, QByteArrayView data, QByteArrayView more)
+{
+    quint64 length = data.size() + more.size();
+    quint64 needed = sizeof(RecordHeader) + length;
+
+    quint64 pos = head.load(std::memory_order_relaxed);
+
+    if (needed > ringMask + 1 - (pos - tail.load(std::memory_order_acquire)))
+    {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    RecordHeader header;
+
+    header.timestamp = qToLittleEndian<quint64>(clock.nsecsElapsed());
+    header.length = qToLittleEndian<quint32>(length);
+    header.direction = direction;
+    header.type = type;
+    header.flags = flags;
+    header.reserved = 0;
+
+    copyIn(pos, &header, sizeof(header));
+    copyIn(pos + sizeof(header), data.data(), data.size());
+    copyIn(pos + sizeof(header) + data.size(), more.data(), more.size());
+
+    head.store(pos + needed, std::memory_order_release);
+}
+
+#endif // WIRETRACE_H
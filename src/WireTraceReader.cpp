@@ -0,0 +1,154 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include "WireTraceReader.h"
+
+/**
+ * @brief   WireTraceReader::WireTraceReader - read a wire trace file
+ */
+WireTraceReader::WireTraceReader() : map(nullptr), mapSize(0), pos(0), firstRecord(0), formatVersion(0), startMSecs(0)
+{
+}
+
+/**
+ * @brief   WireTraceReader::open - open a trace file
+ * @param   fileName - the file
+ * @return  true if the file is a wire trace that can be read
+ *
+ * @details The file is mapped and the header and session metadata are read. Records are then read with
+ *          next().
+ */
+bool WireTraceReader::open(const QString &fileName)
+{
+    close();
+
+    file.setFileName(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        error = file.errorString();
+        return false;
+    }
+
+    mapSize = file.size();
+
+    if (mapSize < WireTrace::FileHeaderSize)
+    {
+        error = "Not a Q3270 wire trace";
+        close();
+        return false;
+    }
+
+    map = file.map(0, mapSize);
+
+    if (!map)
+    {
+        error = file.errorString();
+        close();
+        return false;
+    }
+
+    if (memcmp(map, WireTrace::Magic, sizeof(WireTrace::Magic)))
+    {
+        error = "Not a Q3270 wire trace";
+        close();
+        return false;
+    }
+
+    formatVersion = qFromLittleEndian<quint16>(map + 8);
+
+    if (formatVersion > WireTrace::Version)
+    {
+        error = QString("Unsupported wire trace version %1").arg(formatVersion);
+        close();
+        return false;
+    }
+
+    startMSecs = qFromLittleEndian<qint64>(map + 12);
+
+    quint32 metadataLength = qFromLittleEndian<quint32>(map + 20);
+
+    if (WireTrace::FileHeaderSize + (qint64) metadataLength > mapSize)
+    {
+        error = "Wire trace header is incomplete";
+        close();
+        return false;
+    }
+
+    const QList<QByteArray> lines = QByteArray((const char *) map + WireTrace::FileHeaderSize, metadataLength).split('\n');
+
+    for (const QByteArray &line : lines)
+    {
+        qsizetype eq = line.indexOf('=');
+
+        if (eq > 0)
+        {
+            metadata.insert(QString::fromUtf8(line.left(eq)), QString::fromUtf8(line.mid(eq + 1)));
+        }
+    }
+
+    firstRecord = WireTrace::FileHeaderSize + metadataLength;
+    pos = firstRecord;
+
+    return true;
+}
+
+/**
+ * @brief   WireTraceReader::close - close the trace file
+ */
+void WireTraceReader::close()
+{
+    if (map)
+    {
+        file.unmap(const_cast<uchar *>(map));
+        map = nullptr;
+    }
+
+    file.close();
+
+    mapSize = 0;
+    pos = 0;
+    firstRecord = 0;
+    metadata.clear();
+}
+
+/**
+ * @brief   WireTraceReader::next - read the next record
+ * @param   record - filled in with the record
+ * @return  false at the end of the trace
+ *
+ * @details The record data is a view of the mapped file, valid until the reader is closed.
+ */
+bool WireTraceReader::next(Record &record)
+{
+    if (pos + (qint64) sizeof(WireTrace::RecordHeader) > mapSize)
+    {
+        return false;
+    }
+
+    const uchar *p = map + pos;
+
+    quint32 length = qFromLittleEndian<quint32>(p + 8);
+
+    if (pos + (qint64) sizeof(WireTrace::RecordHeader) + length > mapSize)
+    {
+        return false;
+    }
+
+    record.timestamp = qFromLittleEndian<quint64>(p);
+    record.direction = (WireTrace::Direction) p[12];
+    record.type = (WireTrace::Type) p[13];
+    record.flags = p[14];
+    record.data = QByteArrayView((const char *) p + sizeof(WireTrace::RecordHeader), length);
+
+    pos += sizeof(WireTrace::RecordHeader) + length;
+
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef WIRETRACEREADER_H
+#define WIRETRACEREADER_H
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QMap>
+
+#include "WireTrace.h"
+
+/**
+ * @brief   The WireTraceReader class
+ *
+ * @details WireTraceReader reads a file written by WireTrace. The file is memory mapped, and each record is
+ *          returned as a view of the mapping, so reading a large trace copies nothing.
+ *
+ *          A trace that ends part way through a record, as it will if Q3270 did not exit cleanly, is read up
+ *          to the last complete record.
+ */
+class WireTraceReader
+{
+    public:
+
+        struct Record
+        {
+            quint64 timestamp;      // Nanoseconds since the start of the trace
+            WireTrace::Direction direction;
+            WireTrace::Type type;
+            quint8 flags;
+            QByteArrayView data;
+        };
+
+        WireTraceReader();
+
+        bool open(const QString &fileName);
+        void close();
+
+        QString errorString() const                 { return error; }
+
+        int version() const                         { return formatVersion; }
+        qint64 startTime() const                    { return startMSecs; }
+        const QMap<QString, QString> &session() const { return metadata; }
+
+        bool next(Record &record);
+        void rewind()                               { pos = firstRecord; }
+
+    private:
+
+        QFile file;
+        const uchar *map;
+        qint64 mapSize;
+
+        qint64 pos;
+        qint64 firstRecord;
+
+        int formatVersion;
+        qint64 startMSecs;
+        QMap<QString, QString> metadata;
+
+        QString error;
+};
+
+#endif // WIRETRACEREADER_H
@@ -0,0 +1,153 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include "WireTraceReplay.h"
+
+/**
+ * @brief   WireTraceReplay::WireTraceReplay - play back a wire trace
+ * @param   parent - parent object
+ */
+WireTraceReplay::WireTraceReplay(QObject *parent) : QObject(parent), havePending(false), pacing(OriginalPacing),
+                                                     firstTimestamp(0), played(0)
+{
+    timer.setSingleShot(true);
+    timer.setTimerType(Qt::PreciseTimer);
+
+    connect(&timer, &QTimer::timeout, this, &WireTraceReplay::playNext);
+}
+
+/**
+ * @brief   WireTraceReplay::open - open a trace for playback
+ * @param   fileName - the trace file
+ * @return  true if the trace can be played
+ */
+bool WireTraceReplay::open(const QString &fileName)
+{
+    stop();
+
+    return reader.open(fileName);
+}
+
+/**
+ * @brief   WireTraceReplay::close - close the trace
+ */
+void WireTraceReplay::close()
+{
+    stop();
+
+    reader.close();
+}
+
+/**
+ * @brief   WireTraceReplay::nextRecord - find the next inbound 3270 record
+ * @return  false at the end of the trace
+ */
+bool WireTraceReplay::nextRecord()
+{
+    while (reader.next(pending))
+    {
+        if (pending.direction == WireTrace::Inbound && pending.type == WireTrace::Data)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief   WireTraceReplay::start - start playback from the beginning of the trace
+ *
+ * @details Records are emitted from the event loop, either at their recorded times relative to the first
+ *          record, or one after the other with no delay. finished() is emitted after the last record.
+ */
+void WireTraceReplay::start()
+{
+    stop();
+
+    reader.rewind();
+    played = 0;
+
+    havePending = nextRecord();
+    firstTimestamp = havePending ? pending.timestamp : 0;
+
+    clock.start();
+
+    timer.start(0);
+}
+
+/**
+ * @brief   WireTraceReplay::stop - stop playback
+ */
+void WireTraceReplay::stop()
+{
+    timer.stop();
+    havePending = false;
+}
+
+/**
+ * @brief   WireTraceReplay::playNext - emit the records that are due
+ *
+ * @details With original pacing, every record whose time has come is emitted and the timer is set for the
+ *          next one. As fast as possible, one record is emitted for each pass through the event loop, so
+ *          that the display is still painted.
+ */
+void WireTraceReplay::playNext()
+{
+    while (havePending)
+    {
+        if (pacing == OriginalPacing)
+        {
+            qint64 due = (pending.timestamp - firstTimestamp) - clock.nsecsElapsed();
+
+            if (due > 0)
+            {
+                timer.start((int) (due / 1000000));
+                return;
+            }
+        }
+
+        emit dataStreamComplete(pending.data, pending.flags & WireTrace::TN3270E);
+        played++;
+
+        havePending = nextRecord();
+
+        if (pacing == AsFastAsPossible && havePending)
+        {
+            timer.start(0);
+            return;
+        }
+    }
+
+    emit finished();
+}
+
+/**
+ * @brief   WireTraceReplay::runToEnd - play every record straight away
+ * @return  the number of records played
+ *
+ * @details Plays the whole trace before returning, without the event loop. Used to measure the data
+ *          stream parser.
+ */
+int WireTraceReplay::runToEnd()
+{
+    stop();
+
+    reader.rewind();
+    played = 0;
+
+    while (nextRecord())
+    {
+        emit dataStreamComplete(pending.data, pending.flags & WireTrace::TN3270E);
+        played++;
+    }
+
+    return played;
+}
@@ -0,0 +1,90 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#ifndef WIRETRACEREPLAY_H
+#define WIRETRACEREPLAY_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "WireTraceReader.h"
+
+/**
+ * @brief   The WireTraceReplay class
+ *
+ * @details WireTraceReplay plays back the inbound 3270 records of a wire trace, written by a session with
+ *          WireTraceDir set or by SocketConnection::startRecording(). Each record is emitted with the same
+ *          dataStreamComplete signal as SocketConnection, so it can be connected straight to
+ *          ProcessDataStream::processStream in place of a socket. The record is a view of the memory mapped
+ *          trace file; as with SocketConnection, the connection must be direct.
+ *
+ *          Records can be played back with the timing they were recorded with, or as fast as possible.
+ *          Telnet negotiation and outbound records are skipped; the TN3270E state of each record is taken
+ *          from the trace.
+ */
+class WireTraceReplay : public QObject
+{
+    Q_OBJECT
+
+    public:
+
+        enum Pacing
+        {
+            OriginalPacing,
+            AsFastAsPossible
+        };
+
+        explicit WireTraceReplay(QObject *parent = nullptr);
+
+        bool open(const QString &fileName);
+        void close();
+
+        QString errorString() const                 { return reader.errorString(); }
+        const QMap<QString, QString> &session() const { return reader.session(); }
+
+        void setPacing(Pacing p)                    { pacing = p; }
+
+        void start();
+        void stop();
+
+        int runToEnd();
+
+        int recordsPlayed() const                   { return played; }
+
+    signals:
+
+        void dataStreamComplete(QByteArrayView record, bool tn3270e);
+        void finished();
+
+    private slots:
+
+        void playNext();
+
+    private:
+
+        WireTraceReader reader;
+        WireTraceReader::Record pending;
+        bool havePending;
+
+        Pacing pacing;
+
+        QTimer timer;
+        QElapsedTimer clock;
+
+        // Timestamp of the first record played, so that playback starts straight away
+        quint64 firstTimestamp;
+
+        int played;
+
+        bool nextRecord();
+};
+
+#endif // WIRETRACEREPLAY_H
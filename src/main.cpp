@@ -9,15 +9,21 @@
  */
 
 #include "MainWindow.h"
+#include "Q3270.h"
+#include "Trace.h"
 
 #include <QApplication>
 #include <QCoreApplication>
+#include <QSettings>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
     a.setWindowIcon(QIcon(":/Icons/q3270.svg"));
 
+    // Trace categories to enable, as Qt logging rules separated by semicolons
+    Trace::setRules(QSettings(Q3270_ORG, Q3270_APP).value("TraceRules").toString());
+
     QStringList parms = QCoreApplication::arguments();
 
     LaunchParms lp;
@@ -0,0 +1,121 @@
+/*
+ * Q3270 Terminal Emulator
+ *
+ * Copyright (c) 2020–2025 Andy Styles
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * This file is part of Q3270.
+ * See the LICENSE file in the project root for full license information.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+
+#include <cctype>
+#include <cstdio>
+
+#include "CodePage.h"
+#include "WireTraceReader.h"
+
+/**
+ * @brief   dumpBytes - print a record in hex, with ASCII and EBCDIC
+ * @param   data - the bytes
+ * @param   cp   - the codepage used for the EBCDIC column
+ *
+ * @details Each line shows 32 bytes, in the same layout as the old SocketConnection hex dump.
+ */
+static void dumpBytes(QByteArrayView data, const CodePage &cp)
+{
+    for (qsizetype line = 0; line < data.size(); line += 32)
+    {
+        QString hex;
+        QString ascii;
+        QString ebcdic;
+
+        for (qsizetype i = line; i < qMin(line + 32, data.size()); i++)
+        {
+            uchar c = data.at(i);
+
+            hex.append(QString("%1 ").arg(c, 2, 16, QLatin1Char('0')).toUpper());
+
+            ascii.append(isalnum(c) ? QChar(c) : QChar('.'));
+
+            QChar u = cp.getUnicodeChar(c).at(0);
+            ebcdic.append(u.isLetterOrNumber() && u.unicode() < 0x80 ? u : QChar('.'));
+        }
+
+        printf("    %4llx - %-96s | %-32s | %-32s |\n", (long long) line, qPrintable(hex), qPrintable(ascii),
+               qPrintable(ebcdic));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Display a Q3270 wire trace");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "The trace file");
+    parser.addOption({ { "s", "summary" }, "Show record headers only" });
+    parser.addOption({ { "d", "data" }, "Show 3270 records only, not telnet negotiation" });
+
+    parser.process(a);
+
+    if (parser.positionalArguments().size() != 1)
+    {
+        parser.showHelp(1);
+    }
+
+    WireTraceReader trace;
+
+    if (!trace.open(parser.positionalArguments().at(0)))
+    {
+        fprintf(stderr, "%s\n", qPrintable(trace.errorString()));
+        return 1;
+    }
+
+    printf("Q3270 wire trace version %d, started %s\n", trace.version(),
+           qPrintable(QDateTime::fromMSecsSinceEpoch(trace.startTime()).toString(Qt::ISODateWithMs)));
+
+    for (auto it = trace.session().cbegin(); it != trace.session().cend(); ++it)
+    {
+        printf("    %-10s %s\n", qPrintable(it.key()), qPrintable(it.value()));
+    }
+
+    CodePage cp;
+
+    WireTraceReader::Record record;
+
+    int records = 0;
+    qint64 bytes = 0;
+
+    while (trace.next(record))
+    {
+        records++;
+        bytes += record.data.size();
+
+        if (parser.isSet("data") && record.type != WireTrace::Data)
+        {
+            continue;
+        }
+
+        printf("\n%14.6f ms  %-8s %-6s %s%lld bytes\n",
+               record.timestamp / 1e6,
+               record.direction == WireTrace::Inbound ? "Inbound" : "Outbound",
+               record.type == WireTrace::Data ? "Data" : "Telnet",
+               record.flags & WireTrace::TN3270E ? "TN3270E " : "",
+               (long long) record.data.size());
+
+        if (!parser.isSet("summary"))
+        {
+            dumpBytes(record.data, cp);
+        }
+    }
+
+    printf("\n%d records, %lld bytes\n", records, (long long) bytes);
+
+    return 0;
+}